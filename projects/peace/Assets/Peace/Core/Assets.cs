@@ -12,33 +12,89 @@ namespace Peace
     {
         public static Mesh GetMesh(IntPtr handle)
         {
-            int vertSize = 0, indicesSize = 0;
-            readMeshSizes(handle, ref vertSize, ref indicesSize);
+            return GetMeshes(new[] {handle})[0];
+        }
 
-            double[] vertices = new double[vertSize];
-            int[] indices = new int[indicesSize];
-            
-            readMesh(handle, vertices, indices);
+        /// Reads all the given meshes with a single native call.
+        public static Mesh[] GetMeshes(IntPtr[] handles)
+        {
+            int count = handles.Length;
+            int[] vertCounts = new int[count], indicesCounts = new int[count];
+            readMeshesSizes(handles, count, vertCounts, indicesCounts);
 
-            int vertCount = vertSize / 8;
+            // Vector3 and Vector2 are blittable, native code fills them directly
+            Vector3[] positions = new Vector3[vertCounts.Sum()];
+            Vector3[] normals = new Vector3[positions.Length];
+            Vector2[] uvs = new Vector2[positions.Length];
+            int[] indices = new int[indicesCounts.Sum()];
 
-            Vector3[] vertPositions = new Vector3[vertCount];
-            Vector3[] vertNormals = new Vector3[vertCount];
-            Vector2[] vertUVs = new Vector2[vertCount];
-            
-            for (int i = 0; i < vertCount; i++) {
-                vertPositions[i] = new Vector3((float)vertices[i * 8 + 0], (float)vertices[i * 8 + 2], (float)vertices[i * 8 + 1]);
-                vertNormals[i] = new Vector3((float)vertices[i * 8 + 3], (float)vertices[i * 8 + 5], (float)vertices[i * 8 + 4]);
-                vertUVs[i] = new Vector2((float)vertices[i * 8 + 6], 1 - (float)vertices[i * 8 + 7]);
-            }
+            readMeshesFloat(handles, count, positions, normals, uvs, indices);
+            return BuildMeshes(vertCounts, indicesCounts, positions, normals, uvs, indices);
+        }
+
+        /// Reads all the given compact meshes with a single native call. The
+        /// float buffers of the compact meshes are copied as is.
+        public static Mesh[] GetCompactMeshes(IntPtr[] handles)
+        {
+            int count = handles.Length;
+            int[] vertCounts = new int[count], indicesCounts = new int[count];
+            readCompactMeshesSizes(handles, count, vertCounts, indicesCounts);
 
-            Mesh mesh = new Mesh();
-            mesh.vertices = vertPositions;
-            mesh.normals = vertNormals;
-            mesh.uv = vertUVs;
-            mesh.triangles = indices.Reverse().ToArray();
+            Vector3[] positions = new Vector3[vertCounts.Sum()];
+            Vector3[] normals = new Vector3[positions.Length];
+            Vector2[] uvs = new Vector2[positions.Length];
+            int[] indices = new int[indicesCounts.Sum()];
 
-            return mesh;
+            readCompactMeshesFloat(handles, count, positions, normals, uvs, indices);
+            return BuildMeshes(vertCounts, indicesCounts, positions, normals, uvs, indices);
+        }
+
+        private static Mesh[] BuildMeshes(int[] vertCounts, int[] indicesCounts,
+            Vector3[] positions, Vector3[] normals, Vector2[] uvs, int[] indices)
+        {
+            int count = vertCounts.Length;
+            Mesh[] meshes = new Mesh[count];
+            int vertOffset = 0, indicesOffset = 0;
+
+            for (int m = 0; m < count; m++)
+            {
+                int vertCount = vertCounts[m], indicesCount = indicesCounts[m];
+                Vector3[] vertPositions = new Vector3[vertCount];
+                Vector3[] vertNormals = new Vector3[vertCount];
+                Vector2[] vertUVs = new Vector2[vertCount];
+                int[] triangles = new int[indicesCount];
+
+                // Unity is y-up and left-handed
+                for (int i = 0; i < vertCount; i++)
+                {
+                    Vector3 p = positions[vertOffset + i], n = normals[vertOffset + i];
+                    Vector2 uv = uvs[vertOffset + i];
+                    vertPositions[i] = new Vector3(p.x, p.z, p.y);
+                    vertNormals[i] = new Vector3(n.x, n.z, n.y);
+                    vertUVs[i] = new Vector2(uv.x, 1 - uv.y);
+                }
+
+                for (int i = 0; i < indicesCount; i++)
+                {
+                    triangles[i] = indices[indicesOffset + indicesCount - 1 - i];
+                }
+
+                Mesh mesh = new Mesh();
+                if (vertCount > 65535)
+                {
+                    mesh.indexFormat = UnityEngine.Rendering.IndexFormat.UInt32;
+                }
+                mesh.vertices = vertPositions;
+                mesh.normals = vertNormals;
+                mesh.uv = vertUVs;
+                mesh.triangles = triangles;
+                meshes[m] = mesh;
+
+                vertOffset += vertCount;
+                indicesOffset += indicesCount;
+            }
+
+            return meshes;
         }
 
         public static Material GetMaterial(IntPtr handle)
@@ -109,6 +165,24 @@ namespace Peace
         
         [DllImport("peace")]
         private static extern void readMesh(IntPtr meshPtr, [In, Out] double[] vertices, [In, Out] int[] indices);
+
+        [DllImport("peace")]
+        private static extern void readMeshesSizes(IntPtr[] meshPtrs, int count,
+            [In, Out] int[] vertCounts, [In, Out] int[] indicesCounts);
+
+        [DllImport("peace")]
+        private static extern void readMeshesFloat(IntPtr[] meshPtrs, int count,
+            [In, Out] Vector3[] positions, [In, Out] Vector3[] normals, [In, Out] Vector2[] uvs,
+            [In, Out] int[] indices);
+
+        [DllImport("peace")]
+        private static extern void readCompactMeshesSizes(IntPtr[] meshPtrs, int count,
+            [In, Out] int[] vertCounts, [In, Out] int[] indicesCounts);
+
+        [DllImport("peace")]
+        private static extern void readCompactMeshesFloat(IntPtr[] meshPtrs, int count,
+            [In, Out] Vector3[] positions, [In, Out] Vector3[] normals, [In, Out] Vector2[] uvs,
+            [In, Out] int[] indices);
         
         [DllImport("peace")]
         private static extern MaterialDescription readMaterial(IntPtr materialPtr);
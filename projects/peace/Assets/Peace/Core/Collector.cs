@@ -80,6 +80,8 @@ namespace Peace
             // Get from native code
             IntPtr[] nodes = new IntPtr[0], meshes = new IntPtr[0], materials = new IntPtr[0], textures = new IntPtr[0];
             string[] nodeNames = new string[0], meshNames = new string[0], materialNames = new string[0], textureNames = new string[0];
+            IntPtr[] compactMeshes = new IntPtr[0];
+            string[] compactMeshNames = new string[0];
 
             await Task.Run(() =>
             {
@@ -87,6 +89,7 @@ namespace Peace
                 GetChannel(MESH_CHANNEL, out meshNames, out meshes);
                 GetChannel(MATERIAL_CHANNEL, out materialNames, out materials);
                 GetChannel(TEXTURE_CHANNEL, out textureNames, out textures);
+                GetChannel(COMPACT_MESH_CHANNEL, out compactMeshNames, out compactMeshes);
             });
 
             double l = LastStats.interopTime = sw.Elapsed.TotalMilliseconds;
@@ -118,12 +121,15 @@ namespace Peace
 
             // Update meshes
             toRemove = new HashSet<string>(_meshes.Keys);
+            List<string> newMeshNames = new List<string>();
+            List<IntPtr> newMeshes = new List<IntPtr>();
 
             for (int i = 0; i < meshes.Length; ++i)
             {
                 if (!_meshes.ContainsKey(meshNames[i]))
                 {
-                    _meshes.Add(meshNames[i], Assets.GetMesh(meshes[i]));
+                    newMeshNames.Add(meshNames[i]);
+                    newMeshes.Add(meshes[i]);
                 }
                 else
                 {
@@ -131,6 +137,37 @@ namespace Peace
                 }
             }
 
+            // Compact meshes share the mesh dictionary, their keys are distinct
+            List<string> newCompactMeshNames = new List<string>();
+            List<IntPtr> newCompactMeshes = new List<IntPtr>();
+
+            for (int i = 0; i < compactMeshes.Length; ++i)
+            {
+                if (!_meshes.ContainsKey(compactMeshNames[i]))
+                {
+                    newCompactMeshNames.Add(compactMeshNames[i]);
+                    newCompactMeshes.Add(compactMeshes[i]);
+                }
+                else
+                {
+                    toRemove.Remove(compactMeshNames[i]);
+                }
+            }
+
+            Mesh[] readMeshes = Assets.GetMeshes(newMeshes.ToArray());
+
+            for (int i = 0; i < readMeshes.Length; ++i)
+            {
+                _meshes.Add(newMeshNames[i], readMeshes[i]);
+            }
+
+            Mesh[] readCompactMeshes = Assets.GetCompactMeshes(newCompactMeshes.ToArray());
+
+            for (int i = 0; i < readCompactMeshes.Length; ++i)
+            {
+                _meshes.Add(newCompactMeshNames[i], readCompactMeshes[i]);
+            }
+
             foreach (var key in toRemove)
             {
                 Object.Destroy(_meshes[key]);
@@ -229,6 +266,7 @@ namespace Peace
         private const int MESH_CHANNEL = 1;
         private const int MATERIAL_CHANNEL = 2;
         private const int TEXTURE_CHANNEL = 3;
+        private const int COMPACT_MESH_CHANNEL = 4;
         
         [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
         public struct CollectorNode
@@ -266,4 +304,4 @@ namespace Peace
         [DllImport("peace")]
         private static extern CollectorNode readNode(IntPtr nodePtr);
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
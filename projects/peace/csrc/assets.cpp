@@ -12,6 +12,17 @@ struct MaterialDescription {
     double Ksr, Ksg, Ksb;
 };
 
+/** Raw buffers of a mesh. The pointers stay valid as long as the collector
+ * containing the mesh is not reset. */
+struct MeshData {
+    /// 8 doubles per vertex: position, normal, texture
+    const double *vertices;
+    /// 3 ints per face
+    const int *indices;
+    int vertCount;
+    int indicesCount;
+};
+
 #define DOUBLE_VERTEX_SIZE (sizeof(Vertex) / sizeof(double))
 
 PEACE_EXPORT void readMeshSizes(MeshPtr meshPtr, int *vertSize,
@@ -23,17 +34,156 @@ PEACE_EXPORT void readMeshSizes(MeshPtr meshPtr, int *vertSize,
 
 PEACE_EXPORT void readMesh(MeshPtr meshPtr, double *vertices, int *indices) {
     auto *mesh = static_cast<Mesh *>(meshPtr);
+    std::memcpy(vertices, mesh->getVertices(),
+                mesh->getVerticesCount() * sizeof(Vertex));
+    std::memcpy(indices, mesh->getFaces(), mesh->getFaceCount() * sizeof(Face));
+}
+
+/** Get pointers to the buffers of the mesh, without any copy. */
+PEACE_EXPORT MeshData readMeshData(MeshPtr meshPtr) {
+    auto *mesh = static_cast<Mesh *>(meshPtr);
+    MeshData result{};
+    result.vertices = reinterpret_cast<const double *>(mesh->getVertices());
+    result.indices = reinterpret_cast<const int *>(mesh->getFaces());
+    result.vertCount = mesh->getVerticesCount();
+    result.indicesCount = mesh->getFaceCount() * 3;
+    return result;
+}
+
+/** Fills the buffers with the content of the mesh converted to floats.
+ * positions and normals must have room for 3 floats per vertex, uvs for 2
+ * floats per vertex. Any of the vertex buffers can be null. */
+PEACE_EXPORT void readMeshFloat(MeshPtr meshPtr, float *positions,
+                                float *normals, float *uvs, int *indices) {
+    auto *mesh = static_cast<Mesh *>(meshPtr);
+    const double *vertices =
+        reinterpret_cast<const double *>(mesh->getVertices());
+    const u32 vertCount = mesh->getVerticesCount();
+
+    for (u32 i = 0; i < vertCount; ++i) {
+        const double *v = vertices + i * DOUBLE_VERTEX_SIZE;
+
+        if (positions) {
+            positions[i * 3 + 0] = static_cast<float>(v[0]);
+            positions[i * 3 + 1] = static_cast<float>(v[1]);
+            positions[i * 3 + 2] = static_cast<float>(v[2]);
+        }
+        if (normals) {
+            normals[i * 3 + 0] = static_cast<float>(v[3]);
+            normals[i * 3 + 1] = static_cast<float>(v[4]);
+            normals[i * 3 + 2] = static_cast<float>(v[5]);
+        }
+        if (uvs) {
+            uvs[i * 2 + 0] = static_cast<float>(v[6]);
+            uvs[i * 2 + 1] = static_cast<float>(v[7]);
+        }
+    }
+
+    if (indices) {
+        std::memcpy(indices, mesh->getFaces(),
+                    mesh->getFaceCount() * sizeof(Face));
+    }
+}
+
+/** Get the number of vertices and indices of each of the given meshes, so
+ * that all of them can be read with a single call to readMeshesFloat. */
+PEACE_EXPORT void readMeshesSizes(MeshPtr *meshPtrs, int count,
+                                  int *vertCounts, int *indicesCounts) {
+    for (int i = 0; i < count; ++i) {
+        auto *mesh = static_cast<Mesh *>(meshPtrs[i]);
+        vertCounts[i] = mesh->getVerticesCount();
+        indicesCounts[i] = mesh->getFaceCount() * 3;
+    }
+}
+
+/** Reads all the given meshes one after the other in the same buffers. The
+ * indices of each mesh are relative to its first vertex. */
+PEACE_EXPORT void readMeshesFloat(MeshPtr *meshPtrs, int count,
+                                  float *positions, float *normals, float *uvs,
+                                  int *indices) {
+    for (int i = 0; i < count; ++i) {
+        auto *mesh = static_cast<Mesh *>(meshPtrs[i]);
+        readMeshFloat(mesh, positions, normals, uvs, indices);
+
+        const u32 vertCount = mesh->getVerticesCount();
+        if (positions)
+            positions += vertCount * 3;
+        if (normals)
+            normals += vertCount * 3;
+        if (uvs)
+            uvs += vertCount * 2;
+        if (indices)
+            indices += mesh->getFaceCount() * 3;
+    }
+}
+
+/** Same as readMeshFloat for a compact mesh. The float buffers of the mesh
+ * are copied as is, only the quantized normals and the 16 bits indices are
+ * converted. */
+PEACE_EXPORT void readCompactMeshFloat(CompactMeshPtr meshPtr, float *positions,
+                                       float *normals, float *uvs,
+                                       int *indices) {
+    // The const overloads do not copy the shared indices
+    const auto *mesh = static_cast<const CompactMesh *>(meshPtr);
+    const u32 vertCount = mesh->getVerticesCount();
+    const u32 indexCount = mesh->getIndexCount();
+
+    if (positions) {
+        std::memcpy(positions, mesh->positions(),
+                    vertCount * 3 * sizeof(float));
+    }
+    if (normals) {
+        if (mesh->normals() != nullptr) {
+            std::memcpy(normals, mesh->normals(),
+                        vertCount * 3 * sizeof(float));
+        } else {
+            const s16 *quantized = mesh->quantizedNormals();
+
+            for (u32 i = 0; i < vertCount * 3; ++i) {
+                normals[i] = quantized[i] / 32767.f;
+            }
+        }
+    }
+    if (uvs) {
+        std::memcpy(uvs, mesh->textures(), vertCount * 2 * sizeof(float));
+    }
+    if (indices) {
+        if (mesh->hasShortIndices()) {
+            const u16 *shortIndices = mesh->shortIndices();
+            std::copy(shortIndices, shortIndices + indexCount, indices);
+        } else {
+            std::memcpy(indices, mesh->indices(), indexCount * sizeof(u32));
+        }
+    }
+}
 
-    for (u32 i = 0; i < mesh->getVerticesCount(); ++i) {
-        Vertex &vertex = mesh->getVertex(i);
-        std::memcpy(vertices + i * DOUBLE_VERTEX_SIZE, &vertex, sizeof(Vertex));
+/** Same as readMeshesSizes for compact meshes. */
+PEACE_EXPORT void readCompactMeshesSizes(CompactMeshPtr *meshPtrs, int count,
+                                         int *vertCounts, int *indicesCounts) {
+    for (int i = 0; i < count; ++i) {
+        const auto *mesh = static_cast<const CompactMesh *>(meshPtrs[i]);
+        vertCounts[i] = mesh->getVerticesCount();
+        indicesCounts[i] = mesh->getIndexCount();
     }
+}
+
+/** Same as readMeshesFloat for compact meshes. */
+PEACE_EXPORT void readCompactMeshesFloat(CompactMeshPtr *meshPtrs, int count,
+                                         float *positions, float *normals,
+                                         float *uvs, int *indices) {
+    for (int i = 0; i < count; ++i) {
+        const auto *mesh = static_cast<const CompactMesh *>(meshPtrs[i]);
+        readCompactMeshFloat(meshPtrs[i], positions, normals, uvs, indices);
 
-    for (u32 i = 0; i < mesh->getFaceCount(); ++i) {
-        Face &face = mesh->getFace(i);
-        indices[i * 3 + 0] = face.getID(0);
-        indices[i * 3 + 1] = face.getID(1);
-        indices[i * 3 + 2] = face.getID(2);
+        const u32 vertCount = mesh->getVerticesCount();
+        if (positions)
+            positions += vertCount * 3;
+        if (normals)
+            normals += vertCount * 3;
+        if (uvs)
+            uvs += vertCount * 2;
+        if (indices)
+            indices += mesh->getIndexCount();
     }
 }
 
@@ -33,9 +33,13 @@ const int NODE_CHANNEL = 0;
 const int MESH_CHANNEL = 1;
 const int MATERIAL_CHANNEL = 2;
 const int TEXTURE_CHANNEL = 3;
+/// Meshes of the generators that provide compact meshes, such as the terrain
+const int COMPACT_MESH_CHANNEL = 4;
 
 PEACE_EXPORT CollectorPtr createCollector() {
-    return new Collector(CollectorPresets::SCENE);
+    auto *collector = new Collector(CollectorPresets::SCENE);
+    collector->addStorageChannel<CompactMesh>();
+    return collector;
 }
 
 PEACE_EXPORT void freeCollector(CollectorPtr collectorPtr) {
@@ -63,6 +67,8 @@ PEACE_EXPORT int collectorGetChannelSize(CollectorPtr collectorPtr, int type) {
         return collector->getStorageChannel<Material>().size();
     case TEXTURE_CHANNEL:
         return collector->getStorageChannel<Image>().size();
+    case COMPACT_MESH_CHANNEL:
+        return collector->getStorageChannel<CompactMesh>().size();
     default:
         return -1;
     }
@@ -89,6 +95,10 @@ PEACE_EXPORT void collectorGetChannel(CollectorPtr collectorPtr, int type,
         getChannelContent(collector->getStorageChannel<Image>(), names,
                           objects);
         break;
+    case COMPACT_MESH_CHANNEL:
+        getChannelContent(collector->getStorageChannel<CompactMesh>(), names,
+                          objects);
+        break;
     default:
         // Return error
         break;
@@ -16,6 +16,7 @@ typedef void *CollectorPtr;
 typedef void *WorldPtr;
 typedef void *SceneNodePtr;
 typedef void *MeshPtr;
+typedef void *CompactMeshPtr;
 typedef void *MaterialPtr;
 typedef void *TexturePtr;
 
@@ -98,6 +98,14 @@ void MultilayerGroundTextureOld::addLayer(
     _internal->_layers.push_back({distribution, textureShader});
 }
 
+void MultilayerGroundTextureOld::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+
+    for (const auto &layer : _internal->_layers) {
+        stream << layer._distributionParams << layer._textureShader << ";";
+    }
+}
+
 void MultilayerGroundTextureOld::processTerrain(Terrain &terrain) {
     process(terrain, terrain.getTexture(), {0, 0}, 0);
     flush();
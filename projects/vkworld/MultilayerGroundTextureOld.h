@@ -30,6 +30,12 @@ public:
 
     void flush() override;
 
+    void writeConfig(std::ostream &stream) const override;
+
+    bool fillsBorder() const override { return true; }
+
+    bool isTexturer() const override { return true; }
+
 private:
     MultilayerGroundTextureOldPrivate *_internal;
 
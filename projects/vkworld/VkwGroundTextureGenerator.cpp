@@ -44,6 +44,15 @@ void VkwGroundTextureGenerator::addLayer(const std::string &textureShader) {
     _internal->_layers.push_back(textureShader);
 }
 
+void VkwGroundTextureGenerator::writeConfig(std::ostream &stream) const {
+    ITextureProvider::writeConfig(stream);
+    stream << _baseWorldWidth << ";";
+
+    for (const std::string &layer : _internal->_layers) {
+        stream << layer << ";";
+    }
+}
+
 size_t VkwGroundTextureGenerator::getLayerCount() {
     return _internal->_layers.size();
 }
@@ -31,6 +31,8 @@ public:
 
     void setBaseWorldWidth(float width) { _baseWorldWidth = width; }
 
+    void writeConfig(std::ostream &stream) const override;
+
 private:
     VkwGroundTextureGeneratorPrivate *_internal;
 
@@ -271,6 +271,16 @@ void VkwMultilayerGroundTexture::flush() {
     _internal->_queue.clear();
 }
 
+void VkwMultilayerGroundTexture::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _internal->_texWidth << ";";
+
+    for (const DistributionParams &layer : _internal->_layers) {
+        stream << layer;
+    }
+    _internal->_texGenerator.writeConfig(stream);
+}
+
 GridStorageBase *VkwMultilayerGroundTexture::getStorage() {
     return &_internal->_storage;
 }
@@ -31,8 +31,14 @@ public:
 
     void flush() override;
 
+    bool fillsBorder() const override { return true; }
+
+    bool isTexturer() const override { return true; }
+
     GridStorageBase *getStorage() override;
 
+    void writeConfig(std::ostream &stream) const override;
+
 private:
     MultilayerGroundTexturePrivate *_internal;
 };
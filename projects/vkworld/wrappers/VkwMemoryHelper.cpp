@@ -56,7 +56,7 @@ void VkwMemoryHelper::terrainToGPU(const Terrain &terrain,
 
     for (int y = 0; y < res; ++y) {
         for (int x = 0; x < res; ++x) {
-            buf[y * res + x] = float(terrain(x, y));
+            buf[y * res + x] = float(terrain.getHeight(x, y));
         }
     }
     memory.setData(buf, res * res * sizeof(float), 0);
@@ -0,0 +1,299 @@
+#include "CompactMesh.h"
+
+#include <limits>
+#include <stdexcept>
+
+#include "world/math/MathsHelper.h"
+
+namespace world {
+
+inline s16 quantizeNormal(double value) {
+    return static_cast<s16>(round(clamp(value, -1, 1) * 32767));
+}
+
+CompactMesh::CompactMesh(NormalFormat normalFormat)
+        : _normalFormat(normalFormat) {}
+
+CompactMesh::CompactMesh(const Mesh &mesh, NormalFormat normalFormat)
+        : _normalFormat(normalFormat) {
+    reserveVertices(mesh.getVerticesCount());
+    reserveFaces(mesh.getFaceCount());
+
+    for (u32 i = 0; i < mesh.getVerticesCount(); ++i) {
+        const Vertex &vert = mesh.getVertex(i);
+        addVertex(vert.getPosition(), vert.getNormal(), vert.getTexture());
+    }
+
+    for (u32 i = 0; i < mesh.getFaceCount(); ++i) {
+        const Face &face = mesh.getFace(i);
+        addFace(face.getID(0), face.getID(1), face.getID(2));
+    }
+}
+
+void CompactMesh::reserveVertices(u32 capacity) {
+    size_t count = _verticesCount + capacity;
+    _positions.reserve(count * 3);
+    _textures.reserve(count * 2);
+
+    if (_normalFormat == NormalFormat::FLOAT32) {
+        _normals.reserve(count * 3);
+    } else {
+        _quantizedNormals.reserve(count * 3);
+    }
+}
+
+void CompactMesh::reserveFaces(u32 capacity) {
+    detachIndices();
+
+    if (hasShortIndices()) {
+        _shortIndices.reserve(_shortIndices.size() + capacity * 3);
+    } else {
+        _indices.reserve(_indices.size() + capacity * 3);
+    }
+}
+
+u32 CompactMesh::getIndexCount() const {
+    if (_sharedIndices) {
+        return _sharedIndices->getIndexCount();
+    }
+    return static_cast<u32>(hasShortIndices() ? _shortIndices.size()
+                                              : _indices.size());
+}
+
+u32 CompactMesh::addVertex(const vec3d &position, const vec3d &normal,
+                           const vec2d &texture) {
+    _positions.push_back(static_cast<float>(position.x));
+    _positions.push_back(static_cast<float>(position.y));
+    _positions.push_back(static_cast<float>(position.z));
+
+    if (_normalFormat == NormalFormat::FLOAT32) {
+        _normals.push_back(static_cast<float>(normal.x));
+        _normals.push_back(static_cast<float>(normal.y));
+        _normals.push_back(static_cast<float>(normal.z));
+    } else {
+        _quantizedNormals.push_back(quantizeNormal(normal.x));
+        _quantizedNormals.push_back(quantizeNormal(normal.y));
+        _quantizedNormals.push_back(quantizeNormal(normal.z));
+    }
+
+    _textures.push_back(static_cast<float>(texture.x));
+    _textures.push_back(static_cast<float>(texture.y));
+
+    return _verticesCount++;
+}
+
+void CompactMesh::addFace(u32 id1, u32 id2, u32 id3) {
+    detachIndices();
+
+    if (hasShortIndices()) {
+        const u32 maxShort = std::numeric_limits<u16>::max();
+
+        if (id1 <= maxShort && id2 <= maxShort && id3 <= maxShort) {
+            _shortIndices.push_back(static_cast<u16>(id1));
+            _shortIndices.push_back(static_cast<u16>(id2));
+            _shortIndices.push_back(static_cast<u16>(id3));
+            return;
+        }
+
+        switchToLongIndices();
+    }
+
+    _indices.push_back(id1);
+    _indices.push_back(id2);
+    _indices.push_back(id3);
+}
+
+vec3d CompactMesh::getPosition(u32 id) const {
+    const float *p = &_positions.at(id * 3);
+    return {p[0], p[1], p[2]};
+}
+
+vec3d CompactMesh::getNormal(u32 id) const {
+    if (_normalFormat == NormalFormat::FLOAT32) {
+        const float *n = &_normals.at(id * 3);
+        return {n[0], n[1], n[2]};
+    } else {
+        const s16 *n = &_quantizedNormals.at(id * 3);
+        return vec3d{double(n[0]), double(n[1]), double(n[2])} / 32767.;
+    }
+}
+
+vec2d CompactMesh::getTexture(u32 id) const {
+    const float *t = &_textures.at(id * 2);
+    return {t[0], t[1]};
+}
+
+u32 CompactMesh::getIndex(u32 i) const {
+    if (_sharedIndices) {
+        return _sharedIndices->getIndex(i);
+    }
+    return hasShortIndices() ? _shortIndices.at(i) : _indices.at(i);
+}
+
+void CompactMesh::setPosition(u32 id, const vec3d &position) {
+    float *p = &_positions.at(id * 3);
+    p[0] = static_cast<float>(position.x);
+    p[1] = static_cast<float>(position.y);
+    p[2] = static_cast<float>(position.z);
+}
+
+void CompactMesh::setNormal(u32 id, const vec3d &normal) {
+    if (_normalFormat == NormalFormat::FLOAT32) {
+        float *n = &_normals.at(id * 3);
+        n[0] = static_cast<float>(normal.x);
+        n[1] = static_cast<float>(normal.y);
+        n[2] = static_cast<float>(normal.z);
+    } else {
+        s16 *n = &_quantizedNormals.at(id * 3);
+        n[0] = quantizeNormal(normal.x);
+        n[1] = quantizeNormal(normal.y);
+        n[2] = quantizeNormal(normal.z);
+    }
+}
+
+void CompactMesh::setTexture(u32 id, const vec2d &texture) {
+    float *t = &_textures.at(id * 2);
+    t[0] = static_cast<float>(texture.x);
+    t[1] = static_cast<float>(texture.y);
+}
+
+void CompactMesh::resize(u32 verticesCount, u32 indexCount,
+                         bool shortIndices) {
+    _verticesCount = verticesCount;
+    _positions.resize(verticesCount * 3);
+    _textures.resize(verticesCount * 2);
+
+    if (_normalFormat == NormalFormat::FLOAT32) {
+        _normals.resize(verticesCount * 3);
+    } else {
+        _quantizedNormals.resize(verticesCount * 3);
+    }
+
+    detachIndices();
+
+    if (shortIndices) {
+        if (!hasShortIndices()) {
+            throw std::runtime_error(
+                "CompactMesh::resize cannot go back to short indices");
+        }
+        _shortIndices.resize(indexCount);
+    } else {
+        if (hasShortIndices()) {
+            switchToLongIndices();
+        }
+        _indices.resize(indexCount);
+    }
+}
+
+const float *CompactMesh::normals() const {
+    return _normalFormat == NormalFormat::FLOAT32 ? _normals.data() : nullptr;
+}
+
+float *CompactMesh::normals() {
+    return _normalFormat == NormalFormat::FLOAT32 ? _normals.data() : nullptr;
+}
+
+const s16 *CompactMesh::quantizedNormals() const {
+    return _normalFormat == NormalFormat::SNORM16 ? _quantizedNormals.data()
+                                                  : nullptr;
+}
+
+s16 *CompactMesh::quantizedNormals() {
+    return _normalFormat == NormalFormat::SNORM16 ? _quantizedNormals.data()
+                                                  : nullptr;
+}
+
+void CompactMesh::setSharedIndices(
+    std::shared_ptr<const CompactMesh> indices) {
+    if (indices->_sharedIndices) {
+        indices = indices->_sharedIndices;
+    }
+
+    _shortIndexFormat = true;
+    _shortIndices = std::vector<u16>();
+    _indices = std::vector<u32>();
+    _sharedIndices = std::move(indices);
+}
+
+const u16 *CompactMesh::shortIndices() const {
+    if (_sharedIndices) {
+        return _sharedIndices->shortIndices();
+    }
+    return hasShortIndices() ? _shortIndices.data() : nullptr;
+}
+
+u16 *CompactMesh::shortIndices() {
+    detachIndices();
+    return hasShortIndices() ? _shortIndices.data() : nullptr;
+}
+
+const u32 *CompactMesh::indices() const {
+    if (_sharedIndices) {
+        return _sharedIndices->indices();
+    }
+    return hasShortIndices() ? nullptr : _indices.data();
+}
+
+u32 *CompactMesh::indices() {
+    detachIndices();
+    return hasShortIndices() ? nullptr : _indices.data();
+}
+
+void CompactMesh::clear() {
+    _verticesCount = 0;
+    _positions.clear();
+    _normals.clear();
+    _quantizedNormals.clear();
+    _textures.clear();
+    _shortIndexFormat = true;
+    _shortIndices.clear();
+    _indices = std::vector<u32>();
+    _sharedIndices.reset();
+}
+
+Mesh CompactMesh::toMesh(const std::string &name) const {
+    Mesh mesh(name);
+    mesh.reserveVertices(_verticesCount);
+    mesh.reserveFaces(getFaceCount());
+
+    for (u32 i = 0; i < _verticesCount; ++i) {
+        mesh.newVertex(getPosition(i), getNormal(i), getTexture(i));
+    }
+
+    const u32 indexCount = getIndexCount();
+
+    for (u32 i = 0; i < indexCount; i += 3) {
+        mesh.newFace(getIndex(i), getIndex(i + 1), getIndex(i + 2));
+    }
+    return mesh;
+}
+
+void CompactMesh::switchToLongIndices() {
+    _shortIndexFormat = false;
+    _indices.reserve(_shortIndices.capacity());
+    _indices.assign(_shortIndices.begin(), _shortIndices.end());
+    _shortIndices = std::vector<u16>();
+}
+
+void CompactMesh::detachIndices() {
+    if (!_sharedIndices) {
+        return;
+    }
+
+    std::shared_ptr<const CompactMesh> shared = std::move(_sharedIndices);
+    _sharedIndices.reset();
+    _shortIndexFormat = shared->_shortIndexFormat;
+    _shortIndices = shared->_shortIndices;
+    _indices = shared->_indices;
+}
+
+size_t CompactMesh::getMemoryUsage() const {
+    return (_positions.capacity() + _normals.capacity() +
+            _textures.capacity()) *
+               sizeof(float) +
+           _quantizedNormals.capacity() * sizeof(s16) +
+           _shortIndices.capacity() * sizeof(u16) +
+           _indices.capacity() * sizeof(u32);
+}
+
+} // namespace world
@@ -0,0 +1,163 @@
+#ifndef WORLD_COMPACT_MESH_H
+#define WORLD_COMPACT_MESH_H
+
+#include "world/core/WorldConfig.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "world/math/Vector.h"
+#include "world/core/WorldTypes.h"
+#include "Mesh.h"
+
+namespace world {
+
+/** A triangle mesh stored as a structure of arrays of 32 bits floats, with a
+ * contiguous index buffer. Indices are stored on 16 bits as long as the
+ * vertices fit in it, and normals can be quantized on 3 x 16 bits.
+ *
+ * A CompactMesh takes less than half the memory of a Mesh with the same
+ * content, and each of its buffers can be uploaded to the GPU with a single
+ * copy. On the other hand vertices cannot be accessed by reference, so Mesh
+ * is more convenient to build complex geometry. */
+class WORLDAPI_EXPORT CompactMesh {
+public:
+    enum class NormalFormat {
+        /// 3 x 32 bits floats per normal
+        FLOAT32,
+        /// 3 x 16 bits signed integers per normal, mapped to [-1, 1]
+        SNORM16,
+    };
+
+    explicit CompactMesh(NormalFormat normalFormat = NormalFormat::FLOAT32);
+
+    /** Creates a compact copy of the given mesh. */
+    explicit CompactMesh(const Mesh &mesh,
+                         NormalFormat normalFormat = NormalFormat::FLOAT32);
+
+    NormalFormat getNormalFormat() const { return _normalFormat; }
+
+    void reserveVertices(u32 capacity);
+
+    void reserveFaces(u32 capacity);
+
+    u32 getVerticesCount() const { return _verticesCount; }
+
+    u32 getFaceCount() const { return getIndexCount() / 3; }
+
+    u32 getIndexCount() const;
+
+    /** @returns getFaceCount() == 0 */
+    bool empty() const { return getFaceCount() == 0; }
+
+    /** Adds a vertex at the end of the mesh and returns its index. */
+    u32 addVertex(const vec3d &position, const vec3d &normal = {0, 0, 1},
+                  const vec2d &texture = {0, 0});
+
+    void addFace(u32 id1, u32 id2, u32 id3);
+
+    vec3d getPosition(u32 id) const;
+
+    vec3d getNormal(u32 id) const;
+
+    vec2d getTexture(u32 id) const;
+
+    u32 getIndex(u32 i) const;
+
+    void setPosition(u32 id, const vec3d &position);
+
+    void setNormal(u32 id, const vec3d &normal);
+
+    void setTexture(u32 id, const vec2d &texture);
+
+    /** Resizes the buffers to the given number of vertices and indices, so
+     * that they can be filled directly through the raw buffers. Added values
+     * are set to zero. */
+    void resize(u32 verticesCount, u32 indexCount, bool shortIndices = true);
+
+    // Raw buffers
+
+    /** Positions of the vertices, as x0, y0, z0, x1, y1, ... */
+    const float *positions() const { return _positions.data(); }
+
+    float *positions() { return _positions.data(); }
+
+    /** Normals of the vertices, as x0, y0, z0, x1, ... or nullptr if the
+     * normals are quantized. */
+    const float *normals() const;
+
+    float *normals();
+
+    /** Quantized normals of the vertices, or nullptr if they are not
+     * quantized. The value of a component is x / 32767. */
+    const s16 *quantizedNormals() const;
+
+    s16 *quantizedNormals();
+
+    /** Texture coordinates of the vertices, as u0, v0, u1, v1... */
+    const float *textures() const { return _textures.data(); }
+
+    float *textures() { return _textures.data(); }
+
+    /** Use the indices of the given mesh instead of the indices of this
+     * mesh, which are released. Meshes with the same topology can share a
+     * single immutable index buffer this way. Modifying the indices of this
+     * mesh afterwards, or getting the non-const index buffers, makes a copy
+     * of the shared indices first. */
+    void setSharedIndices(std::shared_ptr<const CompactMesh> indices);
+
+    bool hasSharedIndices() const { return _sharedIndices != nullptr; }
+
+    /** Returns true if the indices are stored on 16 bits, false if they are
+     * stored on 32 bits. */
+    bool hasShortIndices() const {
+        return _sharedIndices ? _sharedIndices->hasShortIndices()
+                              : _shortIndexFormat;
+    }
+
+    /** Indices on 16 bits, or nullptr if #hasShortIndices is false. */
+    const u16 *shortIndices() const;
+
+    u16 *shortIndices();
+
+    /** Indices on 32 bits, or nullptr if #hasShortIndices is true. */
+    const u32 *indices() const;
+
+    u32 *indices();
+
+    void clear();
+
+    /** Creates a Mesh with the same content as this compact mesh. */
+    Mesh toMesh(const std::string &name = "") const;
+
+    /** Get the number of bytes allocated by the buffers. Shared indices are
+     * not counted. */
+    size_t getMemoryUsage() const;
+
+private:
+    NormalFormat _normalFormat;
+    u32 _verticesCount = 0;
+
+    std::vector<float> _positions;
+    std::vector<float> _normals;
+    std::vector<s16> _quantizedNormals;
+    std::vector<float> _textures;
+
+    /// Used as long as all the indices fit in 16 bits
+    bool _shortIndexFormat = true;
+    std::vector<u16> _shortIndices;
+    std::vector<u32> _indices;
+    /// Mesh holding the indices, if they are shared
+    std::shared_ptr<const CompactMesh> _sharedIndices;
+
+
+    void switchToLongIndices();
+
+    /** Copy the shared indices in this mesh, so that they can be modified. */
+    void detachIndices();
+};
+
+} // namespace world
+
+#endif // WORLD_COMPACT_MESH_H
@@ -209,6 +209,10 @@ int Image::width() const { return _internal->_image.cols; }
 
 int Image::height() const { return _internal->_image.rows; }
 
+u8 *Image::data() { return _internal->_image.data; }
+
+const u8 *Image::data() const { return _internal->_image.data; }
+
 RGBAPixel &Image::rgba(int x, int y) {
     return _internal->_image.at<RGBAPixel>(y, x);
 }
@@ -476,6 +480,12 @@ int Image::height() const { return _internal->_sizeY; }
 
 int Image::size() const { return _internal->total(); }
 
+size_t Image::getMemoryUsage() const { return size_t(size()); }
+
+u8 *Image::data() { return _internal->_data; }
+
+const u8 *Image::data() const { return _internal->_data; }
+
 RGBAPixel &Image::rgba(int x, int y) {
     return *reinterpret_cast<RGBAPixel *>(_internal->at(x, y));
 }
@@ -107,6 +107,16 @@ public:
     /// Get the total size of the image (width * height * elemSize)
     int size() const;
 
+    /** Get the number of bytes allocated by the pixel buffer. */
+    size_t getMemoryUsage() const;
+
+    /** Get the raw pixel buffer. Pixels are stored row by row, each one
+     * taking elemSize() bytes. The channels of a pixel are stored in BGR
+     * order, followed by the alpha channel for RGBA images. */
+    u8 *data();
+
+    const u8 *data() const;
+
     // access
     /** Gets a rgba access on the pixel at (x, y). This
      * method only works properly on RGBA image.
@@ -7,6 +7,12 @@
 
 namespace world {
 
+// Vertex and Face buffers are exported without conversion
+static_assert(sizeof(Vertex) == 8 * sizeof(double),
+              "Vertex must only contain its 8 components");
+static_assert(sizeof(Face) == 3 * sizeof(int),
+              "Face must only contain its 3 indices");
+
 //----- FACE
 
 Face::Face() : _ids{0, 0, 0} {}
@@ -15,8 +21,6 @@ Face::Face(int id1, int id2, int id3) : _ids{id1, id2, id3} {}
 
 Face::Face(int *ids) : _ids{ids[0], ids[1], ids[2]} {}
 
-Face::~Face() {}
-
 int Face::getID(int vert) const { return _ids[vert]; }
 
 void Face::setID(int vert, int id) { _ids[vert] = id; }
@@ -87,6 +91,11 @@ void Mesh::reserveVertices(u32 count) {
 
 u32 Mesh::getVerticesCount() const { return _verticesCount; }
 
+size_t Mesh::getMemoryUsage() const {
+    return _vertices.capacity() * sizeof(Vertex) +
+           _faces.capacity() * sizeof(Face);
+}
+
 const Vertex &Mesh::getVertex(u32 id) const {
     if (id >= _verticesCount)
         throw std::runtime_error("Mesh::getVertex bad index");
@@ -52,8 +52,6 @@ public:
 
     Face(int ids[3]);
 
-    virtual ~Face();
-
     void setID(int vert, int id);
 
     int getID(int vert) const;
@@ -89,6 +87,10 @@ public:
 
     const Face &getFace(u32 id) const;
 
+    /** Get a pointer to the faces of the mesh, which are stored contiguously
+     * as 3 ints each. The pointer is invalidated when faces are added. */
+    const Face *getFaces() const { return _faces.data(); }
+
     void addFace(const Face &face);
 
     Face &newFace();
@@ -109,6 +111,11 @@ public:
 
     Vertex &getVertex(u32 id);
 
+    /** Get a pointer to the vertices of the mesh, which are stored
+     * contiguously as 8 doubles each (position, normal, texture). The pointer
+     * is invalidated when vertices are added. */
+    const Vertex *getVertices() const { return _vertices.data(); }
+
     const Vertex &getVertex(u32 id) const;
 
     void addVertex(const Vertex &vert);
@@ -120,6 +127,9 @@ public:
 
     void clearVertices();
 
+    /** Get the number of bytes allocated by the vertex and face buffers. */
+    size_t getMemoryUsage() const;
+
 private:
     std::string _name;
     u32 _verticesCount = 0;
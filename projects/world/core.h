@@ -9,6 +9,7 @@
 #include "math/Interpolation.h"
 #include "math/MathsHelper.h"
 #include "math/Perlin.h"
+#include "math/RandomStream.h"
 #include "math/Vector.h"
 
 #include "assets/Color.h"
@@ -16,6 +17,7 @@
 #include "assets/ImageUtils.h"
 #include "assets/Material.h"
 #include "assets/Mesh.h"
+#include "assets/CompactMesh.h"
 #include "assets/MeshOps.h"
 #include "assets/SceneNode.h"
 #include "assets/ObjLoader.h"
@@ -28,12 +30,15 @@
 #include "core/World.h"
 #include "core/WorldNode.h"
 #include "core/WorldFolder.h"
+#include "core/ICache.h"
+#include "core/DirectoryCache.h"
 
 #include "core/Chunk.h"
 #include "core/IChunkSystem.h"
 #include "core/GridChunkSystem.h"
 #include "core/GridStorage.h"
 #include "core/GridStorageReducer.h"
+#include "core/GridStoragePolicies.h"
 #include "core/InstancePool.h"
 #include "core/SeedDistribution.h"
 
@@ -45,10 +50,15 @@
 
 #include "core/ICloneable.h"
 #include "core/Memory.h"
+#include "core/MemoryRegistry.h"
+#include "core/ObjectPool.h"
 #include "core/IOUtil.h"
 #include "core/TileSystem.h"
+#include "core/TileGenerationQueue.h"
+#include "core/ThreadPool.h"
 #include "core/StringOps.h"
 #include "core/Profiler.h"
+#include "core/Tracer.h"
 #include "core/WeightedSkeletton.h"
 #include "core/ColorMap.h"
 #include "core/Parameters.h"
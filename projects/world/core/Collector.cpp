@@ -21,6 +21,29 @@ void Collector::reset() {
     }
 }
 
+void Collector::setDeltaMode(bool deltaMode) {
+    _deltaMode = deltaMode;
+
+    for (auto &entry : _channels) {
+        entry.second->setDeltaMode(deltaMode);
+    }
+}
+
+void Collector::endCollect() {
+    for (auto &entry : _channels) {
+        entry.second->endCollect();
+    }
+}
+
+size_t Collector::getMemoryUsage() const {
+    size_t bytes = 0;
+
+    for (auto &entry : _channels) {
+        bytes += entry.second->getMemoryUsage();
+    }
+    return bytes;
+}
+
 Scene Collector::toScene() {
     Scene scene;
     fillScene(scene);
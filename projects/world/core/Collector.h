@@ -5,13 +5,16 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "WorldTypes.h"
 #include "world/assets/SceneNode.h"
+#include "world/assets/CompactMesh.h"
 #include "world/assets/Material.h"
 #include "world/assets/Scene.h"
 
 #include "ICollector.h"
+#include "Tracer.h"
 
 namespace world {
 
@@ -34,9 +37,36 @@ public:
     Collector(CollectorPresets preset = CollectorPresets::NONE);
 
     /** Delete all the resources harvested from the previous
-     * "collect" calls */
+     * "collect" calls. In delta mode, the resources are kept and a new
+     * collect is started instead. */
     virtual void reset();
 
+    /** In delta mode, the collector keeps the items of the previous collect
+     * and only records the changes: the items put or kept during a collect
+     * that were not present before are listed as added, and the items of the
+     * previous collect that were not collected again are removed and listed
+     * as removed. This way the user only processes what changed between two
+     * collects.
+     *
+     * An item is never replaced under the same key: a generator that changes
+     * an item must give it a new key, for example with a version, so that
+     * the old item is removed and the new one added.
+     *
+     * A delta collect is a call to #reset, followed by the calls to
+     * World::collect, and ended by a call to #endCollect. */
+    void setDeltaMode(bool deltaMode);
+
+    bool isDeltaMode() const { return _deltaMode; }
+
+    /** Ends the current collect. In delta mode, the items that were not
+     * collected since the last #reset are removed from the channels. Does
+     * nothing if delta mode is disabled. */
+    void endCollect();
+
+    /** Get an estimate of the number of bytes held by the channels. Items
+     * shared with their generator are counted too. */
+    size_t getMemoryUsage() const;
+
     template <typename T> CollectorChannel<T> &addStorageChannel();
 
     // TODO simplify method call (only one required template argument instead of
@@ -61,6 +91,7 @@ protected:
 #else
     std::map<size_t, std::unique_ptr<ICollectorChannelBase>> _channels;
 #endif
+    bool _deltaMode = false;
 
 
     ICollectorChannelBase &getChannelByType(size_t type) override;
@@ -89,32 +120,70 @@ public:
              const ExplorationContext &ctx =
                  ExplorationContext::getDefault()) override;
 
+    /** Stores the given item without copying it. */
+    void putShared(const ItemKey &key, std::shared_ptr<const T> item,
+                   const ExplorationContext &ctx =
+                       ExplorationContext::getDefault()) override;
+
     bool has(const ItemKey &key,
              const ExplorationContext &ctx =
                  ExplorationContext::getDefault()) const override;
 
+    bool keep(const ItemKey &key,
+              const ExplorationContext &ctx =
+                  ExplorationContext::getDefault()) override;
+
     void remove(const ItemKey &key,
                 const ExplorationContext &ctx =
                     ExplorationContext::getDefault()) override;
 
     const T &get(const ItemKey &key) const;
 
+    /** Get a reference to the item that stays valid after the channel is
+     * reset. */
+    std::shared_ptr<const T> getShared(const ItemKey &key) const;
+
     size_t size() const { return _items.size(); }
 
     /** Delete all the resources harvested from the previous
      * "collect" calls */
     void reset() override;
 
+    /** In delta mode, an item of the previous collect is kept as is when it
+     * is put again, or when #keep is called with its key: items are supposed
+     * not to change as long as their key stays the same. */
+    void setDeltaMode(bool deltaMode) override { _deltaMode = deltaMode; }
+
+    void endCollect() override;
+
+    size_t getMemoryUsage() const override;
+
+    /** Keys of the items added during the current collect. Only filled in
+     * delta mode. */
+    const std::vector<ItemKey> &getAddedKeys() const { return _added; }
+
+    /** Keys of the items removed at the end of the last collect. Only filled
+     * in delta mode. */
+    const std::vector<ItemKey> &getRemovedKeys() const { return _removed; }
+
     CollectorChannelIterator<T> begin();
 
     CollectorChannelIterator<T> end();
 
 protected:
-#ifdef _MSC_VER
-    std::map<ItemKey, std::shared_ptr<T>> _items;
-#else
-    std::map<ItemKey, std::unique_ptr<T>> _items;
-#endif
+    /// Items are immutable, so that they can be shared
+    std::map<ItemKey, std::shared_ptr<const T>> _items;
+
+    bool _deltaMode = false;
+    /// Keys collected since the last reset, in delta mode
+    std::set<ItemKey> _collected;
+    std::vector<ItemKey> _added;
+    std::vector<ItemKey> _removed;
+
+
+    /** Returns true if the item at the given key is kept from the previous
+     * collect, and thus must not be replaced. */
+    bool keepPrevious(const ItemKey &key);
 };
 
 template <typename T> struct CollectorEntry {
@@ -139,13 +208,8 @@ public:
     using reference = CollectorEntry<T>&;*/
 
 
-#ifdef _MSC_VER
     CollectorChannelIterator(
-        typename std::map<ItemKey, std::shared_ptr<T>>::iterator it);
-#else
-    CollectorChannelIterator(
-        typename std::map<ItemKey, std::unique_ptr<T>>::iterator it);
-#endif
+        typename std::map<ItemKey, std::shared_ptr<const T>>::iterator it);
 
     CollectorChannelIterator<T> &operator++();
 
@@ -156,11 +220,7 @@ public:
     bool operator!=(const CollectorChannelIterator<T> &other) const;
 
 private:
-#ifdef _MSC_VER
-    typename std::map<ItemKey, std::shared_ptr<T>>::iterator _it;
-#else
-    typename std::map<ItemKey, std::unique_ptr<T>>::iterator _it;
-#endif
+    typename std::map<ItemKey, std::shared_ptr<const T>>::iterator _it;
 };
 
 } // namespace world
@@ -14,6 +14,7 @@ inline CustomChannel &Collector::addCustomChannel(Args &&... args) {
     auto ptr = std::make_unique<CustomChannel>(args...);
 #endif
     CustomChannel &ref = *ptr;
+    ref.setDeltaMode(_deltaMode);
     _channels.emplace(type, std::move(ptr));
     return ref;
 }
@@ -45,16 +46,48 @@ inline CollectorChannel<T> &Collector::getStorageChannel() {
 
 // ====== CollectorChannel
 
+/** Estimate of the memory used by an item stored in a channel. */
+template <typename T> inline size_t itemMemoryUsage(const T &item) {
+    return sizeof(T);
+}
+
+inline size_t itemMemoryUsage(const Mesh &mesh) {
+    return sizeof(Mesh) + mesh.getMemoryUsage();
+}
+
+inline size_t itemMemoryUsage(const CompactMesh &mesh) {
+    return sizeof(CompactMesh) + mesh.getMemoryUsage();
+}
+
+inline size_t itemMemoryUsage(const Image &image) {
+    return sizeof(Image) + image.getMemoryUsage();
+}
+
 template <typename T> inline CollectorChannel<T>::CollectorChannel() = default;
 
 template <typename T>
 inline void CollectorChannel<T>::put(const ItemKey &key, const T &item,
                                      const ExplorationContext &ctx) {
-#ifdef _MSC_VER
-    _items[ctx.mutateKey(key)] = std::make_shared<T>(item);
-#else
-    _items[ctx.mutateKey(key)] = std::make_unique<T>(item);
-#endif
+    WORLD_TRACE_ZONE("CollectorChannel::put", typeid(T).name());
+    ItemKey mutkey = ctx.mutateKey(key);
+
+    if (keepPrevious(mutkey)) {
+        return;
+    }
+    _items[mutkey] = std::make_shared<const T>(item);
+}
+
+template <typename T>
+inline void CollectorChannel<T>::putShared(const ItemKey &key,
+                                           std::shared_ptr<const T> item,
+                                           const ExplorationContext &ctx) {
+    WORLD_TRACE_ZONE("CollectorChannel::putShared", typeid(T).name());
+    ItemKey mutkey = ctx.mutateKey(key);
+
+    if (keepPrevious(mutkey)) {
+        return;
+    }
+    _items[mutkey] = std::move(item);
 }
 
 template <typename T>
@@ -63,6 +96,21 @@ inline bool CollectorChannel<T>::has(const ItemKey &key,
     return _items.find(ctx.mutateKey(key)) != _items.end();
 }
 
+template <typename T>
+inline bool CollectorChannel<T>::keep(const ItemKey &key,
+                                      const ExplorationContext &ctx) {
+    ItemKey mutkey = ctx.mutateKey(key);
+
+    if (_items.find(mutkey) == _items.end()) {
+        return false;
+    }
+    if (_deltaMode) {
+        // The item of the previous collect is collected again
+        _collected.insert(mutkey);
+    }
+    return true;
+}
+
 template <typename T>
 inline void CollectorChannel<T>::remove(const ItemKey &key,
                                         const ExplorationContext &ctx) {
@@ -74,8 +122,58 @@ inline const T &CollectorChannel<T>::get(const ItemKey &key) const {
     return *_items.at(key);
 }
 
+template <typename T>
+inline std::shared_ptr<const T> CollectorChannel<T>::getShared(
+    const ItemKey &key) const {
+    return _items.at(key);
+}
+
 template <typename T> inline void CollectorChannel<T>::reset() {
-    _items.clear();
+    if (!_deltaMode) {
+        _items.clear();
+    }
+    _collected.clear();
+    _added.clear();
+    _removed.clear();
+}
+
+template <typename T> inline void CollectorChannel<T>::endCollect() {
+    if (!_deltaMode) {
+        return;
+    }
+
+    for (auto it = _items.begin(); it != _items.end();) {
+        if (_collected.find(it->first) == _collected.end()) {
+            _removed.push_back(it->first);
+            it = _items.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+template <typename T>
+inline size_t CollectorChannel<T>::getMemoryUsage() const {
+    size_t bytes = 0;
+
+    for (auto &entry : _items) {
+        bytes += sizeof(entry) + itemMemoryUsage(*entry.second);
+    }
+    return bytes;
+}
+
+template <typename T>
+inline bool CollectorChannel<T>::keepPrevious(const ItemKey &key) {
+    if (!_deltaMode || !_collected.insert(key).second) {
+        // Not in delta mode, or already put during this collect
+        return false;
+    }
+
+    if (_items.find(key) != _items.end()) {
+        return true;
+    }
+    _added.push_back(key);
+    return false;
 }
 
 template <typename T>
@@ -93,15 +191,24 @@ template <>
 inline void CollectorChannel<SceneNode>::put(const ItemKey &key,
                                              const SceneNode &item,
                                              const ExplorationContext &ctx) {
+    ItemKey mutkey = ctx.mutateKey(key);
 
-#ifdef _MSC_VER
-    auto &newItem = _items[ctx.mutateKey(key)] =
-        std::make_shared<SceneNode>(item);
-#else
-    auto &newItem = _items[ctx.mutateKey(key)] =
-        std::make_unique<SceneNode>(item);
-#endif
+    if (keepPrevious(mutkey)) {
+        return;
+    }
+    auto newItem = std::make_shared<SceneNode>(item);
     newItem->setPosition(newItem->getPosition() + ctx.getOffset());
+    _items[mutkey] = std::move(newItem);
+}
+
+// Nodes and materials are modified according to the context, so they can
+// not be shared.
+
+template <>
+inline void CollectorChannel<SceneNode>::putShared(
+    const ItemKey &key, std::shared_ptr<const SceneNode> item,
+    const ExplorationContext &ctx) {
+    put(key, *item, ctx);
 }
 
 template <>
@@ -110,27 +217,28 @@ inline void CollectorChannel<Material>::put(const ItemKey &key,
                                             const ExplorationContext &ctx) {
 
     ItemKey mutkey = ctx.mutateKey(key);
-#ifdef _MSC_VER
-    auto &newItem = _items[mutkey] = std::make_shared<Material>(item);
-#else
-    auto &newItem = _items[mutkey] = std::make_unique<Material>(item);
-#endif
+
+    if (keepPrevious(mutkey)) {
+        return;
+    }
+    auto newItem = std::make_shared<Material>(item);
     newItem->setName(mutkey.str());
+    _items[mutkey] = std::move(newItem);
+}
+
+template <>
+inline void CollectorChannel<Material>::putShared(
+    const ItemKey &key, std::shared_ptr<const Material> item,
+    const ExplorationContext &ctx) {
+    put(key, *item, ctx);
 }
 
 // ====== CollectorChannelIterator
 
-#ifdef _MSC_VER
 template <typename T>
 inline CollectorChannelIterator<T>::CollectorChannelIterator(
-    typename std::map<ItemKey, std::shared_ptr<T>>::iterator it)
+    typename std::map<ItemKey, std::shared_ptr<const T>>::iterator it)
         : _it(it) {}
-#else
-template <typename T>
-inline CollectorChannelIterator<T>::CollectorChannelIterator(
-    typename std::map<ItemKey, std::unique_ptr<T>>::iterator it)
-        : _it(it) {}
-#endif
 
 template <typename T>
 inline CollectorChannelIterator<T> &CollectorChannelIterator<T>::operator++() {
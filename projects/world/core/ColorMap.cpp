@@ -7,6 +7,14 @@ ColorMap::ColorMap(const vec2i &res)
 
 void ColorMap::setOrder(int order) { _order = order; }
 
+void ColorMap::write(std::ostream &stream) const {
+    stream << _order << ";";
+
+    for (auto &point : _points) {
+        stream << point.first << point.second << ";";
+    }
+}
+
 void ColorMap::addPoint(const vec2d &pos, const Color4d &color) {
     _points.emplace_back(pos, toInternalColor(color));
 
@@ -40,10 +48,14 @@ void ColorMap::rebuild() {
     _shouldRebuild = false;
 }
 
-Color4d ColorMap::getColorAt(const vec2d &pos) {
+void ColorMap::update() {
     if (_shouldRebuild) {
         rebuild();
     }
+}
+
+Color4d ColorMap::getColorAt(const vec2d &pos) {
+    update();
 
     auto ix = static_cast<arma::uword>(pos.x * (_cache.n_rows - 1));
     auto iy = static_cast<arma::uword>(pos.y * (_cache.n_cols - 1));
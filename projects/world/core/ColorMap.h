@@ -35,13 +35,31 @@ public:
 
     void rebuild();
 
+    /** Rebuild the color map only if points were added since the last
+     * build. After this call, #getColorAt can be called from several threads
+     * at the same time, as long as the color map is not modified. */
+    void update();
+
     /** Gets the color at the given point.
      * @param pos A location on the color map. All the coordinates should be
      * between 0 and 1. */
     Color4d getColorAt(const vec2d &pos);
 
+    /** Same as #getColorAt, but the color map is not rebuilt: #update must
+     * have been called since the last modification. The color is returned
+     * as a vector with components between 0 and 1. */
+    color getBuiltColorAt(double x, double y) const {
+        auto ix = static_cast<arma::uword>(x * (_cache.n_rows - 1));
+        auto iy = static_cast<arma::uword>(y * (_cache.n_cols - 1));
+        return {_cache.at(ix, iy, 0), _cache.at(ix, iy, 1),
+                _cache.at(ix, iy, 2)};
+    }
+
     Image *createImage();
 
+    /** Writes the points and the order of this color map. */
+    void write(std::ostream &stream) const;
+
 private:
     int _order = 3;
     std::vector<std::pair<position, color>> _points;
@@ -0,0 +1,131 @@
+#include "DirectoryCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "IOUtil.h"
+
+namespace world {
+
+#ifdef _WIN32
+/** Fallback for platforms without mmap: the file is read entirely. */
+class FileCacheView : public CacheView {
+public:
+    std::vector<char> _data;
+
+    const char *data() const override { return _data.data(); }
+
+    size_t size() const override { return _data.size(); }
+};
+#else
+class MappedCacheView : public CacheView {
+public:
+    void *_address;
+    size_t _size;
+
+    MappedCacheView(void *address, size_t size)
+            : _address(address), _size(size) {}
+
+    ~MappedCacheView() override { munmap(_address, _size); }
+
+    const char *data() const override {
+        return static_cast<const char *>(_address);
+    }
+
+    size_t size() const override { return _size; }
+};
+#endif
+
+DirectoryCache::DirectoryCache(const std::string &path) : _path(path) {
+    if (!_path.empty() && _path.back() != '/') {
+        _path += '/';
+    }
+    createDirectories(_path);
+}
+
+bool DirectoryCache::has(const std::string &key) const {
+    std::ifstream file(getFilename(key));
+    return file.good();
+}
+
+void DirectoryCache::save(const std::string &key, const char *data,
+                          size_t size) {
+    // Write to a temporary file then rename it, so that readers never see a
+    // partially written entry.
+    std::stringstream tmpName;
+    tmpName << getFilename(key) << "." << std::this_thread::get_id() << ".tmp";
+    {
+        std::ofstream file(tmpName.str(), std::ios::binary);
+        file.write(data, size);
+
+        if (!file) {
+            throw std::runtime_error("Could not write cache entry " + key);
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(getFilename(key).c_str());
+#endif
+    if (std::rename(tmpName.str().c_str(), getFilename(key).c_str()) != 0) {
+        std::remove(tmpName.str().c_str());
+        throw std::runtime_error("Could not write cache entry " + key);
+    }
+}
+
+std::unique_ptr<CacheView> DirectoryCache::load(const std::string &key) const {
+#ifdef _WIN32
+    std::ifstream file(getFilename(key), std::ios::binary | std::ios::ate);
+
+    if (!file)
+        return nullptr;
+
+    auto view = std::make_unique<FileCacheView>();
+    view->_data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(view->_data.data(), view->_data.size());
+    return std::move(view);
+#else
+    int fd = open(getFilename(key).c_str(), O_RDONLY);
+
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    void *address = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        address = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+
+    if (address == MAP_FAILED)
+        return nullptr;
+
+    return std::make_unique<MappedCacheView>(address,
+                                             static_cast<size_t>(st.st_size));
+#endif
+}
+
+void DirectoryCache::remove(const std::string &key) {
+    std::remove(getFilename(key).c_str());
+}
+
+std::string DirectoryCache::getFilename(const std::string &key) const {
+    return _path + key + ".bin";
+}
+
+} // namespace world
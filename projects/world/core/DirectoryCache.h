@@ -0,0 +1,38 @@
+#ifndef WORLD_DIRECTORY_CACHE_H
+#define WORLD_DIRECTORY_CACHE_H
+
+#include "world/core/WorldConfig.h"
+
+#include "ICache.h"
+
+namespace world {
+
+/** Cache that stores each entry in a separate file of a local directory.
+ * Entries are memory mapped when loaded, so only the parts that are
+ * actually read are fetched from the disk. Several processes can share the
+ * same directory. */
+class WORLDAPI_EXPORT DirectoryCache : public ICache {
+public:
+    /** Creates the cache. The directory is created if it does not exist. */
+    explicit DirectoryCache(const std::string &path);
+
+    const std::string &getPath() const { return _path; }
+
+    bool has(const std::string &key) const override;
+
+    void save(const std::string &key, const char *data, size_t size) override;
+
+    std::unique_ptr<CacheView> load(const std::string &key) const override;
+
+    void remove(const std::string &key) override;
+
+private:
+    std::string _path;
+
+
+    std::string getFilename(const std::string &key) const;
+};
+
+} // namespace world
+
+#endif // WORLD_DIRECTORY_CACHE_H
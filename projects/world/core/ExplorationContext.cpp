@@ -21,6 +21,8 @@ void ExplorationContext::setEnvironment(IEnvironment *environment) {
     _environment = environment;
 }
 
+void ExplorationContext::setAsync(bool async) { _async = async; }
+
 ItemKey ExplorationContext::mutateKey(const ItemKey &key) const {
     return {_keyPrefix, key};
 }
@@ -24,6 +24,13 @@ public:
 
     void setEnvironment(IEnvironment *environment);
 
+    /** If the context is asynchronous, nodes should only collect what is
+     * already generated and schedule the generation of the missing parts in
+     * background, instead of generating everything before returning. */
+    void setAsync(bool async);
+
+    bool isAsync() const { return _async; }
+
     ItemKey mutateKey(const ItemKey &key) const;
 
     /// Handy alias for #mutateKey
@@ -47,6 +54,7 @@ private:
     vec3d _offset;
 
     IEnvironment *_environment;
+    bool _async = false;
 };
 
 } // namespace world
@@ -2,10 +2,16 @@
 
 #include <string>
 #include <map>
+#include <mutex>
+#include <typeinfo>
 #include <vector>
 
 #include "TileSystem.h"
 #include "GridStorage.h"
+#include "TileGenerationQueue.h"
+#include "Tracer.h"
+#include "MemoryRegistry.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -16,16 +22,29 @@ public:
 
     TileCoordinates _coords;
     Chunk _chunk;
+
+    size_t getMemoryUsage() const override {
+        return sizeof(ChunkEntry) + _chunk.getMemoryUsage();
+    }
 };
 
 class GridChunkSystemPrivate {
 public:
     std::vector<std::unique_ptr<IChunkDecorator>> _chunkDecorators;
+    u64 _seed = DEFAULT_SEED;
+    /// Id of the counter of the chunk system in the MemoryRegistry
+    u64 _memoryId = 0;
 
     TileSystem _tileSystem;
     GridStorageReducer _reducer;
     GridStorage<ChunkEntry> _storage;
 
+    /** Held by any thread that accesses the chunks. */
+    std::recursive_mutex _mutex;
+    /** Declared last so that the generation thread is stopped before the
+     * other members are destroyed. */
+    std::unique_ptr<TileGenerationQueue> _queue;
+
     GridChunkSystemPrivate()
             : _tileSystem(0, {}, {}), _reducer(_tileSystem, 30000) {
         _storage.setReducer(&_reducer);
@@ -37,6 +56,7 @@ ChunkEntry::ChunkEntry(const TileCoordinates &tc, const TileSystem &ts,
         : _coords(tc),
           _chunk(ts.getTileSize(tc._lod), ts.getMinResolution(tc._lod),
                  ts.getMaxResolution(tc._lod)) {
+    WORLD_TRACE_ZONE("GridChunkSystem::decorate");
 
     _chunk.setPosition3D(chunkSystem.getOffset(tc));
 
@@ -65,11 +85,34 @@ GridChunkSystem::GridChunkSystem(double baseChunkSize, int maxLod,
     }
 
     ts._bufferRes = {static_cast<int>(bufferRes)};
+
+    _internal->_queue =
+        std::make_unique<TileGenerationQueue>([this](const TileCoordinates &tc) {
+            std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+            getOrCreateEntry(tc);
+        });
+
+    _internal->_memoryId = MemoryRegistry::getDefault().add(
+        "GridChunkSystem", [this]() { return getMemoryUsage(); });
+}
+
+GridChunkSystem::~GridChunkSystem() {
+    MemoryRegistry::getDefault().remove(_internal->_memoryId);
+    delete _internal;
 }
 
-GridChunkSystem::~GridChunkSystem() { delete _internal; }
+void GridChunkSystem::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    _internal->_reducer.setMemoryBudget(bytes);
+}
+
+size_t GridChunkSystem::getMemoryUsage() const {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    return _internal->_storage.getMemoryUsage();
+}
 
 Chunk &GridChunkSystem::getChunk(const vec3d &position, double resolution) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
     TileSystem &ts = tileSystem();
     TileCoordinates tc = ts.getTileCoordinates(position, ts.getLod(resolution));
     auto &entry = getOrCreateEntry(tc);
@@ -79,12 +122,22 @@ Chunk &GridChunkSystem::getChunk(const vec3d &position, double resolution) {
 void GridChunkSystem::collect(ICollector &collector,
                               const IResolutionModel &resolutionModel,
                               const ExplorationContext &ctx) {
+    WORLD_TRACE_ZONE("GridChunkSystem::collect");
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+
+    if (ctx.isAsync()) {
+        // Requests from the previous point of view are not relevant anymore
+        _internal->_queue->clear();
+    }
+
     // Run collect on every decorator if needed
     int decoratorID = 0;
     for (auto &decorator : _internal->_chunkDecorators) {
         WorldNode *node = dynamic_cast<WorldNode *>(decorator.get());
 
         if (node != nullptr) {
+            WORLD_TRACE_ZONE("GridChunkSystem::collectDecorator",
+                             typeid(*node).name());
             ExplorationContext childCtx = ctx;
             childCtx.appendPrefix({"deco" + std::to_string(decoratorID)});
             node->collect(collector, resolutionModel, childCtx);
@@ -103,17 +156,34 @@ void GridChunkSystem::collect(ICollector &collector,
         collectChunk(tc, collector, resolutionModel, ctx);
     }
 
-    std::cout << "ChunkSystem before reducing: " << _internal->_storage.size();
+    WORLD_TRACE_ZONE("GridChunkSystem::reduceStorage");
     _internal->_reducer.reduceStorage();
-    std::cout << ", ChunkSystem after reducing: " << _internal->_storage.size()
-              << std::endl;
 }
 
+size_t GridChunkSystem::getAsyncGenerationCount() const {
+    return _internal->_queue->completedCount();
+}
+
+void GridChunkSystem::waitForGeneration() { _internal->_queue->waitIdle(); }
+
 void GridChunkSystem::collectChunk(const TileCoordinates &chunkKey,
                                    ICollector &collector,
                                    const IResolutionModel &resolutionModel,
                                    const ExplorationContext &ctx) {
 
+    if (ctx.isAsync()) {
+        ChunkEntry *entry;
+
+        if (!_internal->_storage.tryGet(chunkKey, &entry)) {
+            TileSystem &ts = tileSystem();
+            vec3d offset = ts.getTileOffset(chunkKey);
+            BoundingBox bbox(offset, offset + ts.getTileSize(chunkKey._lod));
+            _internal->_queue->request(
+                chunkKey, resolutionModel.getMaxResolutionIn(bbox, ctx));
+            return;
+        }
+    }
+
     Chunk &chunk = getOrCreateEntry(chunkKey)._chunk;
     collectChild(chunkKey.toKey(), chunk, collector, resolutionModel, ctx);
 }
@@ -126,7 +196,25 @@ ChunkEntry &GridChunkSystem::getOrCreateEntry(const TileCoordinates &tc) {
     return _internal->_storage.getOrCreate(tc, tc, tileSystem(), *this);
 }
 
+void GridChunkSystem::setSeed(u64 seed) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    _internal->_seed = seed;
+    u64 index = 0;
+
+    for (auto &decorator : _internal->_chunkDecorators) {
+        decorator->setSeed(deriveSeed(seed, index));
+        ++index;
+    }
+
+    // Chunks decorated with the previous seed are generated again
+    _internal->_reducer.removeAll();
+}
+
+u64 GridChunkSystem::getSeed() const { return _internal->_seed; }
+
 void GridChunkSystem::addDecoratorInternal(IChunkDecorator *decorator) {
+    decorator->setSeed(deriveSeed(
+        _internal->_seed, u64(_internal->_chunkDecorators.size())));
     _internal->_chunkDecorators.emplace_back(decorator);
 }
 
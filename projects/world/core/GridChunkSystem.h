@@ -34,12 +34,36 @@ public:
 
     Chunk &getChunk(const vec3d &position, double resolution) override;
 
+    /** Collects the chunks. If the context is asynchronous, the chunks that
+     * do not exist yet are created in background and are skipped until
+     * then. */
     void collect(ICollector &collector, const IResolutionModel &resolutionModel,
                  const ExplorationContext &ctx =
                      ExplorationContext::getDefault()) override;
 
+    /** Blocks until all the chunks scheduled by asynchronous collects are
+     * created. */
+    void waitForGeneration();
+
     template <typename T, typename... Args> T &addDecorator(Args &... args);
 
+    /** Set the maximum number of bytes used by the chunks and their content.
+     * When the budget is exceeded, the least recently used chunks are
+     * deleted. 0 means no limit. */
+    void setMemoryBudget(size_t bytes);
+
+    /** Get the number of bytes currently used by the chunks. */
+    size_t getMemoryUsage() const override;
+
+    size_t getAsyncGenerationCount() const override;
+
+    /** Set the seed of the chunk system. Each decorator receives a seed
+     * derived from this one and from its position in the list of
+     * decorators, including the decorators added later. */
+    void setSeed(u64 seed);
+
+    u64 getSeed() const;
+
 protected:
     /** Test if the given chunk should be collected. If it is the case,
      * then the chunk is collected and collectChunk is called on each
@@ -2,6 +2,30 @@
 
 namespace world {
 
+GridStorageBase::GridStorageBase(GridStorageBase &&other) noexcept
+        : _reducer(other._reducer) {
+    if (_reducer != nullptr) {
+        _reducer->unregisterStorage(&other);
+        _reducer->registerStorage(this);
+        other._reducer = nullptr;
+    }
+}
+
+GridStorageBase &GridStorageBase::operator=(GridStorageBase &&other) noexcept {
+    if (this == &other || other._reducer == nullptr) {
+        return *this;
+    }
+
+    other._reducer->unregisterStorage(&other);
+
+    if (_reducer == nullptr) {
+        _reducer = other._reducer;
+        _reducer->registerStorage(this);
+    }
+    other._reducer = nullptr;
+    return *this;
+}
+
 void GridStorageBase::setReducer(GridStorageReducer *reducer) {
     _reducer = reducer;
     _reducer->registerStorage(this);
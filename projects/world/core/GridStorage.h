@@ -9,17 +9,41 @@
 #include "world/core/TileSystem.h"
 #include "world/terrain/Terrain.h"
 #include "GridStorageReducer.h"
+#include "GridStoragePolicies.h"
 
 namespace world {
 
 class WORLDAPI_EXPORT GridStorageBase {
 public:
+    GridStorageBase() = default;
+
+    /** The reducer of the other storage is transferred to the new one. */
+    GridStorageBase(GridStorageBase &&other) noexcept;
+
+    GridStorageBase(const GridStorageBase &other) = delete;
+
     virtual ~GridStorageBase() = default;
 
+    /** The storage keeps its reducer, if it has one. Otherwise it takes the
+     * reducer of the other storage. In both cases, the other storage is
+     * not registered in its reducer anymore. */
+    GridStorageBase &operator=(GridStorageBase &&other) noexcept;
+
+    GridStorageBase &operator=(const GridStorageBase &other) = delete;
+
     virtual bool has(const TileCoordinates &coords) const = 0;
 
     virtual void remove(const TileCoordinates &coords) = 0;
 
+    /** Get the number of bytes used by the element at the given coordinates,
+     * or 0 if there is no element. */
+    virtual size_t getMemoryUsage(const TileCoordinates &coords) const {
+        return 0;
+    }
+
+    /** Get the number of bytes used by all the elements of the storage. */
+    virtual size_t getMemoryUsage() const { return 0; }
+
     virtual void setReducer(GridStorageReducer *reducer);
 
 protected:
@@ -30,6 +54,10 @@ class WORLDAPI_EXPORT IGridElement {
 public:
     virtual ~IGridElement() = default;
 
+    /** Get an estimation of the number of bytes held by this element. It is
+     * used by GridStorageReducer to enforce memory budgets. */
+    virtual size_t getMemoryUsage() const { return 0; }
+
     // Add save(...) and load(...) when serialization will be implemented
 };
 
@@ -42,12 +70,19 @@ public:
     TerrainElement(Terrain terrain) : _terrain(std::move(terrain)) {}
 
     TerrainElement(Terrain &&terrain) : _terrain(terrain) {}
+
+    size_t getMemoryUsage() const override {
+        return _terrain.getMemoryUsage();
+    }
 };
 
-template <
-    typename TElement,
-    std::enable_if_t<std::is_base_of<IGridElement, TElement>::value, int> = 0>
+/** Stores one element per tile. The way elements are stored is chosen with
+ * the TPolicy template parameter, see GridStoragePolicies.h. */
+template <typename TElement, typename TPolicy = HashStoragePolicy>
 class GridStorage : public GridStorageBase {
+    static_assert(std::is_base_of<IGridElement, TElement>::value,
+                  "GridStorage elements must inherit IGridElement");
+
 public:
     GridStorage() = default;
     ~GridStorage() override = default;
@@ -62,18 +97,14 @@ public:
     TElement &set(const TileCoordinates &coords, Args &&... args) {
         if (_reducer != nullptr)
             _reducer->registerAccess(coords);
-        return *(_storage[coords] = std::make_unique<TElement>(args...));
+        return *_storage.replace(coords, args...);
     }
 
     template <typename... Args>
     TElement &getOrCreate(const TileCoordinates &coords, Args &&... args) {
         if (_reducer != nullptr)
             _reducer->registerAccess(coords);
-        auto it = _storage.insert({coords, nullptr});
-        if (it.second) {
-            it.first->second = std::make_unique<TElement>(args...);
-        }
-        return *it.first->second;
+        return *_storage.emplace(coords, args...).first;
     }
 
     template <typename... Args>
@@ -82,20 +113,19 @@ public:
                                   Args &&... args) {
         if (_reducer != nullptr)
             _reducer->registerAccess(coords);
-        auto it = _storage.insert({coords, nullptr});
+        auto it = _storage.emplace(coords, args...);
         if (it.second) {
-            it.first->second = std::make_unique<TElement>(args...);
-            callback(*it.first->second);
+            callback(*it.first);
         }
-        return *it.first->second;
+        return *it.first;
     }
 
     bool tryGet(const TileCoordinates &coords, TElement **elemPtr) const {
-        auto it = _storage.find(coords);
-        if (it != _storage.end()) {
+        TElement *elem = _storage.find(coords);
+        if (elem != nullptr) {
             if (_reducer != nullptr)
                 _reducer->registerAccess(coords);
-            *elemPtr = it->second.get();
+            *elemPtr = elem;
             return true;
         } else {
             return false;
@@ -123,17 +153,33 @@ public:
     }
 
     bool has(const TileCoordinates &coords) const override {
-        return _storage.find(coords) != _storage.end();
+        return _storage.find(coords) != nullptr;
     }
 
     void remove(const TileCoordinates &coords) override {
         _storage.erase(coords);
     }
 
+    size_t getMemoryUsage(const TileCoordinates &coords) const override {
+        TElement *elem = _storage.find(coords);
+        return elem != nullptr ? elem->getMemoryUsage() : 0;
+    }
+
+    size_t getMemoryUsage() const override {
+        size_t bytes = 0;
+        _storage.forEach(
+            [&](const TElement &elem) { bytes += elem.getMemoryUsage(); });
+        return bytes;
+    }
+
     size_t size() const { return _storage.size(); }
 
+    /** Calls f on each element of the storage. Unlike the other accessors,
+     * this does not register any access in the reducer. */
+    template <typename F> void forEach(F f) const { _storage.forEach(f); }
+
 private:
-    std::map<TileCoordinates, std::unique_ptr<TElement>> _storage;
+    typename TPolicy::template container<TElement> _storage;
 };
 
 typedef GridStorage<TerrainElement> TerrainGrid;
@@ -0,0 +1,248 @@
+#ifndef WORLD_GRID_STORAGE_POLICIES_H
+#define WORLD_GRID_STORAGE_POLICIES_H
+
+#include "world/core/WorldConfig.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "TileSystem.h"
+#include "ObjectPool.h"
+
+namespace world {
+
+/** Storage policy for GridStorage: elements are stored in an ordered map
+ * and allocated one by one. */
+struct MapStoragePolicy {
+    template <typename TElement> class container {
+    public:
+        TElement *find(const TileCoordinates &coords) const {
+            auto it = _map.find(coords);
+            return it != _map.end() ? it->second.get() : nullptr;
+        }
+
+        /** Creates an element if there is none at the given coordinates.
+         * Returns the element and true if it was created. */
+        template <typename... Args>
+        std::pair<TElement *, bool> emplace(const TileCoordinates &coords,
+                                            Args &&... args) {
+            auto it = _map.insert({coords, nullptr});
+
+            if (it.second) {
+                try {
+                    it.first->second =
+                        std::make_unique<TElement>(std::forward<Args>(args)...);
+                } catch (...) {
+                    _map.erase(it.first);
+                    throw;
+                }
+            }
+            return {it.first->second.get(), it.second};
+        }
+
+        /** Creates an element, replacing the previous one if any. */
+        template <typename... Args>
+        TElement *replace(const TileCoordinates &coords, Args &&... args) {
+            return (_map[coords] =
+                        std::make_unique<TElement>(std::forward<Args>(args)...))
+                .get();
+        }
+
+        bool erase(const TileCoordinates &coords) {
+            return _map.erase(coords) != 0;
+        }
+
+        size_t size() const { return _map.size(); }
+
+        /** Calls f on every element. */
+        template <typename F> void forEach(F f) const {
+            for (auto &entry : _map) {
+                f(*entry.second);
+            }
+        }
+
+    private:
+        std::map<TileCoordinates, std::unique_ptr<TElement>> _map;
+    };
+};
+
+/** Storage policy for GridStorage: elements are found in an open addressing
+ * hash table with linear probing, and are allocated in slabs. Lookups and
+ * insertions are O(1) and do not allocate memory, except when the table or
+ * the pool grow. */
+struct HashStoragePolicy {
+    template <typename TElement> class container {
+    public:
+        container() = default;
+
+        container(const container &other) = delete;
+
+        container(container &&other) noexcept
+                : _buckets(std::move(other._buckets)), _size(other._size),
+                  _pool(std::move(other._pool)) {
+            other._size = 0;
+        }
+
+        ~container() { clear(); }
+
+        container &operator=(const container &other) = delete;
+
+        container &operator=(container &&other) noexcept {
+            clear();
+            _buckets = std::move(other._buckets);
+            _size = other._size;
+            _pool = std::move(other._pool);
+            other._size = 0;
+            return *this;
+        }
+
+        TElement *find(const TileCoordinates &coords) const {
+            if (_buckets.empty())
+                return nullptr;
+
+            const Bucket &bucket = _buckets[probe(coords, hash(coords))];
+            return bucket._element;
+        }
+
+        template <typename... Args>
+        std::pair<TElement *, bool> emplace(const TileCoordinates &coords,
+                                            Args &&... args) {
+            TElement *found = find(coords);
+
+            if (found != nullptr)
+                return {found, false};
+
+            return {insert(coords, std::forward<Args>(args)...), true};
+        }
+
+        template <typename... Args>
+        TElement *replace(const TileCoordinates &coords, Args &&... args) {
+            return insert(coords, std::forward<Args>(args)...);
+        }
+
+        bool erase(const TileCoordinates &coords) {
+            if (_buckets.empty())
+                return false;
+
+            size_t i = probe(coords, hash(coords));
+
+            if (_buckets[i]._element == nullptr)
+                return false;
+
+            _pool.destroy(_buckets[i]._element);
+            _buckets[i]._element = nullptr;
+            --_size;
+
+            // Backward shift deletion: move back the following elements of
+            // the cluster so that probing never stops on the hole.
+            const size_t mask = _buckets.size() - 1;
+
+            for (size_t j = (i + 1) & mask; _buckets[j]._element != nullptr;
+                 j = (j + 1) & mask) {
+                size_t home = _buckets[j]._hash & mask;
+
+                // Distance to the home bucket of the element at j is greater
+                // than the distance to the hole: the element can move there.
+                if (((j - home) & mask) >= ((j - i) & mask)) {
+                    _buckets[i] = _buckets[j];
+                    _buckets[j]._element = nullptr;
+                    i = j;
+                }
+            }
+            return true;
+        }
+
+        size_t size() const { return _size; }
+
+        /** Calls f on every element. */
+        template <typename F> void forEach(F f) const {
+            for (const Bucket &bucket : _buckets) {
+                if (bucket._element != nullptr) {
+                    f(*bucket._element);
+                }
+            }
+        }
+
+        void clear() {
+            for (Bucket &bucket : _buckets) {
+                if (bucket._element != nullptr) {
+                    _pool.destroy(bucket._element);
+                    bucket._element = nullptr;
+                }
+            }
+            _size = 0;
+        }
+
+    private:
+        struct Bucket {
+            TileCoordinates _coords;
+            size_t _hash = 0;
+            /// nullptr if the bucket is empty.
+            TElement *_element = nullptr;
+        };
+
+        std::vector<Bucket> _buckets;
+        size_t _size = 0;
+        ObjectPool<TElement> _pool;
+
+
+        static size_t hash(const TileCoordinates &coords) {
+            return std::hash<TileCoordinates>()(coords);
+        }
+
+        /** Returns the bucket containing the coordinates, or the empty bucket
+         * where they should be inserted. */
+        size_t probe(const TileCoordinates &coords, size_t h) const {
+            const size_t mask = _buckets.size() - 1;
+            size_t i = h & mask;
+
+            while (_buckets[i]._element != nullptr &&
+                   !(_buckets[i]._hash == h && _buckets[i]._coords == coords)) {
+                i = (i + 1) & mask;
+            }
+            return i;
+        }
+
+        template <typename... Args>
+        TElement *insert(const TileCoordinates &coords, Args &&... args) {
+            // The element is built before being inserted, because its
+            // constructor may insert other elements in the same storage.
+            TElement *element = _pool.create(std::forward<Args>(args)...);
+
+            // Maximum load factor is 0.75
+            if ((_size + 1) * 4 > _buckets.size() * 3) {
+                rehash(_buckets.empty() ? 16 : _buckets.size() * 2);
+            }
+
+            size_t h = hash(coords);
+            Bucket &bucket = _buckets[probe(coords, h)];
+
+            if (bucket._element != nullptr) {
+                _pool.destroy(bucket._element);
+            } else {
+                bucket._coords = coords;
+                bucket._hash = h;
+                ++_size;
+            }
+            bucket._element = element;
+            return element;
+        }
+
+        void rehash(size_t bucketCount) {
+            std::vector<Bucket> old(bucketCount);
+            std::swap(old, _buckets);
+
+            for (Bucket &bucket : old) {
+                if (bucket._element != nullptr) {
+                    _buckets[probe(bucket._coords, bucket._hash)] = bucket;
+                }
+            }
+        }
+    };
+};
+
+} // namespace world
+
+#endif // WORLD_GRID_STORAGE_POLICIES_H
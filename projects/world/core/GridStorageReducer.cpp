@@ -1,11 +1,18 @@
 #include "GridStorageReducer.h"
 
-#include <set>
+#include <algorithm>
 
 #include "GridStorage.h"
 
 namespace world {
 
+GridStorageReducer::GridStorageReducer(TileSystem &tileSystem,
+                                       u32 maxInstances, size_t memoryBudget)
+        : _tileSystem(tileSystem), _maxInstances(maxInstances),
+          _memoryBudget(memoryBudget) {
+    _lru._prev = _lru._next = &_lru;
+}
+
 void GridStorageReducer::registerStorage(GridStorageBase *storage) {
     if (std::find(_storages.begin(), _storages.end(), storage) ==
         _storages.end()) {
@@ -13,73 +20,97 @@ void GridStorageReducer::registerStorage(GridStorageBase *storage) {
     }
 }
 
-void GridStorageReducer::registerAccess(const TileCoordinates &tc) {
-    _accessTracker[tc] = _accessCounter;
-    ++_accessCounter;
+void GridStorageReducer::unregisterStorage(GridStorageBase *storage) {
+    _storages.remove(storage);
 }
 
-void GridStorageReducer::reduceStorage() {
-    size_t currentSize = _accessTracker.size();
+void GridStorageReducer::registerAccess(const TileCoordinates &tc) {
+    Node *node = _nodes.emplace(tc, tc).first;
+    moveToBack(node);
 
-    if (currentSize < _maxInstances) {
-        return;
+    if (!node->_dirty) {
+        node->_dirty = true;
+        _dirty.push_back(node);
     }
 
-    typedef std::pair<u64, TileCoordinates> Access;
+    // Ancestors must stay more recent than their descendants
+    TileCoordinates parent = tc;
 
-    // Add all access to accesses
-    std::set<TileCoordinates> processedChildren;
+    while (parent._lod > 0) {
+        parent = _tileSystem.getParentTileCoordinates(parent);
+        Node *parentNode = _nodes.find(parent);
 
-    for (const auto &e : _accessTracker) {
-        processedChildren.insert(e.first);
+        if (parentNode != nullptr) {
+            moveToBack(parentNode);
+        }
     }
+}
 
-    while (!processedChildren.empty()) {
-        std::set<TileCoordinates> next;
-
-        for (const auto &tc : processedChildren) {
-            const TileCoordinates &parent =
-                _tileSystem.getParentTileCoordinates(tc);
-
-            if (parent._lod >= 0) {
-                u64 childAccess = _accessTracker[tc];
-                u64 parentAccess = _accessTracker[parent];
+void GridStorageReducer::reduceStorage() {
+    // Measure the tiles that may have changed since the last call
+    for (Node *node : _dirty) {
+        size_t bytes = 0;
 
-                if (parentAccess < childAccess) {
-                    _accessTracker[parent] = childAccess;
-                    next.insert(parent);
-                }
-            }
+        for (auto storage : _storages) {
+            bytes += storage->getMemoryUsage(node->_coords);
         }
-        processedChildren = next;
+
+        _memoryUsage = _memoryUsage - node->_bytes + bytes;
+        node->_bytes = bytes;
+        node->_dirty = false;
     }
+    _dirty.clear();
 
-    // Sort all accesses by ascending access counter. If tie, child (== highest
-    // lod) goes first (it will be the first to be deleted)
-    std::vector<Access> accesses;
+    // The least recently used tile has no descendant in the list, so it can
+    // always be removed.
+    while (_lru._next != &_lru &&
+           (_nodes.size() > _maxInstances ||
+            (_memoryBudget != 0 && _memoryUsage > _memoryBudget))) {
 
-    for (const auto &e : _accessTracker) {
-        accesses.emplace_back(e.second, e.first);
-    }
+        Node *node = _lru._next;
+        TileCoordinates coords = node->_coords;
+
+        for (auto storage : _storages) {
+            storage->remove(coords);
+        }
 
-    std::sort(accesses.begin(), accesses.end(),
-              [](const Access &lhs, const Access &rhs) {
-                  return lhs.first != rhs.first
-                             ? lhs.first < rhs.first
-                             : lhs.second._lod > rhs.second._lod;
-              });
+        _memoryUsage -= node->_bytes;
+        unlink(node);
+        _nodes.erase(coords);
+        ++_removedCount;
+    }
+}
 
-    // Remove old accesses
-    u64 removeCount = currentSize - _maxInstances;
+void GridStorageReducer::removeAll() {
+    while (_lru._next != &_lru) {
+        Node *node = _lru._next;
+        TileCoordinates coords = node->_coords;
 
-    for (auto storage : _storages) {
-        for (u64 i = 0; i < removeCount; ++i) {
-            storage->remove(accesses[i].second);
+        for (auto storage : _storages) {
+            storage->remove(coords);
         }
+
+        unlink(node);
+        _nodes.erase(coords);
     }
+    _dirty.clear();
+    _memoryUsage = 0;
+}
 
-    for (u64 i = 0; i < removeCount; ++i) {
-        _accessTracker.erase(accesses[i].second);
+void GridStorageReducer::moveToBack(Node *node) {
+    if (node->_prev != nullptr) {
+        unlink(node);
     }
+
+    node->_prev = _lru._prev;
+    node->_next = &_lru;
+    _lru._prev->_next = node;
+    _lru._prev = node;
+}
+
+void GridStorageReducer::unlink(Node *node) {
+    node->_prev->_next = node->_next;
+    node->_next->_prev = node->_prev;
+    node->_prev = node->_next = nullptr;
 }
 } // namespace world
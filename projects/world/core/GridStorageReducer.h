@@ -3,34 +3,101 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <list>
+#include <vector>
+
 #include "TileSystem.h"
+#include "GridStoragePolicies.h"
 
 namespace world {
 
 class GridStorageBase;
 
+/** Removes the least recently used tiles from a set of storages, so that
+ * the number of tiles and the memory they use stay within a budget.
+ *
+ * Tiles are kept in a least recently used list. When a tile is accessed, it
+ * goes to the end of the list, followed by its ancestors. This way a tile
+ * is always evicted before its parent, so that the parent can be used to
+ * regenerate it. Accesses cost O(lod) and evictions cost O(1). */
 class WORLDAPI_EXPORT GridStorageReducer {
 public:
-    GridStorageReducer(TileSystem &tileSystem, u32 maxInstances = 2000)
-            : _tileSystem(tileSystem), _maxInstances(maxInstances) {}
+    /** @param maxInstances Maximum number of tiles kept in the storages.
+     * @param memoryBudget Maximum number of bytes used by the elements of the
+     * storages. 0 means no limit. */
+    GridStorageReducer(TileSystem &tileSystem, u32 maxInstances = 2000,
+                       size_t memoryBudget = 0);
+
+    GridStorageReducer(const GridStorageReducer &other) = delete;
+
+    GridStorageReducer &operator=(const GridStorageReducer &other) = delete;
+
+    void setMaxInstances(u32 maxInstances) { _maxInstances = maxInstances; }
+
+    void setMemoryBudget(size_t memoryBudget) { _memoryBudget = memoryBudget; }
+
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Number of tiles tracked by this reducer. */
+    size_t getInstanceCount() const { return _nodes.size(); }
+
+    /** Memory used by the tiles, as measured during the last call to
+     * reduceStorage(). */
+    size_t getMemoryUsage() const { return _memoryUsage; }
+
+    /** Number of tiles deleted by this reducer since its creation. */
+    size_t getRemovedCount() const { return _removedCount; }
 
     void registerStorage(GridStorageBase *storage);
 
+    void unregisterStorage(GridStorageBase *storage);
+
     void registerAccess(const TileCoordinates &tc);
 
-    /** Reduce storage by deleting tiles that have not beed accessed for a very
-     * long time. */
+    /** Reduce storage by deleting the tiles that have not been accessed for
+     * the longest time, until the instance count and the memory usage are
+     * within the limits. */
     void reduceStorage();
 
+    /** Delete all the tiles from the storages, for example when the
+     * generated content is not valid anymore. The removed tiles are not
+     * counted in #getRemovedCount. */
+    void removeAll();
+
 private:
+    struct Node {
+        TileCoordinates _coords;
+        Node *_prev = nullptr;
+        Node *_next = nullptr;
+        /// Memory used by the tile in all the storages.
+        size_t _bytes = 0;
+        /// True if the tile was accessed since its memory was measured.
+        bool _dirty = false;
+
+        Node() = default;
+
+        Node(const TileCoordinates &coords) : _coords(coords) {}
+    };
+
     TileSystem &_tileSystem;
 
     u32 _maxInstances;
+    size_t _memoryBudget;
+    size_t _memoryUsage = 0;
+    size_t _removedCount = 0;
 
-    u64 _accessCounter = 0;
-    std::map<TileCoordinates, u64> _accessTracker;
+    HashStoragePolicy::container<Node> _nodes;
+    /// Sentinel of the circular list, _lru._next is the least recently used
+    /// tile.
+    Node _lru;
+    std::vector<Node *> _dirty;
 
     std::list<GridStorageBase *> _storages;
+
+
+    void moveToBack(Node *node);
+
+    void unlink(Node *node);
 };
 
 } // namespace world
@@ -0,0 +1,45 @@
+#ifndef WORLD_ICACHE_H
+#define WORLD_ICACHE_H
+
+#include "world/core/WorldConfig.h"
+
+#include <memory>
+#include <string>
+
+namespace world {
+
+/** Read-only access to a block of data loaded from a cache. The data stay
+ * valid as long as this object exists. */
+class WORLDAPI_EXPORT CacheView {
+public:
+    virtual ~CacheView() = default;
+
+    virtual const char *data() const = 0;
+
+    virtual size_t size() const = 0;
+};
+
+/** A place where generated data can be saved, to be reloaded later
+ * instead of being generated again, possibly by another process. Keys
+ * are made of letters, digits, '_' and '-' only. */
+class WORLDAPI_EXPORT ICache {
+public:
+    virtual ~ICache() = default;
+
+    virtual bool has(const std::string &key) const = 0;
+
+    /** Saves the data under the given key. If data already exist for this
+     * key, they are replaced. */
+    virtual void save(const std::string &key, const char *data,
+                      size_t size) = 0;
+
+    /** Loads the data saved under the given key. Returns nullptr if there
+     * is no such data. */
+    virtual std::unique_ptr<CacheView> load(const std::string &key) const = 0;
+
+    virtual void remove(const std::string &key) = 0;
+};
+
+} // namespace world
+
+#endif // WORLD_ICACHE_H
@@ -2,6 +2,8 @@
 
 #include "world/core/WorldConfig.h"
 
+#include "world/core/WorldTypes.h"
+
 namespace world {
 
 class World;
@@ -13,5 +15,10 @@ public:
     virtual ~IChunkDecorator() = default;
 
     virtual void decorate(Chunk &chunk) = 0;
+
+    /** Set the seed of the random values used to decorate the chunks. A
+     * chunk must always be decorated the same way, whatever the order in
+     * which the chunks are created. */
+    virtual void setSeed(u64 seed) {}
 };
 } // namespace world
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <memory>
 #include <tuple>
 
 #include "WorldKeys.h"
@@ -47,6 +48,16 @@ public:
     virtual ~ICollectorChannelBase() = default;
 
     virtual void reset() {}
+
+    /** Enables or disables the delta mode of the channel. See
+     * Collector::setDeltaMode. */
+    virtual void setDeltaMode(bool deltaMode) {}
+
+    /** Called at the end of a collect. See Collector::endCollect. */
+    virtual void endCollect() {}
+
+    /** Get an estimate of the number of bytes held by the channel. */
+    virtual size_t getMemoryUsage() const { return 0; }
 };
 
 
@@ -68,6 +79,16 @@ public:
         const ItemKey &key, const T &item,
         const ExplorationContext &ctx = ExplorationContext::getDefault()) = 0;
 
+    /** Provides an item that can be shared between the library and any
+     * number of channels instead of being copied. The item must not be
+     * modified once it has been put. The default implementation stores a
+     * copy of the item using #put. */
+    virtual void putShared(
+        const ItemKey &key, std::shared_ptr<const T> item,
+        const ExplorationContext &ctx = ExplorationContext::getDefault()) {
+        put(key, *item, ctx);
+    }
+
     /** Returns true when the channel already has an item
      * associated to the given key.
      * @param key same key as in #put method.
@@ -76,6 +97,16 @@ public:
                      const ExplorationContext &ctx =
                          ExplorationContext::getDefault()) const = 0;
 
+    /** Keeps the item already associated to the given key as if it was put
+     * again, so that the generator does not need to provide it. Returns
+     * false if the channel has no item at this key, in which case the item
+     * must be put. The default implementation is the same as #has. */
+    virtual bool keep(
+        const ItemKey &key,
+        const ExplorationContext &ctx = ExplorationContext::getDefault()) {
+        return has(key, ctx);
+    }
+
     /** Notices the channel that the item at the given key does
      * not belong to the collected assets anymore and should be
      * removed.
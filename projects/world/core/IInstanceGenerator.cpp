@@ -22,6 +22,15 @@ void Template::insert(const Item &item) {
     _items.insert(it, item);
 }
 
+size_t Template::getMemoryUsage() const {
+    size_t bytes = _items.capacity() * sizeof(Item);
+
+    for (const Item &item : _items) {
+        bytes += item._nodes.capacity() * sizeof(SceneNode);
+    }
+    return bytes;
+}
+
 void Template::insert(double resolution, const SceneNode &node) {
     insert(Item{{node}, resolution});
 }
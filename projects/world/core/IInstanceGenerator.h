@@ -50,6 +50,9 @@ public:
      * SceneNode. */
     SceneNode getDefaultNode();
 
+    /** Get the number of bytes used by the items of the template. */
+    size_t getMemoryUsage() const;
+
 private:
     /// Scene nodes that will be collected, at different resolution
     std::vector<Item> _items;
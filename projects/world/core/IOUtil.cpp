@@ -1,5 +1,6 @@
 #include "IOUtil.h"
 
+#include <cstdio>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -9,6 +10,8 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#else
+#include <unistd.h>
 #endif
 
 #include <tinydir/tinydir.h>
@@ -82,6 +85,44 @@ std::vector<std::string> getFileList(const std::string &directory) {
     return result;
 }
 
+void removeDirectories(const std::string &directory) {
+    tinydir_dir dir;
+
+    if (tinydir_open(&dir, directory.c_str()) != 0) {
+        return;
+    }
+
+    std::vector<std::string> subdirs;
+
+    while (dir.has_next) {
+        tinydir_file file;
+        tinydir_readfile(&dir, &file);
+        std::string name(file.name);
+
+        if (file.is_dir) {
+            if (name != "." && name != "..") {
+                subdirs.push_back(directory + "/" + name);
+            }
+        } else {
+            std::remove((directory + "/" + name).c_str());
+        }
+
+        tinydir_next(&dir);
+    }
+
+    tinydir_close(&dir);
+
+    for (const std::string &subdir : subdirs) {
+        removeDirectories(subdir);
+    }
+
+#ifdef _WIN32
+    _rmdir(directory.c_str());
+#else
+    rmdir(directory.c_str());
+#endif
+}
+
 #if defined(WIN32)
 #else
 #include <sys/resource.h>
@@ -13,6 +13,10 @@ void WORLDAPI_EXPORT createDirectories(const std::string &directory);
 std::vector<std::string> WORLDAPI_EXPORT
 getFileList(const std::string &directory);
 
+/** Removes the directory with all its content. Does nothing if the
+ * directory does not exist. */
+void WORLDAPI_EXPORT removeDirectories(const std::string &directory);
+
 // TODO Move that on the correct file
 /** On linux returns memory usage in kB. */
 long WORLDAPI_EXPORT getMemoryUsage();
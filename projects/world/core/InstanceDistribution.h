@@ -6,6 +6,7 @@
 #include <random>
 
 #include "world/core/Chunk.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -36,8 +37,9 @@ public:
     };
 
 
-    DistributionBase(IEnvironment *env)
-            : _env{env}, _rng{static_cast<u32>(time(NULL))} {}
+    DistributionBase(IEnvironment *env) : _env{env} {}
+
+    void setSeed(u64 seed) { _seed = seed; }
 
     void setResolution(double resolution) { _resolution = resolution; }
 
@@ -51,10 +53,19 @@ public:
 
 protected:
     IEnvironment *_env;
-    std::mt19937 _rng;
+    u64 _seed = DEFAULT_SEED;
+    /** Stream of the chunk being processed, see #seedChunk. */
+    RandomStream _rng;
 
     std::vector<HabitatFeatures> _habitats;
     double _resolution = 20;
+
+
+    /** Restarts the random stream from a seed derived from the chunk, so
+     * that the positions in a chunk do not depend on the other chunks. */
+    void seedChunk(const Chunk &chunk) {
+        _rng.seed(deriveSeed(_seed, chunk.getPosition3D(), chunk.getSize()));
+    }
 };
 
 
@@ -66,6 +77,7 @@ public:
 
     std::vector<Position> getPositions(Chunk &chunk) {
         std::vector<Position> positions;
+        seedChunk(chunk);
 
         const vec3d chunkPos = chunk.getPosition3D();
         const vec3d chunkDims = chunk.getSize();
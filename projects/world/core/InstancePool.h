@@ -3,7 +3,6 @@
 
 #include "world/core/WorldConfig.h"
 
-#include <random>
 #include <vector>
 #include <map>
 
@@ -13,6 +12,7 @@
 #include "Chunk.h"
 #include "InstanceDistribution.h"
 #include "IInstanceGenerator.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -20,12 +20,16 @@ namespace world {
 template <typename TGenerator, typename TDistribution = RandomDistribution>
 class InstancePool : public IChunkDecorator, public WorldNode {
 public:
-    InstancePool(IEnvironment *env)
-            : _env{env}, _distribution(env),
-              _rng(static_cast<u64>(time(NULL))) {}
+    InstancePool(IEnvironment *env) : _env{env}, _distribution(env) {
+        _distribution.setSeed(deriveSeed(_seed, "distribution"));
+    }
 
     void setResolution(double resolution);
 
+    /** Set the seed of the pool. The species are derived from it, so it
+     * should be set before the first collect. */
+    void setSeed(u64 seed) override;
+
     TDistribution &distribution() { return _distribution; }
 
     void collectSelf(ICollector &collector,
@@ -46,7 +50,7 @@ private:
 
     TDistribution _distribution;
 
-    std::mt19937 _rng;
+    u64 _seed = DEFAULT_SEED;
     std::vector<std::unique_ptr<TGenerator>> _generators;
     std::vector<std::vector<Template>> _objects;
     u64 _chunksDecorated = 0;
@@ -75,6 +79,8 @@ public:
 
     size_t getNodeCount() const;
 
+    size_t getMemoryUsage() const override;
+
     void collectSelf(ICollector &collector,
                      const IResolutionModel &resolutionModel,
                      const ExplorationContext &ctx) override;
@@ -15,6 +15,12 @@ void InstancePool<TGenerator, TDistribution>::setResolution(double resolution) {
     _resolution = resolution;
 }
 
+template <typename TGenerator, typename TDistribution>
+void InstancePool<TGenerator, TDistribution>::setSeed(u64 seed) {
+    _seed = seed;
+    _distribution.setSeed(deriveSeed(seed, "distribution"));
+}
+
 template <typename TGenerator, typename TDistribution>
 inline void InstancePool<TGenerator, TDistribution>::collectSelf(
     ICollector &collector, const IResolutionModel &resolutionModel,
@@ -26,6 +32,7 @@ inline void InstancePool<TGenerator, TDistribution>::collectSelf(
     while (_generators.size() < _speciesDensity * totalArea ||
            _generators.size() < _minSpecies) {
         std::unique_ptr<TGenerator> newSpecies = std::make_unique<TGenerator>();
+        newSpecies->setSeed(deriveSeed(_seed, "species", _generators.size()));
         _distribution.addGenerator(newSpecies->randomize());
         _generators.push_back(std::move(newSpecies));
     }
@@ -65,6 +72,7 @@ inline void InstancePool<TGenerator, TDistribution>::decorate(Chunk &chunk) {
     }
 
     // Distribution
+    RandomStream rng(_seed, chunkPos, chunkDims);
     std::uniform_real_distribution<double> rotDistrib(0, M_PI * 2);
     auto &instance = chunk.addChild<Instance>();
     auto positions = _distribution.getPositions(chunk);
@@ -77,12 +85,12 @@ inline void InstancePool<TGenerator, TDistribution>::decorate(Chunk &chunk) {
         }
 
         std::uniform_int_distribution<int> select(0, templates.size() - 1);
-        Template object = templates[select(_rng)];
+        Template object = templates[select(rng)];
 
         // Apply random rotation and scaling
         object._position = position._pos;
-        object._rotation = {0, 0, rotDistrib(_rng)};
-        double scale = randScale(_rng, 1, 1.2);
+        object._rotation = {0, 0, rotDistrib(rng)};
+        double scale = randScale(rng, 1, 1.2);
         object._scale = {scale};
 
         instance.addNode(std::move(object));
@@ -122,7 +130,8 @@ void InstancePool<TGenerator, TDistribution>::exportSpecies(
             vec3d c{x * sep, y * sep, 0};
             SceneNode node = templates[y];
             node.setPosition(c);
-            nodeChan.put({std::to_string(x), std::to_string(y)}, node);
+            nodeChan.put({NodeKey(std::to_string(x)), std::to_string(y)},
+                         node);
         }
     }
     ObjLoader().write(collector.toScene(), outputDir + "/instances.obj");
@@ -166,6 +175,16 @@ inline void Instance::addNode(Template tp) {
 
 inline size_t Instance::getNodeCount() const { return _templates.size(); }
 
+inline size_t Instance::getMemoryUsage() const {
+    size_t bytes =
+        WorldNode::getMemoryUsage() + _templates.capacity() * sizeof(Template);
+
+    for (const Template &tp : _templates) {
+        bytes += tp.getMemoryUsage();
+    }
+    return bytes;
+}
+
 inline void Instance::collectSelf(ICollector &collector,
                                   const IResolutionModel &resolutionModel,
                                   const ExplorationContext &ctx) {
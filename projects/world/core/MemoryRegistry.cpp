@@ -0,0 +1,53 @@
+#include "MemoryRegistry.h"
+
+namespace world {
+
+MemoryRegistry &MemoryRegistry::getDefault() {
+    static MemoryRegistry registry;
+    return registry;
+}
+
+u64 MemoryRegistry::add(const std::string &subsystem, Counter counter) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    u64 id = _nextId++;
+    _entries.emplace(id, Entry{subsystem, std::move(counter)});
+    return id;
+}
+
+void MemoryRegistry::remove(u64 id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.erase(id);
+}
+
+size_t MemoryRegistry::getUsage(const std::string &subsystem) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t bytes = 0;
+
+    for (auto &entry : _entries) {
+        if (entry.second._subsystem == subsystem) {
+            bytes += entry.second._counter();
+        }
+    }
+    return bytes;
+}
+
+std::map<std::string, size_t> MemoryRegistry::getUsages() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::map<std::string, size_t> usages;
+
+    for (auto &entry : _entries) {
+        usages[entry.second._subsystem] += entry.second._counter();
+    }
+    return usages;
+}
+
+size_t MemoryRegistry::getTotalUsage() const {
+    size_t bytes = 0;
+
+    for (auto &entry : getUsages()) {
+        bytes += entry.second;
+    }
+    return bytes;
+}
+
+} // namespace world
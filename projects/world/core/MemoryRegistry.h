@@ -0,0 +1,55 @@
+#ifndef WORLD_MEMORY_REGISTRY_H
+#define WORLD_MEMORY_REGISTRY_H
+
+#include "world/core/WorldConfig.h"
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "WorldTypes.h"
+
+namespace world {
+
+/** Gives the number of bytes currently used by each subsystem of the
+ * library. Objects holding a lot of memory (grounds, chunk systems...) add
+ * a counter to the registry when they are created, and remove it when they
+ * are destroyed. Counters of a same subsystem are summed. */
+class WORLDAPI_EXPORT MemoryRegistry {
+public:
+    typedef std::function<size_t()> Counter;
+
+    /** Get the registry used by the library. */
+    static MemoryRegistry &getDefault();
+
+    /** Adds a counter to the given subsystem, and returns an id to remove
+     * it. The counter is called with the registry locked, so it must not
+     * use the registry. */
+    u64 add(const std::string &subsystem, Counter counter);
+
+    void remove(u64 id);
+
+    /** Get the number of bytes used by the given subsystem. */
+    size_t getUsage(const std::string &subsystem) const;
+
+    /** Get the number of bytes used by each subsystem that has at least one
+     * counter. */
+    std::map<std::string, size_t> getUsages() const;
+
+    size_t getTotalUsage() const;
+
+private:
+    struct Entry {
+        std::string _subsystem;
+        Counter _counter;
+    };
+
+    mutable std::mutex _mutex;
+    std::map<u64, Entry> _entries;
+    u64 _nextId = 1;
+};
+
+} // namespace world
+
+#endif // WORLD_MEMORY_REGISTRY_H
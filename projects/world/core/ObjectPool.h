@@ -0,0 +1,92 @@
+#ifndef WORLD_OBJECT_POOL_H
+#define WORLD_OBJECT_POOL_H
+
+#include "world/core/WorldConfig.h"
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace world {
+
+/** Allocates objects of type T in slabs of SlabSize objects. The memory of
+ * destroyed objects is reused by the next created objects, and is only given
+ * back to the system when the pool is destroyed. Objects never move in
+ * memory, so pointers to them stay valid until they are destroyed.
+ *
+ * The pool does not keep track of the living objects: the owner must
+ * destroy all of them before destroying the pool. */
+template <typename T, size_t SlabSize = 64> class ObjectPool {
+public:
+    ObjectPool() = default;
+
+    ObjectPool(const ObjectPool &other) = delete;
+
+    ObjectPool(ObjectPool &&other) noexcept
+            : _slabs(std::move(other._slabs)), _free(other._free) {
+        other._free = nullptr;
+    }
+
+    ObjectPool &operator=(const ObjectPool &other) = delete;
+
+    ObjectPool &operator=(ObjectPool &&other) noexcept {
+        _slabs = std::move(other._slabs);
+        _free = other._free;
+        other._free = nullptr;
+        return *this;
+    }
+
+    template <typename... Args> T *create(Args &&... args) {
+        if (_free == nullptr) {
+            allocateSlab();
+        }
+
+        Slot *slot = _free;
+        _free = slot->_next;
+
+        try {
+            return new (&slot->_storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->_next = _free;
+            _free = slot;
+            throw;
+        }
+    }
+
+    void destroy(T *object) {
+        object->~T();
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->_next = _free;
+        _free = slot;
+    }
+
+    /** Number of objects that can be allocated without allocating a new
+     * slab, including the living ones. */
+    size_t capacity() const { return _slabs.size() * SlabSize; }
+
+private:
+    union Slot {
+        Slot *_next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> _slabs;
+    Slot *_free = nullptr;
+
+
+    void allocateSlab() {
+        _slabs.emplace_back(new Slot[SlabSize]);
+        Slot *slab = _slabs.back().get();
+
+        for (size_t i = 0; i < SlabSize; ++i) {
+            slab[i]._next = i + 1 < SlabSize ? &slab[i + 1] : _free;
+        }
+        _free = slab;
+    }
+};
+
+} // namespace world
+
+#endif // WORLD_OBJECT_POOL_H
@@ -2,10 +2,11 @@
 
 #include "WorldConfig.h"
 
+#include <functional>
 #include <random>
-#include <time.h>
 
 #include "world/math/MathsHelper.h"
+#include "world/math/RandomStream.h"
 #include "ICloneable.h"
 
 namespace world {
@@ -21,8 +22,12 @@ private:
 };
 
 template <typename Out, typename... In> struct Params {
-    static std::mt19937 &rng() {
-        static std::mt19937 _rng(static_cast<u32>(time(NULL)));
+    /** Random generator used to evaluate the parameters. Each thread has
+     * its own generator: a generator that evaluates parameters should
+     * reseed it from its own random stream first, so that the results do
+     * not depend on the thread nor on what was evaluated before. */
+    static RandomStream &rng() {
+        thread_local RandomStream _rng;
         return _rng;
     };
 
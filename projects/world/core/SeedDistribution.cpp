@@ -18,18 +18,19 @@ void SeedDistribution::addSeeds(Chunk &chunk) {
 
             if (ret.second) {
                 auto &seeds = ret.first->second;
-                double count = randRound(_rng, area * _seedDensity);
+                RandomStream rng(_seed, tileCoords);
+                double count = randRound(rng, area * _seedDensity);
 
                 for (int i = 0; i < count; ++i) {
                     vec2d seedPos =
-                        (vec2d{distrib(_rng), distrib(_rng)} + tileCoords) *
+                        (vec2d{distrib(rng), distrib(rng)} + tileCoords) *
                         _tileSize;
-                    double distRatio = distrib(_rng);
+                    double distRatio = distrib(rng);
                     double distance = _maxDist * (1 - distRatio * distRatio);
 
                     // Choose the generator
                     // TODO choose the generator according to local conditions
-                    u32 generatorId = genDistrib(_rng);
+                    u32 generatorId = genDistrib(rng);
                     seeds.push_back({seedPos, generatorId, distance});
 
                     // std::cout << seedPos.x << " " << seedPos.y << " " <<
@@ -59,6 +60,7 @@ std::vector<Seed> SeedDistribution::getSeedsAround(Chunk &chunk) {
 std::vector<SeedDistribution::Position> SeedDistribution::getPositions(
     Chunk &chunk) {
     addSeeds(chunk);
+    seedChunk(chunk);
 
     std::vector<Position> positions;
     std::vector<Seed> seedsAround = getSeedsAround(chunk);
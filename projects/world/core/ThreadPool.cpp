@@ -0,0 +1,143 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace world {
+
+class ThreadPoolPrivate {
+public:
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<std::function<void()>> _tasks;
+    bool _stop = false;
+
+
+    void enqueue(std::function<void()> task);
+
+    void run();
+};
+
+void ThreadPoolPrivate::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _condition.notify_one();
+}
+
+void ThreadPoolPrivate::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+
+            if (_stop && _tasks.empty())
+                return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        task();
+    }
+}
+
+
+ThreadPool::ThreadPool(int threadCount) : _internal(new ThreadPoolPrivate()) {
+    if (threadCount <= 0) {
+        threadCount =
+            std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+
+    // The calling thread also works, so we spawn one thread less
+    for (int i = 1; i < threadCount; ++i) {
+        _internal->_threads.emplace_back([this] { _internal->run(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_internal->_mutex);
+        _internal->_stop = true;
+    }
+    _internal->_condition.notify_all();
+
+    for (auto &thread : _internal->_threads) {
+        thread.join();
+    }
+
+    delete _internal;
+}
+
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>(_internal->_threads.size()) + 1;
+}
+
+void ThreadPool::parallelFor(size_t count,
+                             const std::function<void(size_t)> &job) {
+    if (_internal->_threads.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    struct ForState {
+        std::atomic<size_t> _next{0};
+        std::atomic<size_t> _remaining;
+        std::mutex _mutex;
+        std::condition_variable _done;
+        std::exception_ptr _error;
+    };
+
+    auto state = std::make_shared<ForState>();
+    state->_remaining = count;
+
+    // Helpers may start after all the jobs are done, in which case they
+    // return without touching "job".
+    auto work = [state, &job, count]() {
+        size_t i;
+
+        while ((i = state->_next++) < count) {
+            try {
+                job(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->_mutex);
+
+                if (!state->_error)
+                    state->_error = std::current_exception();
+            }
+
+            if (--state->_remaining == 0) {
+                std::lock_guard<std::mutex> lock(state->_mutex);
+                state->_done.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(_internal->_threads.size(), count - 1);
+
+    for (size_t i = 0; i < helpers; ++i) {
+        _internal->enqueue(work);
+    }
+
+    work();
+
+    std::unique_lock<std::mutex> lock(state->_mutex);
+    state->_done.wait(lock, [&state] { return state->_remaining == 0; });
+
+    if (state->_error)
+        std::rethrow_exception(state->_error);
+}
+
+} // namespace world
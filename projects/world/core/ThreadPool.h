@@ -0,0 +1,45 @@
+#ifndef WORLD_THREAD_POOL_H
+#define WORLD_THREAD_POOL_H
+
+#include "world/core/WorldConfig.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace world {
+
+class ThreadPoolPrivate;
+
+/** A fixed set of worker threads that can run jobs concurrently.
+ * The thread pool is used by the generation algorithms to split
+ * independent jobs (for example all the tiles of a same level of detail)
+ * across the cores of the machine. */
+class WORLDAPI_EXPORT ThreadPool {
+public:
+    /** Creates a thread pool with the given number of threads. If
+     * threadCount is 0 or less, the number of hardware threads is used. */
+    explicit ThreadPool(int threadCount = 0);
+
+    ThreadPool(const ThreadPool &other) = delete;
+
+    ~ThreadPool();
+
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    /** Get the number of threads that can run jobs at the same time,
+     * including the calling thread. */
+    int getThreadCount() const;
+
+    /** Calls job(i) for each i in [0, count) and returns when all the
+     * calls are done. The calling thread takes part in the work. If a
+     * job throws, the first exception caught is rethrown by this method
+     * once all the jobs are done. */
+    void parallelFor(size_t count, const std::function<void(size_t)> &job);
+
+private:
+    ThreadPoolPrivate *_internal;
+};
+
+} // namespace world
+
+#endif // WORLD_THREAD_POOL_H
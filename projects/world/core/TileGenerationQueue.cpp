@@ -0,0 +1,140 @@
+#include "TileGenerationQueue.h"
+
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+
+namespace world {
+
+class TileGenerationQueuePrivate {
+public:
+    /** (lod, -priority, coordinates): the first element is the next tile to
+     * generate. */
+    typedef std::tuple<int, double, TileCoordinates> Request;
+
+    TileGenerationQueue::job _job;
+
+    std::thread _thread;
+    mutable std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _idle;
+
+    std::set<Request> _requests;
+    std::map<TileCoordinates, double> _priorities;
+    bool _generating = false;
+    bool _stop = false;
+    size_t _completed = 0;
+
+
+    TileGenerationQueuePrivate(TileGenerationQueue::job job)
+            : _job(std::move(job)) {}
+
+    void run();
+};
+
+void TileGenerationQueuePrivate::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true) {
+        _wakeUp.wait(lock, [this] { return _stop || !_requests.empty(); });
+
+        if (_stop)
+            return;
+
+        TileCoordinates coords = std::get<2>(*_requests.begin());
+        _requests.erase(_requests.begin());
+        _priorities.erase(coords);
+        _generating = true;
+
+        lock.unlock();
+
+        try {
+            _job(coords);
+        } catch (std::exception &e) {
+            std::cerr << "Tile generation failed: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        _generating = false;
+        ++_completed;
+
+        if (_requests.empty()) {
+            _idle.notify_all();
+        }
+    }
+}
+
+
+TileGenerationQueue::TileGenerationQueue(job generationJob)
+        : _internal(new TileGenerationQueuePrivate(std::move(generationJob))) {
+}
+
+TileGenerationQueue::~TileGenerationQueue() {
+    {
+        std::lock_guard<std::mutex> lock(_internal->_mutex);
+        _internal->_stop = true;
+    }
+    _internal->_wakeUp.notify_all();
+
+    if (_internal->_thread.joinable()) {
+        _internal->_thread.join();
+    }
+
+    delete _internal;
+}
+
+void TileGenerationQueue::request(const TileCoordinates &coords,
+                                  double priority) {
+    {
+        std::lock_guard<std::mutex> lock(_internal->_mutex);
+        auto it = _internal->_priorities.find(coords);
+
+        if (it != _internal->_priorities.end()) {
+            _internal->_requests.erase(
+                std::make_tuple(coords._lod, -it->second, coords));
+            it->second = priority;
+        } else {
+            _internal->_priorities.emplace(coords, priority);
+        }
+
+        _internal->_requests.emplace(coords._lod, -priority, coords);
+
+        if (!_internal->_thread.joinable()) {
+            _internal->_thread = std::thread([this] { _internal->run(); });
+        }
+    }
+    _internal->_wakeUp.notify_one();
+}
+
+void TileGenerationQueue::clear() {
+    std::lock_guard<std::mutex> lock(_internal->_mutex);
+    _internal->_requests.clear();
+    _internal->_priorities.clear();
+
+    if (!_internal->_generating) {
+        _internal->_idle.notify_all();
+    }
+}
+
+size_t TileGenerationQueue::pendingCount() const {
+    std::lock_guard<std::mutex> lock(_internal->_mutex);
+    return _internal->_requests.size() + (_internal->_generating ? 1 : 0);
+}
+
+size_t TileGenerationQueue::completedCount() const {
+    std::lock_guard<std::mutex> lock(_internal->_mutex);
+    return _internal->_completed;
+}
+
+void TileGenerationQueue::waitIdle() {
+    std::unique_lock<std::mutex> lock(_internal->_mutex);
+    _internal->_idle.wait(lock, [this] {
+        return _internal->_requests.empty() && !_internal->_generating;
+    });
+}
+
+} // namespace world
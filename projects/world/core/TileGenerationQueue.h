@@ -0,0 +1,62 @@
+#ifndef WORLD_TILE_GENERATION_QUEUE_H
+#define WORLD_TILE_GENERATION_QUEUE_H
+
+#include "world/core/WorldConfig.h"
+
+#include <functional>
+
+#include "TileSystem.h"
+
+namespace world {
+
+class TileGenerationQueuePrivate;
+
+/** A background thread that generates tiles one after the other. Tiles
+ * with the lowest level of detail are generated first, so that a coarse
+ * version of the world is quickly available. Among tiles of the same level
+ * of detail, the ones with the highest priority come first.
+ *
+ * The generation job is given at construction and is responsible for the
+ * synchronization with the other threads. The thread is started the first
+ * time a tile is requested. */
+class WORLDAPI_EXPORT TileGenerationQueue {
+public:
+    typedef std::function<void(const TileCoordinates &)> job;
+
+    explicit TileGenerationQueue(job generationJob);
+
+    TileGenerationQueue(const TileGenerationQueue &other) = delete;
+
+    /** Waits for the tile currently generated, then stops the thread. The
+     * other pending tiles are dropped. */
+    ~TileGenerationQueue();
+
+    TileGenerationQueue &operator=(const TileGenerationQueue &other) = delete;
+
+    /** Schedules the generation of the given tile. If the tile is already
+     * scheduled, its priority is updated. */
+    void request(const TileCoordinates &coords, double priority);
+
+    /** Drops all the tiles that are not being generated yet. This is
+     * typically called before scheduling the tiles needed by a new point of
+     * view. */
+    void clear();
+
+    /** Returns the number of tiles waiting for generation, including the one
+     * currently generated. */
+    size_t pendingCount() const;
+
+    /** Returns the number of tiles generated since the creation of the
+     * queue. A change of this number means that new tiles are available. */
+    size_t completedCount() const;
+
+    /** Blocks until every scheduled tile is generated. */
+    void waitIdle();
+
+private:
+    TileGenerationQueuePrivate *_internal;
+};
+
+} // namespace world
+
+#endif // WORLD_TILE_GENERATION_QUEUE_H
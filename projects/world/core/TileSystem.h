@@ -3,6 +3,7 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <cstring>
 #include <functional>
 #include <list>
 
@@ -23,11 +24,13 @@ struct WORLDAPI_EXPORT TileCoordinates {
     TileCoordinates() {}
     TileCoordinates(const NodeKey &key) {
         const int keySize = sizeof(int) * 4;
+        std::string content = key.str();
 
-        if (key.length() != keySize)
+        if (content.length() != keySize)
             throw std::runtime_error("bad usage : please provide a valid key");
 
-        const int *features = reinterpret_cast<const int *>(key.c_str());
+        int features[4];
+        std::memcpy(features, content.data(), keySize);
 
         _pos = {features[0], features[1], features[2]};
         _lod = features[3];
@@ -46,14 +49,32 @@ struct WORLDAPI_EXPORT TileCoordinates {
 
     NodeKey toKey() const {
         int features[] = {_pos.x, _pos.y, _pos.z, _lod};
-        return std::string(reinterpret_cast<char *>(features),
-                           sizeof(features));
+        return NodeKey(reinterpret_cast<char *>(features), sizeof(features));
     }
 
     vec3i _pos;
     int _lod = 0;
 };
 
+/** Hash of the coordinates, used as seed value (see RandomStream.h) and by
+ * std::hash. Unlike std::hash, its result does not depend on the platform:
+ * the coordinates are combined, then the bits are mixed with the finalizer
+ * of MurmurHash3 so that neighbour tiles get very different values. */
+inline u64 seedValue(const TileCoordinates &c) {
+    const u64 prime = 0x9E3779B97F4A7C15ull;
+    u64 hash = static_cast<u32>(c._pos.x);
+    hash = hash * prime + static_cast<u32>(c._pos.y);
+    hash = hash * prime + static_cast<u32>(c._pos.z);
+    hash = hash * prime + static_cast<u32>(c._lod);
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
 inline bool operator<(const TileCoordinates &coord1,
                       const TileCoordinates &coord2) {
     return coord1._lod < coord2._lod
@@ -208,11 +229,7 @@ namespace std {
 template <> class hash<world::TileCoordinates> {
 public:
     size_t operator()(const world::TileCoordinates &c) const {
-        world::s64 hash = (c._pos.x << 8) + 31;
-        hash *= (c._pos.y << 8) + 31;
-        hash *= (c._pos.z << 8) + 31;
-        hash *= (c._lod << 8) + 31;
-        return static_cast<size_t>(hash);
+        return static_cast<size_t>(world::seedValue(c));
     }
 };
 } // namespace std
@@ -0,0 +1,214 @@
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+namespace world {
+
+/** Ring buffer of the zones recorded by one thread. */
+class TraceBuffer {
+public:
+    std::mutex _mutex;
+    std::vector<TraceEvent> _events;
+    /// Index of the next event to write
+    size_t _next = 0;
+    bool _full = false;
+    u32 _thread;
+
+
+    TraceBuffer(size_t size, u32 thread) : _events(size), _thread(thread) {}
+
+    void add(const TraceEvent &event) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_events.empty()) {
+            return;
+        }
+
+        _events[_next] = event;
+        _events[_next]._thread = _thread;
+        ++_next;
+
+        if (_next == _events.size()) {
+            _next = 0;
+            _full = true;
+        }
+    }
+
+    void clear(size_t size) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _events.assign(size, TraceEvent());
+        _next = 0;
+        _full = false;
+    }
+
+    void appendTo(std::vector<TraceEvent> &events) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_full) {
+            events.insert(events.end(), _events.begin() + _next,
+                          _events.end());
+        }
+        events.insert(events.end(), _events.begin(), _events.begin() + _next);
+    }
+};
+
+namespace {
+
+std::atomic<u64> tracerCounter{0};
+
+std::string readableName(const char *name) {
+#ifdef __GNUG__
+    // Type names given by typeid are mangled
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+    if (status == 0 && demangled != nullptr) {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+void writeJsonString(std::ostream &stream, const std::string &str) {
+    stream << '"';
+
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if (static_cast<u8>(c) >= 0x20) {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+} // namespace
+
+Tracer &Tracer::getDefault() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+        : _enabled(false), _epoch(std::chrono::steady_clock::now()),
+          _bufferSize(1 << 16), _id(++tracerCounter) {}
+
+Tracer::~Tracer() = default;
+
+void Tracer::setBufferSize(size_t size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _bufferSize = size;
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto &buffer : _buffers) {
+        buffer->clear(_bufferSize);
+    }
+}
+
+std::vector<TraceEvent> Tracer::getEvents() const {
+    std::vector<TraceEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        for (auto &buffer : _buffers) {
+            buffer->appendTo(events);
+        }
+    }
+
+    std::sort(events.begin(), events.end(),
+              [](const TraceEvent &e1, const TraceEvent &e2) {
+                  return e1._start < e2._start ||
+                         (e1._start == e2._start && e1._depth < e2._depth);
+              });
+    return events;
+}
+
+void Tracer::exportChromeTrace(std::ostream &stream) const {
+    std::vector<TraceEvent> events = getEvents();
+    u32 threadCount;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        threadCount = static_cast<u32>(_buffers.size());
+    }
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    stream.precision(15);
+    bool first = true;
+
+    for (u32 i = 0; i < threadCount; ++i) {
+        stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":"
+               << "\"M\",\"pid\":0,\"tid\":" << i
+               << ",\"args\":{\"name\":\"thread " << i << "\"}}";
+        first = false;
+    }
+
+    for (const TraceEvent &event : events) {
+        stream << (first ? "" : ",") << "\n{\"name\":";
+        writeJsonString(stream, event._name);
+        stream << ",\"cat\":\"world\",\"ph\":\"X\",\"ts\":"
+               << event._start / 1000.0
+               << ",\"dur\":" << (event._end - event._start) / 1000.0
+               << ",\"pid\":0,\"tid\":" << event._thread;
+
+        if (event._detail != nullptr) {
+            stream << ",\"args\":{\"detail\":";
+            writeJsonString(stream, readableName(event._detail));
+            stream << "}";
+        }
+        stream << "}";
+        first = false;
+    }
+    stream << "\n]}\n";
+}
+
+void Tracer::exportChromeTrace(const std::string &path) const {
+    std::ofstream file(path);
+
+    if (!file) {
+        throw std::runtime_error("Tracer: could not open " + path);
+    }
+    exportChromeTrace(file);
+}
+
+u64 Tracer::now() const {
+    return static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _epoch)
+            .count());
+}
+
+void Tracer::record(const TraceEvent &event) { threadBuffer().add(event); }
+
+u32 &Tracer::currentDepth() {
+    thread_local u32 depth = 0;
+    return depth;
+}
+
+TraceBuffer &Tracer::threadBuffer() {
+    // The buffer of the last tracer used by this thread
+    thread_local u64 tracerId = 0;
+    thread_local TraceBuffer *buffer = nullptr;
+
+    if (tracerId != _id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.push_back(std::make_shared<TraceBuffer>(
+            _bufferSize, static_cast<u32>(_buffers.size())));
+        buffer = _buffers.back().get();
+        tracerId = _id;
+    }
+    return *buffer;
+}
+
+} // namespace world
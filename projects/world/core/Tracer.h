@@ -0,0 +1,144 @@
+#ifndef WORLD_TRACER_H
+#define WORLD_TRACER_H
+
+#include "world/core/WorldConfig.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "WorldTypes.h"
+
+namespace world {
+
+class TraceBuffer;
+
+/** A timed zone recorded by the Tracer. */
+struct TraceEvent {
+    /// Name of the zone, must be a string with static storage
+    const char *_name = nullptr;
+    /// Optional detail about the zone (for example the type of a worker),
+    /// must be a string with static storage or nullptr
+    const char *_detail = nullptr;
+    /// Start and end of the zone, in nanoseconds since the creation of the
+    /// tracer
+    u64 _start = 0;
+    u64 _end = 0;
+    /// Number of zones containing this one in the same thread
+    u32 _depth = 0;
+    /// Index of the thread in the tracer
+    u32 _thread = 0;
+};
+
+/** Records the zones of code executed by the library, in each thread. Each
+ * thread writes in its own ring buffer, so that recording does not
+ * serialize the threads and the memory used stays bounded: when a buffer is
+ * full, the oldest zones are overwritten.
+ *
+ * Zones are recorded with the WORLD_TRACE_ZONE macro. They are only recorded
+ * if the tracer is enabled at runtime, and the macro is removed entirely if
+ * the library is built without WORLD_ENABLE_TRACING.
+ *
+ * The recorded zones can be exported in the Chrome trace format, which can
+ * be opened with chrome://tracing or https://ui.perfetto.dev */
+class WORLDAPI_EXPORT Tracer {
+public:
+    /** Get the tracer used by the library. */
+    static Tracer &getDefault();
+
+    Tracer();
+
+    ~Tracer();
+
+    void setEnabled(bool enabled) { _enabled = enabled; }
+
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    /** Set the number of zones kept for each thread. Applies to the buffers
+     * created afterwards and to the buffers cleared by #clear. */
+    void setBufferSize(size_t size);
+
+    /** Removes all the recorded zones. */
+    void clear();
+
+    /** Get the recorded zones of all the threads, sorted by start time. */
+    std::vector<TraceEvent> getEvents() const;
+
+    /** Write all the recorded zones in the Chrome trace JSON format. */
+    void exportChromeTrace(std::ostream &stream) const;
+
+    void exportChromeTrace(const std::string &path) const;
+
+    /** Get the current time of the tracer, in nanoseconds. */
+    u64 now() const;
+
+    /** Adds a zone to the buffer of the current thread. */
+    void record(const TraceEvent &event);
+
+    /** Get the number of zones that are currently open in this thread. */
+    static u32 &currentDepth();
+
+private:
+    std::atomic_bool _enabled;
+    std::chrono::steady_clock::time_point _epoch;
+    size_t _bufferSize;
+
+    mutable std::mutex _mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> _buffers;
+
+    /// Identifies the tracer in the thread local storage
+    u64 _id;
+
+
+    TraceBuffer &threadBuffer();
+};
+
+/** Records a zone in the default tracer from its construction to its
+ * destruction. Prefer using the WORLD_TRACE_ZONE macro. */
+class TraceZone {
+public:
+    explicit TraceZone(const char *name, const char *detail = nullptr)
+            : _tracer(Tracer::getDefault()) {
+        if (_tracer.isEnabled()) {
+            _event._name = name;
+            _event._detail = detail;
+            _event._depth = Tracer::currentDepth()++;
+            _event._start = _tracer.now();
+        }
+    }
+
+    TraceZone(const TraceZone &) = delete;
+
+    ~TraceZone() {
+        if (_event._name != nullptr) {
+            _event._end = _tracer.now();
+            --Tracer::currentDepth();
+            _tracer.record(_event);
+        }
+    }
+
+private:
+    Tracer &_tracer;
+    TraceEvent _event;
+};
+
+} // namespace world
+
+#define WORLD_TRACE_CONCAT_IMPL(a, b) a##b
+#define WORLD_TRACE_CONCAT(a, b) WORLD_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef WORLD_ENABLE_TRACING
+/** Records the enclosing scope as a zone of the default tracer. An optional
+ * second argument gives details about the zone. Both arguments must be
+ * strings with static storage. */
+#define WORLD_TRACE_ZONE(...)                                                 \
+    ::world::TraceZone WORLD_TRACE_CONCAT(_worldTraceZone, __LINE__)(__VA_ARGS__)
+#else
+#define WORLD_TRACE_ZONE(...)
+#endif
+
+#endif // WORLD_TRACER_H
@@ -3,7 +3,9 @@
 #include <map>
 
 #include "world/flat/FlatWorld.h"
+#include "world/math/RandomStream.h"
 #include "GridChunkSystem.h"
+#include "Tracer.h"
 
 namespace world {
 
@@ -12,6 +14,9 @@ public:
     WorldPrivate() = default;
 
     int _counter = 0;
+    bool _async = false;
+    u64 _seed = DEFAULT_SEED;
+    std::shared_ptr<ICache> _cache;
     std::map<NodeKey, std::unique_ptr<WorldNode>> _primaryNodes;
 
     IChunkSystem *_chunkSystem = nullptr;
@@ -21,16 +26,45 @@ public:
 World *World::createDemoWorld() { return FlatWorld::createDemoFlatWorld(); }
 
 
-World::World() : _internal(new WorldPrivate()), _directory() {}
+World::World() : _internal(new WorldPrivate()) {}
 
 World::~World() { delete _internal; }
 
+void World::setAsyncCollect(bool async) { _internal->_async = async; }
+
+bool World::isAsyncCollect() const { return _internal->_async; }
+
+size_t World::getAsyncGenerationCount() const {
+    size_t count = 0;
+
+    for (auto &entry : _internal->_primaryNodes) {
+        count += entry.second->getAsyncGenerationCount();
+    }
+    return count;
+}
+
+void World::setCache(std::shared_ptr<ICache> cache) {
+    _internal->_cache = std::move(cache);
+}
+
+std::shared_ptr<ICache> World::getCache() const { return _internal->_cache; }
+
+void World::setSeed(u64 seed) {
+    _internal->_seed = seed;
+
+    for (auto &entry : _internal->_primaryNodes) {
+        seedPrimaryNode(entry.first, *entry.second);
+    }
+}
+
+u64 World::getSeed() const { return _internal->_seed; }
+
 void World::collect(ICollector &collector,
                     const IResolutionModel &resolutionModel) {
+    WORLD_TRACE_ZONE("World::collect");
 
     for (auto &entry : _internal->_primaryNodes) {
-        ExplorationContext ctx;
-        ctx.setEnvironment(getInitialEnvironment());
+        ExplorationContext ctx = getInitialContext();
         ctx.appendPrefix(entry.first);
         ctx.addOffset(entry.second->getPosition3D());
 
@@ -45,10 +79,26 @@ void World::addPrimaryNodeInternal(WorldNode *node) {
             "a chunksystem instead.");
     }
 
-    _internal->_primaryNodes.emplace(std::to_string(++_internal->_counter),
-                                     std::unique_ptr<WorldNode>(node));
+    NodeKey key = std::to_string(++_internal->_counter);
+    seedPrimaryNode(key, *node);
+    _internal->_primaryNodes.emplace(key, std::unique_ptr<WorldNode>(node));
+}
+
+void World::seedPrimaryNode(const NodeKey &key, WorldNode &node) {
+    auto *chunkSystem = dynamic_cast<GridChunkSystem *>(&node);
+
+    if (chunkSystem != nullptr) {
+        chunkSystem->setSeed(deriveSeed(_internal->_seed, key));
+    }
 }
 
 IEnvironment *World::getInitialEnvironment() { return nullptr; }
 
+ExplorationContext World::getInitialContext() {
+    ExplorationContext ctx;
+    ctx.setEnvironment(getInitialEnvironment());
+    ctx.setAsync(_internal->_async);
+    return ctx;
+}
+
 } // namespace world
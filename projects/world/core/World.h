@@ -11,7 +11,7 @@
 
 #include "IChunkSystem.h"
 #include "WorldNode.h"
-#include "WorldFolder.h"
+#include "ICache.h"
 #include "IChunkDecorator.h"
 #include "ICollector.h"
 
@@ -44,6 +44,37 @@ public:
     template <typename T, typename... Args>
     T &addPrimaryNode(const vec3d &position, Args &... args);
 
+    /** If enabled, #collect returns as soon as possible with the data that
+     * is already generated. The missing data is generated in background,
+     * nearest and coarsest parts first, and is available to the next calls
+     * to #collect. Collecting again regularly is then needed to get the
+     * world refined. Disabled by default. */
+    void setAsyncCollect(bool async);
+
+    bool isAsyncCollect() const;
+
+    /** Get the number of parts of the world generated in background since
+     * its creation. An application collecting asynchronously only needs to
+     * collect again when this number changed. */
+    virtual size_t getAsyncGenerationCount() const;
+
+    /** Set the cache in which the generated data are saved, so that they can
+     * be reloaded instead of being generated again. The cache is also given
+     * to the nodes of the world that support it. */
+    virtual void setCache(std::shared_ptr<ICache> cache);
+
+    /** Gets the cache of this world, or null if none was set. */
+    std::shared_ptr<ICache> getCache() const;
+
+    /** Set the seed of the world. Every random value of the generation is
+     * derived from this seed and from the location where it is used, so a
+     * world with a given seed is always the same, whatever the order in
+     * which it is explored or the number of threads generating it. The seed
+     * should be set before the first collect. */
+    virtual void setSeed(u64 seed);
+
+    u64 getSeed() const;
+
     // ASSETS
     virtual void collect(ICollector &collector,
                          const IResolutionModel &resolutionModel);
@@ -51,15 +82,19 @@ public:
 protected:
     void addPrimaryNodeInternal(WorldNode *node);
 
+    /** Gives the primary node a seed derived from the seed of the world, if
+     * the node supports it. */
+    void seedPrimaryNode(const NodeKey &key, WorldNode &node);
+
     /** Gets initial environment to initialize the base context */
     virtual IEnvironment *getInitialEnvironment();
 
+    /** Gets the context from which the contexts of the primary nodes are
+     * derived. */
+    ExplorationContext getInitialContext();
+
 private:
     WorldPrivate *_internal;
-
-    // TODO remplacer a par un ICache, qui peut tre un
-    // dossier, une interface rseau, rien...
-    WorldFolder _directory;
 };
 } // namespace world
 
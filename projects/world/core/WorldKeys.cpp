@@ -1,20 +1,389 @@
 #include "WorldKeys.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <mutex>
+#include <unordered_map>
 
 #include "WorldTypes.h"
+#include "MemoryRegistry.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
+namespace {
+
+/// Odd factor used to hash the paths of the item keys
+const u64 PATH_FACTOR = 0x9E3779B97F4A7C15ULL;
+
+u64 pathFactor(u32 length) {
+    u64 result = 1, factor = PATH_FACTOR;
+
+    for (; length != 0; length >>= 1) {
+        if (length & 1)
+            result *= factor;
+        factor *= factor;
+    }
+    return result;
+}
+
+u64 hashContent(const char *data, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+
+    // FNV-1a, stable between runs and platforms
+    u64 hash = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<u8>(data[i])) * 0x100000001B3ULL;
+    }
+    hash = mixBits(hash);
+    return hash == 0 ? 1 : hash;
+}
+
+/** An item key is registered either as a single node, or as the
+ * concatenation of two shorter keys. */
+struct ItemEntry {
+    u64 _leftHash;
+    u32 _leftLength;
+    u64 _rightHash;
+    u32 _rightLength;
+
+    bool operator==(const ItemEntry &other) const {
+        return _leftHash == other._leftHash &&
+               _leftLength == other._leftLength &&
+               _rightHash == other._rightHash &&
+               _rightLength == other._rightLength;
+    }
+};
+
+u64 itemId(u64 hash, u32 length) { return mixSeed(hash, length); }
+
+#ifdef NDEBUG
+const bool CHECK_COLLISIONS = false;
+#else
+/// In debug builds every new key is compared to the registered content
+const bool CHECK_COLLISIONS = true;
+#endif
+
+/** Entries of one generation of the registry */
+struct KeyGeneration {
+    std::unordered_map<u64, std::string> _nodes;
+    std::unordered_map<u64, ItemEntry> _items;
+
+    size_t size() const { return _nodes.size() + _items.size(); }
+};
+
+/** Global table of the content of the keys, see KeyRegistry. Each thread
+ * remembers the last keys it registered during the current generation, so
+ * that the table is only locked for keys that were not used recently. */
+class KeyTable {
+public:
+    static KeyTable &get() {
+        static KeyTable table;
+        return table;
+    }
+
+    KeyTable() {
+        _memoryId = MemoryRegistry::getDefault().add(
+            "KeyRegistry", [this]() { return getMemoryUsage(); });
+    }
+
+    ~KeyTable() { MemoryRegistry::getDefault().remove(_memoryId); }
+
+    void addNode(u64 hash, const char *data, size_t size) {
+        thread_local RecentKey recent[RECENT_COUNT] = {};
+        RecentKey &slot = recent[hash % RECENT_COUNT];
+
+        if (CHECK_COLLISIONS || !slot.matches(hash, _generation)) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _current._nodes.find(hash);
+
+            if (it == _current._nodes.end()) {
+                auto previous = _previous._nodes.find(hash);
+
+                if (previous != _previous._nodes.end()) {
+                    it = _current._nodes.insert(*previous).first;
+                    _previous._nodes.erase(previous);
+                } else {
+                    it = _current._nodes
+                             .emplace(hash, std::string(data, size))
+                             .first;
+                }
+            }
+
+            if (CHECK_COLLISIONS && it->second != std::string(data, size)) {
+                throw std::runtime_error("NodeKey collision between \"" +
+                                         it->second + "\" and \"" +
+                                         std::string(data, size) + "\"");
+            }
+            slot = {hash, _generation};
+            checkGeneration();
+        }
+    }
+
+    std::string getNode(u64 hash) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const std::string *content = findNode(hash);
+        return content == nullptr ? std::string() : *content;
+    }
+
+    void addItem(u64 id, const ItemEntry &entry) {
+        thread_local RecentKey recent[RECENT_COUNT] = {};
+        RecentKey &slot = recent[id % RECENT_COUNT];
+
+        if (CHECK_COLLISIONS || !slot.matches(id, _generation)) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _current._items.find(id);
+
+            if (it == _current._items.end()) {
+                auto previous = _previous._items.find(id);
+
+                if (previous != _previous._items.end()) {
+                    it = _current._items.insert(*previous).first;
+                    _previous._items.erase(previous);
+                } else {
+                    it = _current._items.emplace(id, entry).first;
+                }
+            }
+            // The same key can be registered as different concatenations
+            if (CHECK_COLLISIONS && !(it->second == entry)) {
+                std::vector<u64> registered = getNodes(it->second);
+                std::vector<u64> added = getNodes(entry);
+
+                if (!registered.empty() && !added.empty() &&
+                    registered != added) {
+                    throw std::runtime_error("ItemKey collision");
+                }
+            }
+            slot = {id, _generation};
+            checkGeneration();
+        }
+    }
+
+    ItemEntry getItem(u64 id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const ItemEntry *entry = findItem(id);
+
+        if (entry == nullptr) {
+            throw std::runtime_error("ItemKey not registered");
+        }
+        return *entry;
+    }
+
+    void setCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _capacity = capacity;
+        checkGeneration();
+    }
+
+    size_t getCapacity() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _capacity;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _current.size() + _previous.size();
+    }
+
+    size_t getMemoryUsage() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // Approximation of the size of the nodes of the maps
+        const size_t nodeSize =
+            sizeof(std::pair<const u64, std::string>) + 2 * sizeof(void *);
+        const size_t itemSize =
+            sizeof(std::pair<const u64, ItemEntry>) + 2 * sizeof(void *);
+        size_t bytes = 0;
+
+        for (const KeyGeneration *generation : {&_current, &_previous}) {
+            bytes += generation->_nodes.size() * nodeSize +
+                     generation->_items.size() * itemSize;
+
+            for (const auto &node : generation->_nodes) {
+                if (node.second.capacity() > sizeof(std::string)) {
+                    bytes += node.second.capacity();
+                }
+            }
+        }
+        return bytes;
+    }
+
+private:
+    static const int RECENT_COUNT = 1024;
+
+    struct RecentKey {
+        u64 _id;
+        u32 _generation;
+
+        bool matches(u64 id, u32 generation) const {
+            return _id == id && _generation == generation;
+        }
+    };
+
+    std::mutex _mutex;
+    size_t _capacity = 1 << 18;
+    /// Incremented at each generation, read without the lock by the threads
+    std::atomic<u32> _generation{1};
+    KeyGeneration _current;
+    KeyGeneration _previous;
+    u64 _memoryId;
+
+
+    const std::string *findNode(u64 hash) const {
+        for (const KeyGeneration *generation : {&_current, &_previous}) {
+            auto it = generation->_nodes.find(hash);
+
+            if (it != generation->_nodes.end()) {
+                return &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    const ItemEntry *findItem(u64 id) const {
+        for (const KeyGeneration *generation : {&_current, &_previous}) {
+            auto it = generation->_items.find(id);
+
+            if (it != generation->_items.end()) {
+                return &it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Get the hashes of the nodes of an item, in reverse order, or an
+     * empty vector if a part of the item has been forgotten. */
+    std::vector<u64> getNodes(const ItemEntry &item) const {
+        std::vector<u64> nodes;
+        std::vector<const ItemEntry *> stack{&item};
+
+        while (!stack.empty()) {
+            const ItemEntry *entry = stack.back();
+            stack.pop_back();
+
+            if (entry->_leftLength != 0) {
+                const ItemEntry *left =
+                    findItem(itemId(entry->_leftHash, entry->_leftLength));
+
+                if (left == nullptr) {
+                    return {};
+                }
+                stack.push_back(left);
+            }
+
+            if (entry->_rightLength == 0) {
+                nodes.push_back(entry->_rightHash);
+            } else {
+                const ItemEntry *right =
+                    findItem(itemId(entry->_rightHash, entry->_rightLength));
+
+                if (right == nullptr) {
+                    return {};
+                }
+                stack.push_back(right);
+            }
+        }
+        return nodes;
+    }
+
+    /** Begins a new generation if the current one is full. The entries of
+     * the previous generation which are still referenced by the current
+     * generation are kept, the others are forgotten. */
+    void checkGeneration() {
+        if (_current.size() < _capacity / 2) {
+            return;
+        }
+
+        std::vector<ItemEntry> stack;
+
+        for (const auto &item : _current._items) {
+            stack.push_back(item.second);
+        }
+
+        while (!stack.empty()) {
+            const ItemEntry entry = stack.back();
+            stack.pop_back();
+
+            if (entry._leftLength != 0) {
+                retainItem(itemId(entry._leftHash, entry._leftLength), stack);
+            }
+
+            if (entry._rightLength == 0) {
+                retainNode(entry._rightHash);
+            } else {
+                retainItem(itemId(entry._rightHash, entry._rightLength),
+                           stack);
+            }
+        }
+
+        _previous = std::move(_current);
+        _current = KeyGeneration();
+        ++_generation;
+    }
+
+    void retainItem(u64 id, std::vector<ItemEntry> &stack) {
+        auto it = _previous._items.find(id);
+
+        if (it != _previous._items.end()) {
+            stack.push_back(it->second);
+            _current._items.insert(*it);
+            _previous._items.erase(it);
+        }
+    }
+
+    void retainNode(u64 hash) {
+        auto it = _previous._nodes.find(hash);
+
+        if (it != _previous._nodes.end()) {
+            _current._nodes.insert(std::move(*it));
+            _previous._nodes.erase(it);
+        }
+    }
+};
+
+} // namespace
+
+// ----- KeyRegistry
+
+void KeyRegistry::setCapacity(size_t capacity) {
+    KeyTable::get().setCapacity(capacity);
+}
+
+size_t KeyRegistry::getCapacity() { return KeyTable::get().getCapacity(); }
+
+size_t KeyRegistry::size() { return KeyTable::get().size(); }
+
+// ----- NodeKey
+
+NodeKey::NodeKey(const std::string &content)
+        : NodeKey(content.data(), content.size()) {}
+
+NodeKey::NodeKey(const char *content) : NodeKey(content, strlen(content)) {}
+
+NodeKey::NodeKey(const char *data, size_t size)
+        : _hash(hashContent(data, size)) {
+    if (_hash != 0) {
+        KeyTable::get().addNode(_hash, data, size);
+    }
+}
+
+std::string NodeKey::str() const {
+    return _hash == 0 ? std::string() : KeyTable::get().getNode(_hash);
+}
+
 NodeKey NodeKeys::fromUint(unsigned int id) { return std::to_string(id); }
 
 NodeKey NodeKeys::fromInt(int id) { return std::to_string(id); }
 
 std::string NodeKeys::toString(const world::NodeKey &key) {
     std::stringstream stream;
-    for (char c : key) {
+    for (char c : key.str()) {
         auto cint = static_cast<uint32_t>(static_cast<uint8_t>(c));
         stream << std::setfill('0') << std::setw(2) << std::hex << cint;
     }
@@ -22,7 +391,7 @@ std::string NodeKeys::toString(const world::NodeKey &key) {
 }
 
 NodeKey NodeKeys::fromString(const std::string &str) {
-    NodeKey result(str.length() / 2, 0);
+    std::string result(str.length() / 2, 0);
 
     for (size_t i = 0; i < result.length(); ++i) {
         try {
@@ -36,4 +405,127 @@ NodeKey NodeKeys::fromString(const std::string &str) {
     return result;
 }
 
-} // namespace world
\ No newline at end of file
+// ----- ItemKey
+
+ItemKey::ItemKey(const std::vector<NodeKey> &components) {
+    for (const NodeKey &component : components) {
+        *this = {*this, component};
+    }
+}
+
+ItemKey::ItemKey(const ItemKey &parent, const NodeKey &key)
+        : _hash(parent._hash * PATH_FACTOR + key.hash()),
+          _length(parent._length + 1) {
+
+    if (_length == 1) {
+        KeyTable::get().addItem(itemId(_hash, _length),
+                                   {0, 0, key.hash(), 0});
+    } else {
+        KeyTable::get().addItem(
+            itemId(_hash, _length),
+            {parent._hash, parent._length, key.hash(), 0});
+    }
+}
+
+ItemKey::ItemKey(const ItemKey &key1, const ItemKey &key2)
+        : _hash(key1._hash * pathFactor(key2._length) + key2._hash),
+          _length(key1._length + key2._length) {
+
+    if (key1._length != 0 && key2._length != 0) {
+        KeyTable::get().addItem(itemId(_hash, _length),
+                                   {key1._hash, key1._length, key2._hash,
+                                    key2._length});
+    }
+}
+
+std::vector<NodeKey> ItemKey::components() const {
+    std::vector<NodeKey> result;
+    result.reserve(_length);
+
+    // Depth-first traversal of the concatenations from the right, the nodes
+    // are then reversed
+    std::vector<ItemKey> stack{*this};
+
+    while (!stack.empty()) {
+        ItemKey current = stack.back();
+        stack.pop_back();
+
+        if (current._length == 0) {
+            continue;
+        }
+
+        ItemEntry entry =
+            KeyTable::get().getItem(itemId(current._hash, current._length));
+
+        ItemKey left;
+        left._hash = entry._leftHash;
+        left._length = entry._leftLength;
+        stack.push_back(left);
+
+        if (entry._rightLength == 0) {
+            // The right side is a single node
+            NodeKey node;
+            node._hash = entry._rightHash;
+            result.push_back(node);
+        } else {
+            ItemKey right;
+            right._hash = entry._rightHash;
+            right._length = entry._rightLength;
+            stack.push_back(right);
+        }
+    }
+
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+std::string ItemKey::str() const {
+    std::string result;
+    std::vector<NodeKey> nodes = components();
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        result += (i == 0 ? "" : "/") + NodeKeys::toString(nodes[i]);
+    }
+    return result;
+}
+
+ItemKey ItemKey::parent() const {
+    if (_length == 0) {
+        throw std::runtime_error("no parent");
+    }
+
+    ItemEntry entry = KeyTable::get().getItem(itemId(_hash, _length));
+    ItemKey left;
+    left._hash = entry._leftHash;
+    left._length = entry._leftLength;
+
+    if (entry._rightLength <= 1) {
+        return left;
+    }
+
+    ItemKey right;
+    right._hash = entry._rightHash;
+    right._length = entry._rightLength;
+    return {left, right.parent()};
+}
+
+NodeKey ItemKey::last() const {
+    if (_length == 0) {
+        throw std::runtime_error("no last node");
+    }
+
+    ItemEntry entry = KeyTable::get().getItem(itemId(_hash, _length));
+
+    if (entry._rightLength == 0) {
+        NodeKey node;
+        node._hash = entry._rightHash;
+        return node;
+    }
+
+    ItemKey right;
+    right._hash = entry._rightHash;
+    right._length = entry._rightLength;
+    return right.last();
+}
+
+} // namespace world
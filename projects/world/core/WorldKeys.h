@@ -3,16 +3,77 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <functional>
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "WorldTypes.h"
+
 namespace world {
 
-typedef std::string NodeKey;
+/** The content of the keys is registered once in a global table, so that
+ * keys can be copied and compared without any allocation, and still be
+ * printed and decomposed.
+ *
+ * To keep its memory bounded, the table is split in generations. When the
+ * keys registered in the current generation reach half of the capacity, a
+ * new generation begins, and the keys of the generation before are
+ * forgotten, except the ones used by the keys of the current generation. A
+ * key is thus available as long as it, or a key built from it, has been
+ * created recently. The capacity should be larger than twice the number of
+ * keys created by a collect.
+ *
+ * The table reports its memory usage to MemoryRegistry as "KeyRegistry".
+ * In debug builds, it also checks that two different keys never have the
+ * same hash. */
+struct WORLDAPI_EXPORT KeyRegistry {
+    /** Set the maximum number of keys in the table, 2^18 by default. */
+    static void setCapacity(size_t capacity);
+
+    static size_t getCapacity();
+
+    /** Get the number of node keys and item keys in the table. */
+    static size_t size();
+};
+
+/** Identifier of a node among the children of its parent. A NodeKey is
+ * interned: it only stores a 64-bit hash of its content, and the content is
+ * registered in the KeyRegistry. The content can still be retrieved with
+ * #str. */
+class WORLDAPI_EXPORT NodeKey {
+public:
+    NodeKey() = default;
+
+    NodeKey(const std::string &content);
+
+    NodeKey(const char *content);
+
+    /** Creates a key from binary content. */
+    NodeKey(const char *data, size_t size);
+
+    u64 hash() const { return _hash; }
+
+    /** Get the content of the key. Requires a lookup in the KeyRegistry,
+     * so it should only be used to export keys. Returns an empty string if
+     * the key has been forgotten by the registry. */
+    std::string str() const;
+
+    bool operator==(const NodeKey &other) const { return _hash == other._hash; }
+
+    bool operator!=(const NodeKey &other) const { return _hash != other._hash; }
+
+    bool operator<(const NodeKey &other) const { return _hash < other._hash; }
+
+private:
+    /// 0 if the key is empty
+    u64 _hash = 0;
+
+    friend class ItemKey;
+};
 
 struct WORLDAPI_EXPORT NodeKeys {
-    static NodeKey none() { return std::string(""); }
+    static NodeKey none() { return NodeKey(); }
 
     static NodeKey fromUint(unsigned int id);
     static NodeKey fromInt(int id);
@@ -22,61 +83,61 @@ struct WORLDAPI_EXPORT NodeKeys {
 };
 
 
+/** A path of NodeKeys, referencing an item in the world hierarchy. Like
+ * NodeKey, an ItemKey is interned: it only stores a hash of the path and the
+ * number of nodes in the path. Appending a node or concatenating two keys is
+ * done in constant time, without any allocation once the resulting key has
+ * been seen.
+ *
+ * Two keys are considered equal when their hashes and lengths are equal.
+ * The order of the keys is unspecified but stable.
+ *
+ * #components, #str, #parent and #last decompose the key with the
+ * KeyRegistry, and throw std::runtime_error if the key has been forgotten
+ * by the registry. */
 class WORLDAPI_EXPORT ItemKey {
 public:
-    std::vector<NodeKey> _components;
-
-
     ItemKey() = default;
 
-    explicit ItemKey(const std::vector<NodeKey> &components)
-            : _components(components) {}
+    explicit ItemKey(const std::vector<NodeKey> &components);
 
-    ItemKey(const NodeKey &key) { _components.push_back(key); }
-    ItemKey(const ItemKey &parent, const NodeKey &key)
-            : _components(parent._components) {
+    ItemKey(const NodeKey &key) : ItemKey(ItemKey(), key) {}
 
-        _components.push_back(key);
-    }
+    ItemKey(const ItemKey &parent, const NodeKey &key);
 
-    ItemKey(const ItemKey &key1, const ItemKey &key2)
-            : _components(key1._components) {
+    ItemKey(const ItemKey &key1, const ItemKey &key2);
 
-        _components.insert(_components.end(), key2._components.begin(),
-                           key2._components.end());
-    }
+    u64 hash() const { return _hash; }
 
-    std::string str() const {
-        std::string result;
-        for (size_t i = 0; i < _components.size(); ++i) {
-            result += (i == 0 ? "" : "/") + NodeKeys::toString(_components[i]);
-        }
-        return result;
-    }
+    /** Get the number of nodes in the path. */
+    u32 length() const { return _length; }
 
-    ItemKey parent() const {
-        if (_components.empty()) {
-            throw std::runtime_error("no parent");
-        }
+    /** Get all the nodes of the path, from the root to the last node. */
+    std::vector<NodeKey> components() const;
 
-        ItemKey result = *this;
-        result._components.pop_back();
-        return result;
-    }
+    /** Get a printable representation of the key, which can be converted back
+     * to the key with ItemKeys::fromString. This method should only be used to
+     * export keys, as it builds the whole path. */
+    std::string str() const;
+
+    ItemKey parent() const;
 
-    NodeKey last() const { return _components.back(); }
+    NodeKey last() const;
 
     bool operator==(const ItemKey &other) const {
-        return _components == other._components;
+        return _hash == other._hash && _length == other._length;
     }
 
-    bool operator!=(const ItemKey &other) const {
-        return _components != other._components;
-    }
+    bool operator!=(const ItemKey &other) const { return !(*this == other); }
 
     bool operator<(const ItemKey &other) const {
-        return _components < other._components;
+        return _hash < other._hash ||
+               (_hash == other._hash && _length < other._length);
     }
+
+private:
+    u64 _hash = 0;
+    u32 _length = 0;
 };
 
 struct WORLDAPI_EXPORT ItemKeys {
@@ -116,7 +177,7 @@ struct WORLDAPI_EXPORT ItemKeys {
             }
 
             try {
-                result._components.push_back(NodeKeys::fromString(keystr));
+                result = {result, NodeKeys::fromString(keystr)};
             } catch (std::invalid_argument &e) {
                 throw e;
             }
@@ -138,6 +199,25 @@ inline ItemKey key(const std::string &str) {
     }
 }
 
+/** Seeds derived from keys do not depend on the platform. */
+inline u64 seedValue(const NodeKey &key) { return key.hash(); }
+
+inline u64 seedValue(const ItemKey &key) { return key.hash() ^ key.length(); }
+
 } // namespace world
 
+namespace std {
+template <> struct hash<world::NodeKey> {
+    size_t operator()(const world::NodeKey &key) const {
+        return static_cast<size_t>(key.hash());
+    }
+};
+
+template <> struct hash<world::ItemKey> {
+    size_t operator()(const world::ItemKey &key) const {
+        return static_cast<size_t>(key.hash() ^ key.length());
+    }
+};
+} // namespace std
+
 #endif // WORLD_WORLDKEYS_H
@@ -58,6 +58,24 @@ void WorldNode::removeChild(WorldNode &child) {
     _internal->_children.erase(child._key);
 }
 
+size_t WorldNode::getMemoryUsage() const {
+    size_t bytes = 0;
+
+    for (auto &entry : _internal->_children) {
+        bytes += sizeof(*entry.second) + entry.second->getMemoryUsage();
+    }
+    return bytes;
+}
+
+size_t WorldNode::getAsyncGenerationCount() const {
+    size_t count = 0;
+
+    for (auto &entry : _internal->_children) {
+        count += entry.second->getAsyncGenerationCount();
+    }
+    return count;
+}
+
 void WorldNode::addChildInternal(WorldNode *node) {
     NodeKey key = NodeKeys::fromInt(_internal->_counter);
     _internal->_children.emplace(key, std::unique_ptr<WorldNode>(node));
@@ -50,6 +50,17 @@ public:
 
     void removeChild(WorldNode &child);
 
+    /** Get an estimate of the number of bytes used by the node and its
+     * children. The default implementation sums the memory used by the
+     * children. */
+    virtual size_t getMemoryUsage() const;
+
+    /** Get the number of parts of the node and of its children generated in
+     * background since their creation (see World::setAsyncCollect).
+     * Collecting again is only useful once this number changed. The default
+     * implementation sums the counts of the children. */
+    virtual size_t getAsyncGenerationCount() const;
+
 protected:
     WorldNodePrivate *_internal;
 
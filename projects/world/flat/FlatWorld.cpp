@@ -9,6 +9,7 @@
 #include "world/nature/Rocks.h"
 #include "world/core/Profiler.h"
 #include "world/core/SeedDistribution.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -24,6 +25,8 @@ FlatWorld *FlatWorld::createDemoFlatWorld() {
 
     HeightmapGround &ground = world->setGround<HeightmapGround>();
     ground.setDefaultWorkerSet();
+    ground.setThreadCount(0);
+    ground.setTerrainStorage(TerrainStorage::UINT16);
 
     auto &chunkSystem = world->addPrimaryNode<GridChunkSystem>({0, 0, 0});
     chunkSystem.addDecorator<ForestLayer>(world);
@@ -59,9 +62,24 @@ FlatWorld::~FlatWorld() { delete _internal; }
 
 IGround &FlatWorld::ground() { return *_internal->_ground; }
 
+void FlatWorld::setCache(std::shared_ptr<ICache> cache) {
+    World::setCache(cache);
+    auto *ground = dynamic_cast<HeightmapGround *>(_internal->_ground.get());
+
+    if (ground != nullptr) {
+        ground->setCache(cache);
+    }
+}
+
+size_t FlatWorld::getAsyncGenerationCount() const {
+    return _internal->_ground->getAsyncGenerationCount() +
+           World::getAsyncGenerationCount();
+}
+
 void FlatWorld::collect(ICollector &collector,
                         const IResolutionModel &resolutionModel) {
-    _internal->_ground->collect(collector, resolutionModel);
+    ExplorationContext ctx = getInitialContext();
+    _internal->_ground->collect(collector, resolutionModel, ctx);
     World::collect(collector, resolutionModel);
 }
 
@@ -76,8 +94,26 @@ vec3d FlatWorld::findNearestFreePoint(const vec3d &origin,
 
 IEnvironment *FlatWorld::getInitialEnvironment() { return this; }
 
+void FlatWorld::setSeed(u64 seed) {
+    World::setSeed(seed);
+    auto *ground = dynamic_cast<HeightmapGround *>(_internal->_ground.get());
+
+    if (ground != nullptr) {
+        ground->setSeed(deriveSeed(seed, "ground"));
+    }
+}
+
 void FlatWorld::setGroundInternal(GroundNode *ground) {
     _internal->_ground = std::unique_ptr<GroundNode>(ground);
+    auto *heightmapGround = dynamic_cast<HeightmapGround *>(ground);
+
+    if (heightmapGround != nullptr) {
+        heightmapGround->setSeed(deriveSeed(getSeed(), "ground"));
+
+        if (getCache()) {
+            heightmapGround->setCache(getCache());
+        }
+    }
 }
 
 } // namespace world
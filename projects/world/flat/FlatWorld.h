@@ -23,6 +23,12 @@ public:
 
     IGround &ground();
 
+    void setCache(std::shared_ptr<ICache> cache) override;
+
+    void setSeed(u64 seed) override;
+
+    size_t getAsyncGenerationCount() const override;
+
     void collect(ICollector &collector,
                  const IResolutionModel &resolutionModel) override;
 
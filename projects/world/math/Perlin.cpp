@@ -3,12 +3,18 @@
 #include <armadillo/armadillo>
 #include <math.h>
 #include <stdlib.h>
-#include <time.h>
 #include <algorithm>
 #include <functional>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 #include "MathsHelper.h"
 #include "Interpolation.h"
+#include "RandomStream.h"
 
 using namespace arma;
 
@@ -16,7 +22,7 @@ namespace world {
 
 using namespace perlin;
 
-Perlin::modifier Perlin::DEFAULT_MODIFIER = [&](double, double, double val) {
+Perlin::modifier Perlin::DEFAULT_MODIFIER = [](double, double, double val) {
     return val;
 };
 
@@ -53,14 +59,20 @@ double getOffsetf(int offset, int octave, const PerlinInfo &info) {
     return rawOffset - floor(rawOffset);
 }
 
-Perlin::Perlin() : Perlin::Perlin(static_cast<long>(time(NULL))) {}
+Perlin::Perlin() : Perlin::Perlin(DEFAULT_SEED) {}
 
-Perlin::Perlin(long seed) : _rng(seed) {
+Perlin::Perlin(u64 seed) {
     for (u32 i = 0; i < 256; ++i) {
         _hash[i] = static_cast<u8>(i);
     }
 
-    std::shuffle(std::begin(_hash), std::begin(_hash) + 256, _rng);
+    // Fisher-Yates shuffle. std::shuffle is not used because its result
+    // depends on the implementation of the standard library.
+    RandomStream rng(seed);
+
+    for (u32 i = 255; i > 0; --i) {
+        std::swap(_hash[i], _hash[rng() % (i + 1)]);
+    }
 
     for (u32 i = 0; i < 256; ++i) {
         _hash[i + 256] = _hash[i];
@@ -87,76 +99,173 @@ double Perlin::getMaxPossibleValue(const PerlinInfo &info) {
     return persistenceSum;
 }
 
-void Perlin::growBuffer(arma::uword size) {
-    if (_buffer.n_rows < size) {
-        _buffer = arma::mat(size, size);
-    }
-}
-
-void Perlin::fillBuffer(int octave, const PerlinInfo &info,
-                        const modifier &sourceModifier) {
+void Perlin::fillBuffer(arma::mat &buffer, int octave, const PerlinInfo &info,
+                        const modifier &sourceModifier, int pad) const {
 
     double localFreq = info.frequency * powi(2., octave);
-    uword fi = static_cast<uword>(ceil(localFreq));
-    growBuffer(fi + 1);
+    int fi = static_cast<int>(ceil(localFreq));
+    uword size = static_cast<uword>(fi + 1 + 2 * pad);
+
+    if (buffer.n_rows < size) {
+        buffer = arma::mat(size, size);
+    }
 
     int offX = getOffset(info.offsetX, octave, info);
     int offY = getOffset(info.offsetY, octave, info);
 
-    // Fill buffer
-    for (u32 x = 0; x <= fi; x++) {
-        for (u32 y = 0; y <= fi; y++) {
+    // Fill buffer, the point (x, y) of the noise is at (x + pad, y + pad)
+    for (int x = -pad; x <= fi + pad; x++) {
+        for (int y = -pad; y <= fi + pad; y++) {
             u32 px = static_cast<u32>(x + offX) & 0xFFu;
             u32 py = static_cast<u32>(y + offY) & 0xFFu;
             double val = _hash[px + _hash[py + _hash[octave]]] / 255.;
 
-            if (info.repeatable) {
+            if (info.repeatable && pad == 0) {
                 if (x == fi) {
-                    val = _buffer(0, y);
+                    val = buffer(0, y);
                 } else if (y == fi) {
-                    val = _buffer(x, 0);
+                    val = buffer(x, 0);
                 }
             }
 
-            _buffer(x, y) = sourceModifier((double)x / fi, (double)y / fi, val);
+            buffer(x + pad, y + pad) =
+                sourceModifier((double)x / fi, (double)y / fi, val);
         }
     }
 }
 
-void Perlin::generatePerlinOctave(arma::Mat<double> &output, int octave,
-                                  const PerlinInfo &info,
-                                  const modifier &sourceModifier) {
+/** Interpolation bounds and weights of each output row (or column) on the
+ * perlin buffer of one octave. Points with the same bounds are grouped in
+ * spans. */
+struct OctaveAxis {
+    std::vector<u32> _lower;
+    std::vector<u32> _upper;
+    /** Interpolation weight of the upper bound */
+    std::vector<double> _weight;
+    /** Interpolation weight of the lower bound */
+    std::vector<double> _weightComp;
+    /** Span i covers [_spanStart[i], _spanStart[i + 1]) */
+    std::vector<u32> _spanStart;
+
+    /** @param border number of points outside of the noise area on each
+     * side
+     * @param pad offset of the noise points in the buffer */
+    void compute(uword count, double f, double offset, int border, int pad) {
+        _lower.resize(count);
+        _upper.resize(count);
+        _weight.resize(count);
+        _weightComp.resize(count);
+        _spanStart.clear();
+
+        for (uword i = 0; i < count; ++i) {
+            double d =
+                f * (double(i) - border) / (count - 1 - 2 * border) + offset;
+            double lower = floor(d);
+            _lower[i] = static_cast<u32>(lower + pad);
+            _upper[i] = static_cast<u32>(ceil(d) + pad);
+
+            // Same computation as Interpolation::interpolateCosine
+            double w = 0;
+            if (_upper[i] != _lower[i]) {
+                w = Interpolation::COSINE(clamp(d - lower, 0, 1));
+            }
+            _weight[i] = w;
+            _weightComp[i] = 1 - w;
 
-    fillBuffer(octave, info, sourceModifier);
+            if (i == 0 || _lower[i] != _lower[i - 1] ||
+                _upper[i] != _upper[i - 1]) {
+                _spanStart.push_back(static_cast<u32>(i));
+            }
+        }
+        _spanStart.push_back(static_cast<u32>(count));
+    }
+};
+
+/** out[i] += (upper * weight[i] + lower * weightComp[i]) * coef */
+inline void accumulateSpan(double *out, const double *weight,
+                           const double *weightComp, double upper,
+                           double lower, double coef, size_t count) {
+    size_t i = 0;
+#if defined(__AVX__)
+    const __m256d up4 = _mm256_set1_pd(upper);
+    const __m256d lo4 = _mm256_set1_pd(lower);
+    const __m256d coef4 = _mm256_set1_pd(coef);
+
+    for (; i + 4 <= count; i += 4) {
+        __m256d v = _mm256_add_pd(
+            _mm256_mul_pd(up4, _mm256_loadu_pd(weight + i)),
+            _mm256_mul_pd(lo4, _mm256_loadu_pd(weightComp + i)));
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(out + i),
+                                                _mm256_mul_pd(v, coef4)));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128d up2 = _mm_set1_pd(upper);
+    const __m128d lo2 = _mm_set1_pd(lower);
+    const __m128d coef2 = _mm_set1_pd(coef);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128d v = _mm_add_pd(_mm_mul_pd(up2, _mm_loadu_pd(weight + i)),
+                               _mm_mul_pd(lo2, _mm_loadu_pd(weightComp + i)));
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(out + i),
+                                          _mm_mul_pd(v, coef2)));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] += (upper * weight[i] + lower * weightComp[i]) * coef;
+    }
+}
+
+/** Add the row y of an octave multiplied by coef to out. */
+void accumulateOctaveRow(const arma::mat &buffer, const OctaveAxis &axisX,
+                         const OctaveAxis &axisY, uword y, double coef,
+                         double *out) {
+    const double *lowerCol = buffer.colptr(axisY._lower[y]);
+    const double *upperCol = buffer.colptr(axisY._upper[y]);
+    const double wy = axisY._weight[y];
+    const double wyComp = axisY._weightComp[y];
+
+    // Only the buffer points at the bounds of the spans are interpolated
+    // along y
+    for (size_t s = 0; s + 1 < axisX._spanStart.size(); ++s) {
+        const u32 start = axisX._spanStart[s];
+        const u32 end = axisX._spanStart[s + 1];
+        const u32 upper = axisX._upper[start];
+        const u32 lower = axisX._lower[start];
+
+        accumulateSpan(out + start, &axisX._weight[start],
+                       &axisX._weightComp[start],
+                       upperCol[upper] * wy + lowerCol[upper] * wyComp,
+                       upperCol[lower] * wy + lowerCol[lower] * wyComp, coef,
+                       end - start);
+    }
+}
+
+/** Number of noise points needed around the noise area for the border */
+int getPad(const PerlinInfo &info, double f, uword count) {
+    const int border = info.border;
+    return static_cast<int>(ceil(border * f / (count - 1 - 2 * border)));
+}
+
+void Perlin::accumulatePerlinOctave(arma::Mat<double> &output,
+                                    arma::mat &buffer, int octave, double coef,
+                                    const PerlinInfo &info,
+                                    const modifier &sourceModifier) const {
 
     const double f = info.frequency * powi(2., octave - info.reference);
     const double offXf = getOffsetf(info.offsetX, octave, info);
     const double offYf = getOffsetf(info.offsetY, octave, info);
 
-    // Build octave
-    for (u32 x = 0; x < output.n_rows; x++) {
-        for (u32 y = 0; y < output.n_cols; y++) {
-            double xd = f * x / (output.n_rows - 1) + offXf;
-            double yd = f * y / (output.n_cols - 1) + offYf;
-
-            // Bounds
-            int borneX1 = static_cast<int>(floor(xd));
-            int borneY1 = static_cast<int>(floor(yd));
-            int borneX2 = static_cast<int>(ceil(xd));
-            int borneY2 = static_cast<int>(ceil(yd));
-
-            // Interpolation
-            double v1 = Interpolation::interpolateCosine(
-                borneX1, _buffer(borneX1, borneY1), borneX2,
-                _buffer(borneX2, borneY1), xd);
-
-            double v2 = Interpolation::interpolateCosine(
-                borneX1, _buffer(borneX1, borneY2), borneX2,
-                _buffer(borneX2, borneY2), xd);
-
-            output(x, y) =
-                Interpolation::interpolateCosine(borneY1, v1, borneY2, v2, yd);
-        }
+    const int pad = getPad(info, f, output.n_rows);
+    fillBuffer(buffer, octave, info, sourceModifier, pad);
+
+    OctaveAxis axisX, axisY;
+    axisX.compute(output.n_rows, f, offXf, info.border, pad);
+    axisY.compute(output.n_cols, f, offYf, info.border, pad);
+
+    // Arma matrices are column major: the inner loops run along x so that
+    // memory is accessed contiguously.
+    for (uword y = 0; y < output.n_cols; ++y) {
+        accumulateOctaveRow(buffer, axisX, axisY, y, coef, output.colptr(y));
     }
 }
 
@@ -168,18 +277,16 @@ void Perlin::generatePerlinNoise2D(arma::Mat<double> &output,
 void Perlin::generatePerlinNoise2D(Mat<double> &output, const PerlinInfo &info,
                                    const modifier &sourceModifier) {
 
-    // Dtermination de la taille de la matrice
-    const uword size = std::min(output.n_rows, output.n_cols);
-
     output.fill(0);
 
     std::vector<double> coefs =
         getCoefs(info.octaves, info.persistence, _normalize);
 
-    Mat<double> octave(size, size);
+    arma::mat buffer;
+
     for (int i = 0; i < info.octaves; i++) {
-        generatePerlinOctave(octave, i, info, sourceModifier);
-        output += octave * coefs[i];
+        accumulatePerlinOctave(output, buffer, i, coefs[i], info,
+                               sourceModifier);
     }
 }
 
@@ -190,4 +297,98 @@ Mat<double> Perlin::generatePerlinNoise2D(int size, const PerlinInfo &info) {
     return result;
 }
 
-} // namespace world
\ No newline at end of file
+double Perlin::getValue(double x, double y, const PerlinInfo &info) const {
+    double persistenceSum = 0;
+
+    for (int i = 0; i < info.octaves; i++) {
+        persistenceSum += pow(info.persistence, i);
+    }
+
+    double value = 0;
+
+    for (int i = 0; i < info.octaves; i++) {
+        const double f = info.frequency * powi(2., i - info.reference);
+        const double dx = f * x + getOffsetf(info.offsetX, i, info);
+        const double dy = f * y + getOffsetf(info.offsetY, i, info);
+        const int offX = getOffset(info.offsetX, i, info);
+        const int offY = getOffset(info.offsetY, i, info);
+        const int x0 = static_cast<int>(floor(dx));
+        const int y0 = static_cast<int>(floor(dy));
+
+        // Same values as in fillBuffer
+        auto point = [&](int px, int py) {
+            u32 hx = static_cast<u32>(px + offX) & 0xFFu;
+            u32 hy = static_cast<u32>(py + offY) & 0xFFu;
+            return _hash[hx + _hash[hy + _hash[i]]] / 255.;
+        };
+
+        const double wx = Interpolation::COSINE(dx - x0);
+        const double wy = Interpolation::COSINE(dy - y0);
+        const double lower =
+            point(x0, y0) * (1 - wx) + point(x0 + 1, y0) * wx;
+        const double upper =
+            point(x0, y0 + 1) * (1 - wx) + point(x0 + 1, y0 + 1) * wx;
+
+        double coef = pow(info.persistence, i);
+
+        if (_normalize) {
+            coef /= persistenceSum;
+        }
+        value += (lower * (1 - wy) + upper * wy) * coef;
+    }
+    return value;
+}
+
+// ==== PerlinRows
+
+struct PerlinOctave {
+    arma::mat _buffer;
+    OctaveAxis _axisX;
+    OctaveAxis _axisY;
+    double _coef;
+};
+
+class PPerlinRows {
+public:
+    std::vector<PerlinOctave> _octaves;
+    int _width;
+};
+
+PerlinRows::PerlinRows(const Perlin &perlin, const PerlinInfo &info,
+                       int width, int height)
+        : _internal(std::make_unique<PPerlinRows>()) {
+    std::vector<double> coefs =
+        getCoefs(info.octaves, info.persistence, perlin._normalize);
+    _internal->_width = width;
+    _internal->_octaves.resize(info.octaves);
+
+    for (int i = 0; i < info.octaves; ++i) {
+        PerlinOctave &octave = _internal->_octaves[i];
+        const double f = info.frequency * powi(2., i - info.reference);
+        const int pad = getPad(info, f, uword(width));
+
+        perlin.fillBuffer(octave._buffer, i, info, Perlin::DEFAULT_MODIFIER,
+                          pad);
+        octave._axisX.compute(uword(width), f,
+                              getOffsetf(info.offsetX, i, info), info.border,
+                              pad);
+        octave._axisY.compute(uword(height), f,
+                              getOffsetf(info.offsetY, i, info), info.border,
+                              pad);
+        octave._coef = coefs[i];
+    }
+}
+
+PerlinRows::PerlinRows(PerlinRows &&rows) = default;
+
+PerlinRows::~PerlinRows() = default;
+
+void PerlinRows::generateRow(int y, double *out) const {
+    std::fill(out, out + _internal->_width, 0.);
+
+    for (const PerlinOctave &octave : _internal->_octaves) {
+        accumulateOctaveRow(octave._buffer, octave._axisX, octave._axisY,
+                            uword(y), octave._coef, out);
+    }
+}
+} // namespace world
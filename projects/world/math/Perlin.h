@@ -3,7 +3,7 @@
 #include "world/core/WorldConfig.h"
 
 #include <functional>
-#include <random>
+#include <memory>
 
 #include <armadillo/armadillo>
 
@@ -39,17 +39,28 @@ struct WORLDAPI_EXPORT PerlinInfo {
      * (if the frequency is n, then the number of interpolation points on
      * the reference octave is n) */
     int offsetY;
+    /** Number of points on each side of the output that are outside of the
+     * noise area. These points continue the noise, so that they are equal
+     * to the points of the neighbouring areas at the same position. Not
+     * supported with repeatable noise. */
+    int border = 0;
 };
 
+class PPerlinRows;
+
 class WORLDAPI_EXPORT Perlin {
 public:
     typedef std::function<double(double, double, double)> modifier;
 
     static modifier DEFAULT_MODIFIER;
 
+    /** Creates a perlin generator with the default seed. */
     Perlin();
 
-    Perlin(long seed);
+    /** Creates a perlin generator whose permutation table is shuffled
+     * according to the given seed. The same seed gives the same noise on
+     * every platform. */
+    explicit Perlin(u64 seed);
 
     void setNormalize(bool normalize);
 
@@ -63,6 +74,9 @@ public:
      * custom normalization. */
     double getMaxPossibleValue(const PerlinInfo &info);
 
+    /** Fill the output with perlin noise. This method does not modify the
+     * state of this object, so it can be called from several threads at the
+     * same time. */
     void generatePerlinNoise2D(arma::Mat<double> &output,
                                const PerlinInfo &info);
 
@@ -72,6 +86,13 @@ public:
 
     arma::Mat<double> generatePerlinNoise2D(int size, const PerlinInfo &info);
 
+    /** Compute the noise at a single point, without generating the whole
+     * noise area. x and y are the coordinates of the point in the noise
+     * area, between 0 and 1 (values outside continue the noise like the
+     * border). The result is the same as the one of generatePerlinNoise2D
+     * at the points of its output. The repeatable parameter is ignored. */
+    double getValue(double x, double y, const PerlinInfo &info) const;
+
     std::vector<u8> getHash() const;
 
 private:
@@ -79,19 +100,44 @@ private:
     bool _normalize = true;
 
     // Internal fields
-    std::mt19937 _rng;
     u8 _hash[512];
 
-    // Buffer for perlin points
-    arma::mat _buffer;
+    friend class PerlinRows;
 
-    void growBuffer(arma::uword size);
+    /** Fill the buffer with the perlin points of the given octave, and pad
+     * more points on each side. The buffer is grown if needed. */
+    void fillBuffer(arma::mat &buffer, int octave, const PerlinInfo &info,
+                    const modifier &sourceModifier, int pad) const;
 
-    void fillBuffer(int octave, const PerlinInfo &info,
-                    const modifier &sourceModifier);
+    /** Add the given octave multiplied by coef to the output. The octave
+     * is interpolated along y on the buffer columns, then along x directly
+     * into the output. */
+    void accumulatePerlinOctave(arma::Mat<double> &output, arma::mat &buffer,
+                                int octave, double coef,
+                                const PerlinInfo &info,
+                                const modifier &sourceModifier) const;
+};
+
+/** Generates perlin noise one row at a time, for example to process each
+ * row further while it is still in the cache. The rows are exactly the
+ * columns of the output of Perlin::generatePerlinNoise2D with the same
+ * parameters. Only the perlin points and the interpolation tables of each
+ * octave are kept in memory. */
+class WORLDAPI_EXPORT PerlinRows {
+public:
+    PerlinRows(const Perlin &perlin, const PerlinInfo &info, int width,
+               int height);
 
-    void generatePerlinOctave(arma::Mat<double> &output, int octave,
-                              const PerlinInfo &info,
-                              const modifier &sourceModifier);
+    PerlinRows(PerlinRows &&rows);
+
+    ~PerlinRows();
+
+    /** Write the row y of the noise in out, which must hold width
+     * values. This method can be called from several threads at the same
+     * time. */
+    void generateRow(int y, double *out) const;
+
+private:
+    std::unique_ptr<PPerlinRows> _internal;
 };
 } // namespace world
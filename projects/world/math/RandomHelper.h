@@ -13,7 +13,9 @@ namespace world {
  * more often. */
 template <class RNG>
 inline double randScale(RNG &rng, double value, double e = 1.05) {
-    static std::normal_distribution<double> distribution;
+    // Not static: the normal distribution keeps a cached value, which would
+    // make the result depend on the previous calls.
+    std::normal_distribution<double> distribution;
     return value * pow(e, distribution(rng));
 }
 
@@ -27,7 +29,7 @@ inline std::exponential_distribution<double> exponentialDistribFromMedian(
  * nearest integer. ie 3.75 will have 75% chance to be rounded to 4,
  * whereas 3.25 will have 75% being rounded to 3. */
 template <class RNG> inline int randRound(RNG &rng, double value) {
-    static std::uniform_real_distribution<double> distribution;
+    std::uniform_real_distribution<double> distribution;
     return static_cast<int>(
         value - floor(value) < distribution(rng) ? floor(value) : ceil(value));
 }
@@ -0,0 +1,152 @@
+#ifndef WORLD_RANDOM_STREAM_H
+#define WORLD_RANDOM_STREAM_H
+
+#include "world/core/WorldConfig.h"
+
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "world/core/WorldTypes.h"
+#include "Vector.h"
+
+namespace world {
+
+/** Seed of the generators when the user does not give one. */
+const u64 DEFAULT_SEED = 0x776F726C64ULL;
+
+/** Scrambles the bits of the given value (finalizer of splitmix64). Two
+ * close values give completely different results. */
+inline u64 mixBits(u64 z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** Combines a seed with a value, to get the seed of a sub-generator. */
+inline u64 mixSeed(u64 seed, u64 value) {
+    return mixBits(seed ^ mixBits(value + 0x9E3779B97F4A7C15ULL));
+}
+
+// Values that can be used to derive a seed. The result must not depend on
+// the platform, so that the same world is generated everywhere.
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value ||
+                                   std::is_enum<T>::value,
+                               u64>::type
+seedValue(const T &value) {
+    return static_cast<u64>(value);
+}
+
+inline u64 seedValue(double value) {
+    // -0.0 and 0.0 give the same seed
+    value = value + 0.0;
+    u64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline u64 seedValue(const std::string &value) {
+    // FNV-1a
+    u64 h = 0xCBF29CE484222325ULL;
+
+    for (char c : value) {
+        h = (h ^ static_cast<u8>(c)) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+inline u64 seedValue(const char *value) { return seedValue(std::string(value)); }
+
+template <typename T> inline u64 seedValue(const vec2<T> &value) {
+    return mixSeed(seedValue(value.x), seedValue(value.y));
+}
+
+template <typename T> inline u64 seedValue(const vec3<T> &value) {
+    return mixSeed(mixSeed(seedValue(value.x), seedValue(value.y)),
+                   seedValue(value.z));
+}
+
+// Other types define their own seedValue overload next to the type, for
+// example TileCoordinates. std::hash is not used, because its result
+// depends on the platform and on the standard library.
+
+inline u64 deriveSeed(u64 seed) { return seed; }
+
+/** Derives a seed from a parent seed and a list of identifiers, for example
+ * the coordinates of a tile. The same inputs always give the same seed. */
+template <typename T, typename... Args>
+inline u64 deriveSeed(u64 seed, const T &id, const Args &... ids) {
+    return deriveSeed(mixSeed(seed, seedValue(id)), ids...);
+}
+
+/** Counter-based pseudo random generator: the n-th number of a stream only
+ * depends on the key of the stream and n. Streams are cheap to create, so
+ * each tile or chunk can have its own stream derived from the world seed
+ * and its coordinates. This way the generated content does not depend on
+ * the order in which the tiles are generated, nor on the thread generating
+ * them.
+ *
+ * This class satisfies the UniformRandomBitGenerator requirements and can
+ * be used with the distributions of the standard library. */
+class WORLDAPI_EXPORT RandomStream {
+public:
+    typedef u64 result_type;
+
+    explicit RandomStream(u64 seed = DEFAULT_SEED) : _key(seed) {}
+
+    /** Creates the stream derived from the given seed and identifiers.
+     * @see deriveSeed */
+    template <typename T, typename... Args>
+    RandomStream(u64 seed, const T &id, const Args &... ids)
+            : _key(deriveSeed(seed, id, ids...)) {}
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() { return at(_counter++); }
+
+    /** Returns the n-th number of this stream, without changing the current
+     * position in the stream. */
+    result_type at(u64 n) const {
+        return mixBits(_key + (n + 1) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    void seed(u64 seed) {
+        _key = seed;
+        _counter = 0;
+    }
+
+    void discard(u64 count) { _counter += count; }
+
+    u64 getKey() const { return _key; }
+
+    u64 getCounter() const { return _counter; }
+
+    bool operator==(const RandomStream &other) const {
+        return _key == other._key && _counter == other._counter;
+    }
+
+    bool operator!=(const RandomStream &other) const {
+        return !(*this == other);
+    }
+
+    friend std::ostream &operator<<(std::ostream &stream,
+                                    const RandomStream &rng) {
+        return stream << rng._key << " " << rng._counter;
+    }
+
+private:
+    u64 _key;
+    u64 _counter = 0;
+};
+
+} // namespace world
+
+#endif // WORLD_RANDOM_STREAM_H
@@ -6,7 +6,7 @@
 
 namespace world {
 
-Lightning::Lightning() : _rng(time(NULL)){};
+Lightning::Lightning() = default;
 
 void Lightning::generateLightning(Image &img, const vec2d &from) {
     std::normal_distribution<double> angleVar(0, _angleVar);
@@ -48,7 +48,7 @@ void Lightning::generateLightning(Image &img, const vec2d &from) {
 }
 
 
-JitterLightning::JitterLightning() : _rng(time(NULL)) {}
+JitterLightning::JitterLightning() = default;
 
 void JitterLightning::generateLightning(Image &img, const vec2d &from,
                                         const vec2d &to) {
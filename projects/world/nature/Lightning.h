@@ -5,6 +5,7 @@
 #include <random>
 
 #include "world/math/Vector.h"
+#include "world/math/RandomStream.h"
 #include "world/assets/Image.h"
 
 namespace world {
@@ -13,10 +14,12 @@ class WORLDAPI_EXPORT Lightning {
 public:
     Lightning();
 
+    void setSeed(u64 seed) { _rng.seed(seed); }
+
     void generateLightning(Image &img, const vec2d &from);
 
 private:
-    std::mt19937_64 _rng;
+    RandomStream _rng;
 
     double _minStep = 3;
     double _maxStep = 20;
@@ -30,10 +33,12 @@ class WORLDAPI_EXPORT JitterLightning {
 public:
     JitterLightning();
 
+    void setSeed(u64 seed) { _rng.seed(seed); }
+
     void generateLightning(Image &img, const vec2d &from, const vec2d &to);
 
 private:
-    std::mt19937_64 _rng;
+    RandomStream _rng;
 
     double _jitterMax = 0.25;
     u32 _stepCount = 6;
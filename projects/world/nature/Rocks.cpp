@@ -5,12 +5,12 @@
 #include "world/assets/VoxelOps.h"
 
 namespace world {
-Rocks::Rocks() : _rng(time(NULL)) {}
+Rocks::Rocks() = default;
 
 void Rocks::addRock(const vec3d &position) {
-    _rocks.emplace_back();
-    generateMesh(_rocks.back().mesh);
-    _rocks.back().position = position;
+    auto mesh = std::make_shared<Mesh>();
+    generateMesh(*mesh);
+    _rocks.push_back({position, std::move(mesh)});
 }
 
 std::vector<Template> Rocks::collectTemplates(ICollector &collector,
@@ -24,7 +24,7 @@ std::vector<Template> Rocks::collectTemplates(ICollector &collector,
 
         if (collector.hasChannel<Mesh>()) {
             auto &meshChan = collector.getChannel<Mesh>();
-            meshChan.put(key, _rocks[i].mesh, ctx);
+            meshChan.putShared(key, _rocks[i].mesh, ctx);
 
             if (collector.hasChannel<Material>()) {
                 auto &matChan = collector.getChannel<Material>();
@@ -54,7 +54,7 @@ void Rocks::collectSelf(ICollector &collector,
         int i = 0;
         for (auto &rock : _rocks) {
             ItemKey key{std::to_string(i)};
-            meshChan.put(key, rock.mesh, ctx);
+            meshChan.putShared(key, rock.mesh, ctx);
 
             SceneNode obj(ctx.mutateKey(key).str());
             obj.setPosition(rock.position);
@@ -3,11 +3,13 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <memory>
 #include <random>
 
 #include "world/assets/SceneNode.h"
 #include "world/core/WorldNode.h"
 #include "world/core/IInstanceGenerator.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -19,6 +21,9 @@ public:
 
     void setRadius(double radius) { _radius = radius; }
 
+    /** Set the seed used to shape the rocks. */
+    void setSeed(u64 seed) { _rng.seed(seed); }
+
     std::vector<Template> collectTemplates(ICollector &collector,
                                            const ExplorationContext &ctx,
                                            double maxRes);
@@ -32,9 +37,10 @@ public:
 private:
     struct Rock {
         vec3d position;
-        Mesh mesh;
+        /// Shared with the collectors
+        std::shared_ptr<const Mesh> mesh;
     };
-    std::mt19937_64 _rng;
+    RandomStream _rng;
     std::vector<Rock> _rocks;
 
     double _radius = 1;
@@ -9,9 +9,12 @@
 #include "terrain/ReliefParameters.h"
 #include "terrain/Terrain.h"
 #include "terrain/TerrainOps.h"
+#include "terrain/TerrainPipeline.h"
+#include "terrain/TerrainResampler.h"
 #include "terrain/TerrainStream.h"
 #include "terrain/AltitudeTexturer.h"
 #include "terrain/SimpleTexturer.h"
+#include "terrain/MultilayerGroundTexture.h"
 #include "terrain/MapFilteredDistribution.h"
 
 // deprecated
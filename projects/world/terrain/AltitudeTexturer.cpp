@@ -1,47 +1,142 @@
 #include "AltitudeTexturer.h"
 
+#include <vector>
+
 namespace world {
 
+namespace {
+
+/** Position of each texel of an axis on the terrain grid: the index of the
+ * cell it falls in and its position in the cell, between 0 and 1. It is the
+ * same for all the texels of a row or of a column, so it is computed once
+ * per axis. */
+struct AxisSamples {
+    std::vector<int> _cell;
+    std::vector<double> _offset;
+
+    AxisSamples(int texelCount, int terrainRes)
+            : _cell(texelCount), _offset(texelCount) {
+        const int size_1 = terrainRes - 1;
+
+        for (int i = 0; i < texelCount; ++i) {
+            double t = double(i) / (texelCount - 1) * size_1;
+            _cell[i] = clamp(static_cast<int>(floor(t)), 0, size_1 - 1);
+            _offset[i] = t - _cell[i];
+        }
+    }
+};
+
+/** Gets a jitter value between -1 and 1 from 12 bits of the hash. */
+inline double jitterAt(u64 hash, int i) {
+    return ((hash >> (i * 12)) & 0xFFFu) * (2. / 0xFFF) - 1;
+}
+
+inline u8 toByte(double v) { return static_cast<u8>(clamp(v, 0, 1) * 255.0); }
+} // namespace
+
 AltitudeTexturer::AltitudeTexturer()
-        : _rng(static_cast<u32>(time(NULL))), _colorMap({513, 65}) {}
+        : _colorMap({513, 65}) {}
 
 ColorMap &AltitudeTexturer::getColorMap() { return _colorMap; }
 
 void AltitudeTexturer::processTerrain(Terrain &terrain) {
+    processTerrain(terrain,
+                   deriveSeed(_seed, terrain.getBoundingBox().getLowerBound()));
+}
+
+void AltitudeTexturer::processTile(ITileContext &context) {
+    processTerrain(context.getTile().terrain(),
+                   deriveSeed(_seed, context.getCoords()));
+}
+
+void AltitudeTexturer::processTerrain(Terrain &terrain, u64 key) {
     Image &texture = terrain.getTexture();
     auto dims = terrain.getBoundingBox().getDimensions();
     double heightEdgeRatio = dims.z / dims.x;
 
-    std::uniform_real_distribution<double> positive(0, 1);
-    std::uniform_real_distribution<double> jitter(-1, 1);
+    {
+        std::lock_guard<std::mutex> lock(_colorMapMutex);
+        _colorMap.update();
+    }
+
+    const int width = texture.width();
+    const int height = texture.height();
+    const int res = terrain.getResolution();
+    const AxisSamples xs(width, res), ys(height, res);
+
+    // Heights and slopes are only computed at the terrain resolution
+    const arma::mat heights = terrain.toMatrix();
+    const arma::mat slopes = terrain.getSlopes();
+
+    // The slopes are interpolated bilinearly, one axis after the other:
+    // first along x for each row of the terrain...
+    std::vector<double> slopeRows(res * width);
+
+    for (int y = 0; y < res; ++y) {
+        const double *row = slopes.colptr(y);
+        double *out = &slopeRows[y * width];
+
+        for (int x = 0; x < width; ++x) {
+            const int c = xs._cell[x];
+            out[x] = row[c] + (row[c + 1] - row[c]) * xs._offset[x];
+        }
+    }
+
+    std::vector<double> slopeLine(width);
+    const double j = 5. / 255.;
 
-    for (int x = 0; x < texture.width(); x++) {
-        for (int y = 0; y < texture.height(); y++) {
-            double xd = (double)x / (texture.width() - 1);
-            double yd = (double)y / (texture.height() - 1);
+    for (int y = 0; y < height; ++y) {
+        const int cy = ys._cell[y];
+        const double yd = ys._offset[y];
 
-            double altitude = terrain.getExactHeightAt(xd, yd);
-            double slope = terrain.getSlopeAt(xd, yd);
+        // ... then along y for each row of the texture
+        const double *s0 = &slopeRows[cy * width];
+        const double *s1 = &slopeRows[(cy + 1) * width];
+
+        for (int x = 0; x < width; ++x) {
+            slopeLine[x] = s0[x] + (s1[x] - s0[x]) * yd;
+        }
+
+        const double *h0 = heights.colptr(cy);
+        const double *h1 = heights.colptr(cy + 1);
+        RGBPixel *pixels = &texture.rgb(0, y);
+
+        for (int x = 0; x < width; ++x) {
+            // Triangular interpolation, as in Terrain::getExactHeightAt, so
+            // that the altitude matches the mesh
+            const int cx = xs._cell[x];
+            double xd = xs._offset[x];
+            double altitude;
+
+            if (xd + yd > 1) {
+                altitude = h1[cx + 1] + (h1[cx] - h1[cx + 1]) * (1 - xd) +
+                           (h0[cx + 1] - h1[cx + 1]) * (1 - yd);
+            } else {
+                altitude = h0[cx] + (h0[cx + 1] - h0[cx]) * xd +
+                           (h1[cx] - h0[cx]) * yd;
+            }
+
+            // One hash gives all the random values of the texel
+            const u64 hash = mixSeed(key, u64(y) * width + x);
 
             // get the parameters to pick in the colormap
-            double p1 = clamp(altitude + jitter(_rng) * 0.01, 0, 1);
-            double p2 = clamp(atan(abs(slope) * heightEdgeRatio) * 2 / M_PI +
-                                  jitter(_rng) * 0.01,
+            double p1 = clamp(altitude + jitterAt(hash, 0) * 0.01, 0, 1);
+            double p2 = clamp(atan(slopeLine[x] * heightEdgeRatio) * 2 / M_PI +
+                                  jitterAt(hash, 1) * 0.01,
                               0, 1);
 
-            // pick the color
-            Color4d color = _colorMap.getColorAt({p1, p2});
-
-            // jitter the color and set in the texture
-            double j = 5. / 255.;
-            texture.rgb(x, y).setf(clamp(color._r + jitter(_rng) * j, 0, 1),
-                                   clamp(color._g + jitter(_rng) * j, 0, 1),
-                                   clamp(color._b + jitter(_rng) * j, 0, 1));
+            // pick the color, jitter it and set it in the texture
+            vec3d color = _colorMap.getBuiltColorAt(p1, p2);
+            pixels[x].set(toByte(color.x + jitterAt(hash, 2) * j),
+                          toByte(color.y + jitterAt(hash, 3) * j),
+                          toByte(color.z + jitterAt(hash, 4) * j));
         }
     }
 }
 
-void AltitudeTexturer::processTile(ITileContext &context) {
-    processTerrain(context.getTile().terrain());
+void AltitudeTexturer::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _seed << ";";
+    _colorMap.write(stream);
 }
 } // namespace world
@@ -1,6 +1,7 @@
 #include "ApplyParentTerrain.h"
 
 #include "TerrainOps.h"
+#include "TerrainResampler.h"
 
 namespace world {
 
@@ -23,13 +24,17 @@ void ApplyParentTerrain::processTile(ITileContext &context) {
 
     TileCoordinates parentCoords = context.getParentCoords();
     TerrainElement *parentElem;
+    {
+        std::lock_guard<std::mutex> lock(_storageMutex);
 
-    if (!_storage.tryGet(parentCoords, &parentElem))
-        return;
+        if (!_storage.tryGet(parentCoords, &parentElem))
+            return;
+    }
 
     Terrain &parent = parentElem->_terrain;
 
     int res = child.getResolution();
+    int border = child.getBorder();
 
     // Useful variables
     auto pbbox = parent.getBoundingBox();
@@ -44,15 +49,20 @@ void ApplyParentTerrain::processTile(ITileContext &context) {
     const double childProp = getContribution(lvl, ratio);
     const double parentProp = 1 + _parentOverflow - childProp;
 
-    arma::mat bufferParent(res, res);
+    const int bufferRes = child.getBufferResolution();
+    const double step = ratio / (res - 1);
+    TerrainResampler resampler(parent, TerrainResampler::Mode::LINEAR,
+                               {oX - border * step, oY - border * step},
+                               step, bufferRes);
+    arma::mat bufferParent(bufferRes, bufferRes);
+
+    for (int y = 0; y < bufferRes; y++) {
+        // bufferParent(x, y) is in column y
+        double *column = bufferParent.colptr(y);
+        resampler.getRow(y, column);
 
-    for (int x = 0; x < res; x++) {
-        for (int y = 0; y < res; y++) {
-            bufferParent(x, y) = parent.getInterpolatedHeight(
-                                     oX + ((double)x / (res - 1)) * ratio,
-                                     oY + ((double)y / (res - 1)) * ratio,
-                                     Interpolation::LINEAR) *
-                                 parentProp;
+        for (int x = 0; x < bufferRes; x++) {
+            column[x] *= parentProp;
 
             // to unapply :
             // * (unapply ? -1. : 1.)
@@ -65,9 +75,23 @@ void ApplyParentTerrain::processTile(ITileContext &context) {
     // to unapply
     // TerrainOps::applyOffset(child, bufferParent);
     // TerrainOps::multiply(child, 1. / childProp);
+    std::lock_guard<std::mutex> lock(_storageMutex);
     _storage.set(coords, child);
 }
 
+void ApplyParentTerrain::restoreTile(ITileContext &context) {
+    if (context.getCoords()._lod == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(_storageMutex);
+    _storage.set(context.getCoords(), context.getTile().terrain());
+}
+
+void ApplyParentTerrain::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _childRate << " " << _parentOverflow << ";";
+}
+
 double ApplyParentTerrain::getContribution(int parentCount, double ratio) {
     return parentCount == 0 ? 1 : 0.1 * powi(ratio, parentCount - 1);
 }
@@ -3,6 +3,8 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <mutex>
+
 #include "ITerrainWorker.h"
 
 namespace world {
@@ -15,8 +17,19 @@ public:
 
     void processTile(ITileContext &context) override;
 
+    bool isReentrant() const override { return true; }
+
+    bool fillsBorder() const override { return true; }
+
+    /** The final terrain is stored in place of the one produced by this
+     * worker, the children are then built upon it. */
+    void restoreTile(ITileContext &context) override;
+
+    void writeConfig(std::ostream &stream) const override;
+
 private:
     TerrainGrid _storage;
+    std::mutex _storageMutex;
 
     double _childRate;
     double _parentOverflow;
@@ -7,7 +7,12 @@
 namespace world {
 
 DiamondSquareTerrain::DiamondSquareTerrain(double jitter)
-        : _rng(time(NULL)), _jitter(-jitter / 2, jitter / 2) {}
+        : _jitter(-jitter / 2, jitter / 2) {}
+
+void DiamondSquareTerrain::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _seed << " " << _jitter.b() - _jitter.a() << ";";
+}
 
 
 int findMaxLevel(int terrainRes) {
@@ -24,6 +29,7 @@ void DiamondSquareTerrain::processTile(ITileContext &context) {
     TileCoordinates tc = context.getCoords();
     vec2i c(tc._pos);
     int lod = tc._lod;
+    _rng.seed(deriveSeed(_seed, tc));
 
     bool left = _storage.has(tc + vec2i{-1, 0});
     bool right = _storage.has(tc + vec2i{1, 0});
@@ -55,6 +61,7 @@ void DiamondSquareTerrain::processTerrain(Terrain &terrain) {
     int maxLevel = findMaxLevel(terrain.getResolution());
     // TODO warn user when terrain is not 2^n + 1
 
+    _rng.seed(deriveSeed(_seed, terrain.getBoundingBox().getLowerBound()));
     init(terrain);
 
     for (int i = maxLevel; i >= 1; --i) {
@@ -5,6 +5,7 @@
 
 #include <random>
 
+#include "world/math/RandomStream.h"
 #include "ITerrainWorker.h"
 
 namespace world {
@@ -22,8 +23,14 @@ public:
 
     TerrainGrid *getStorage() override { return &_storage; }
 
+    void setSeed(u64 seed) override { _seed = seed; }
+
+    void writeConfig(std::ostream &stream) const override;
+
 private:
-    std::mt19937_64 _rng;
+    u64 _seed = DEFAULT_SEED;
+    /** Reseeded for each terrain from the seed and the terrain position. */
+    RandomStream _rng;
 
     std::uniform_real_distribution<double> _jitter;
 
@@ -3,6 +3,8 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <ostream>
+
 namespace world {
 
 struct WORLDAPI_EXPORT DistributionParams {
@@ -22,6 +24,15 @@ struct WORLDAPI_EXPORT DistributionParams {
     float slopeFactor;
 };
 
+inline std::ostream &operator<<(std::ostream &stream,
+                                const DistributionParams &p) {
+    return stream << p.ha << " " << p.hb << " " << p.hc << " " << p.hd << " "
+                  << p.dha << " " << p.dhb << " " << p.dhc << " " << p.dhd
+                  << " " << p.hmin << " " << p.hmax << " " << p.dhmin << " "
+                  << p.dhmax << " " << p.threshold << " " << p.slopeFactor
+                  << ";";
+}
+
 } // namespace world
 
 #endif // VKWORLD_DISTRIBUTION_PARAMS_H
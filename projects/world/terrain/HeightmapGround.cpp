@@ -1,9 +1,17 @@
 #include "HeightmapGround.h"
 
+#include <algorithm>
+#include <iterator>
 #include <map>
 #include <unordered_map>
 #include <memory>
 #include <list>
+#include <mutex>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <typeinfo>
 
 #include "world/core/WorldTypes.h"
 #include "world/assets/SceneNode.h"
@@ -17,9 +25,13 @@
 #include "SimpleTexturer.h"
 #include "TerrainOps.h"
 #include "world/core/Profiler.h"
+#include "world/core/Tracer.h"
+#include "world/core/MemoryRegistry.h"
 #include "DiamondSquareTerrain.h"
 #include "world/core/GridStorage.h"
 #include "world/core/GridStorageReducer.h"
+#include "world/core/ThreadPool.h"
+#include "world/core/TileGenerationQueue.h"
 
 namespace world {
 
@@ -40,6 +52,27 @@ struct WorkerEntry {
 using Tile = HeightmapGround::Tile;
 
 
+/** An image painted on the texture of a tile, see
+ * HeightmapGround::paintTexture. */
+struct TexturePaint {
+    std::shared_ptr<const Image> _image;
+    vec2d _position;
+    vec2d _size;
+};
+
+
+/** Assets of a ready tile, read by the asynchronous collects without
+ * locking the tiles. */
+struct PublishedTile {
+    ItemKey _itemKey;
+    vec3d _offset;
+    std::shared_ptr<const CompactMesh> _mesh;
+    /// Conversion of _mesh for the collectors that only take Mesh
+    std::weak_ptr<const Mesh> _convertedMesh;
+    std::shared_ptr<const Image> _texture;
+};
+
+
 // Utility class
 class GroundContext : public ITileContext {
 public:
@@ -69,6 +102,80 @@ public:
     GridStorageReducer _reducer;
     GridStorage<HeightmapGroundTile> _terrains;
     std::list<WorkerEntry> _generators;
+
+    /** Null if the tiles are generated on the calling thread only. */
+    std::unique_ptr<ThreadPool> _threadPool;
+
+    /** Held by any thread that accesses the tiles or the workers. */
+    std::recursive_mutex _mutex;
+
+    /** Tiles ready to be collected asynchronously, guarded by
+     * _publishedMutex only. _publishedMutex is never held while locking
+     * _mutex. */
+    std::map<TileCoordinates, PublishedTile> _published;
+    std::mutex _publishedMutex;
+
+    /** Images painted on each tile, painted again every time the texture of
+     * the tile is generated or loaded from the cache. */
+    std::map<TileCoordinates, std::vector<TexturePaint>> _paints;
+
+    u64 _seed = DEFAULT_SEED;
+    /** Incremented each time all the tiles are dropped, so that the new
+     * tiles are collected under new keys. */
+    u32 _generation = 0;
+    size_t _generatedCount = 0;
+    /// Id of the counter of the ground in the MemoryRegistry
+    u64 _memoryId = 0;
+
+    std::shared_ptr<ICache> _cache;
+    /** Prefix of the cache keys, that identifies the configuration of the
+     * ground. Empty if it was not computed yet. */
+    std::string _cachePrefix;
+
+    /** Index buffers shared by all the tile meshes, by resolution. */
+    std::map<int, std::shared_ptr<const CompactMesh>> _gridIndices;
+
+    /** Declared last so that the generation thread is stopped before the
+     * other members are destroyed. */
+    std::unique_ptr<TileGenerationQueue> _queue;
+};
+
+
+/** Version of the format of the tiles in the cache. */
+const u32 TILE_CACHE_VERSION = 5;
+
+class BlobWriter {
+public:
+    std::string _data;
+
+    template <typename T> void write(const T &value) {
+        write(&value, sizeof(T));
+    }
+
+    void write(const void *data, size_t size) {
+        _data.append(static_cast<const char *>(data), size);
+    }
+};
+
+class BlobReader {
+public:
+    BlobReader(const CacheView &view)
+            : _pos(view.data()), _end(view.data() + view.size()) {}
+
+    template <typename T> bool read(T &value) { return read(&value, sizeof(T)); }
+
+    bool read(void *data, size_t size) {
+        if (static_cast<size_t>(_end - _pos) < size)
+            return false;
+
+        std::memcpy(data, _pos, size);
+        _pos += size;
+        return true;
+    }
+
+private:
+    const char *_pos;
+    const char *_end;
 };
 
 
@@ -85,9 +192,16 @@ HeightmapGround::HeightmapGround(double unitSize, double minAltitude,
               5, vec3d(_textureRes * _texPixSize, _textureRes * _texPixSize, 0),
               vec3d(unitSize, unitSize, 0)) {
     _internal = new PGround(_tileSystem);
+    _internal->_queue = std::make_unique<TileGenerationQueue>(
+        [this](const TileCoordinates &key) { generateAsync(key); });
+    _internal->_memoryId = MemoryRegistry::getDefault().add(
+        "HeightmapGround", [this]() { return getMemoryUsage(); });
 }
 
-HeightmapGround::~HeightmapGround() { delete _internal; }
+HeightmapGround::~HeightmapGround() {
+    MemoryRegistry::getDefault().remove(_internal->_memoryId);
+    delete _internal;
+}
 
 void HeightmapGround::setDefaultWorkerSet() {
     // setLodRange(addWorker<PerlinTerrainGenerator>(3, 4., 0.35), 0, 0);
@@ -127,6 +241,67 @@ void HeightmapGround::setLodRange(const ITerrainWorker &worker, int minLod,
     }
 }
 
+void HeightmapGround::setThreadCount(int threadCount) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+
+    if (threadCount == 1) {
+        _internal->_threadPool.reset();
+    } else {
+        _internal->_threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+void HeightmapGround::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    _internal->_reducer.setMemoryBudget(bytes);
+}
+
+size_t HeightmapGround::getMemoryUsage() const {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    size_t bytes = _internal->_terrains.getMemoryUsage();
+
+    for (auto &entry : _internal->_generators) {
+        auto *storage = entry._worker->getStorage();
+
+        if (storage != nullptr) {
+            bytes += storage->getMemoryUsage();
+        }
+    }
+    return bytes;
+}
+
+size_t HeightmapGround::getGeneratedTileCount() const {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    return _internal->_generatedCount;
+}
+
+size_t HeightmapGround::getEvictedTileCount() const {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    return _internal->_reducer.getRemovedCount();
+}
+
+void HeightmapGround::setCache(std::shared_ptr<ICache> cache) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    _internal->_cache = std::move(cache);
+}
+
+void HeightmapGround::setSeed(u64 seed) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    _internal->_seed = seed;
+    u64 index = 0;
+
+    for (auto &entry : _internal->_generators) {
+        entry._worker->setSeed(deriveSeed(seed, index));
+        ++index;
+    }
+
+    // Tiles of the previous seed must not be mixed with the new ones
+    removeAllTiles();
+    updateCachePrefix();
+}
+
+u64 HeightmapGround::getSeed() const { return _internal->_seed; }
+
 double HeightmapGround::observeAltitudeAt(double x, double y,
                                           double resolution) {
     int lvl = _tileSystem.getLod(resolution);
@@ -136,6 +311,15 @@ double HeightmapGround::observeAltitudeAt(double x, double y,
 void HeightmapGround::collect(ICollector &collector,
                               const IResolutionModel &resolutionModel,
                               const ExplorationContext &ctx) {
+    WORLD_TRACE_ZONE("HeightmapGround::collect");
+
+    if (ctx.isAsync()) {
+        collectAsync(collector, resolutionModel);
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    checkConfiguration();
 
     BoundingBox bbox = resolutionModel.getBounds();
 
@@ -163,24 +347,43 @@ void HeightmapGround::collect(ICollector &collector,
     addNotGeneratedParents(toGenerate);
     generateTerrains(toGenerate);
 
+    // Only the collected tiles need a texture, not their parents
+    if (collector.hasChannel<Material>() && collector.hasChannel<Image>()) {
+        generateTextures(toCollect);
+    }
+
     for (auto &coord : toCollect) {
         addTerrain(coord, collector);
     }
 
-    std::cout << "Ground before reducing: " << _internal->_terrains.size();
-    _internal->_reducer.reduceStorage();
-    std::cout << ", Ground after reducing: " << _internal->_terrains.size()
-              << std::endl;
+    WORLD_TRACE_ZONE("HeightmapGround::reduceStorage");
+    size_t budget = _internal->_reducer.getMemoryBudget();
+
+    // Textures can be generated again cheaply from the terrains, so they are
+    // dropped first when the ground is over its budget
+    if (budget != 0 && getMemoryUsage() > budget) {
+        releaseTextures(toCollect);
+    }
+    reduceStorage();
+}
+
+void HeightmapGround::waitForGeneration() { _internal->_queue->waitIdle(); }
+
+size_t HeightmapGround::getAsyncGenerationCount() const {
+    return _internal->_queue->completedCount();
 }
 
 void HeightmapGround::paintTexture(const vec2d &origin, const vec2d &size,
                                    const vec2d &resolutionRange,
                                    const Image &img) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    checkConfiguration();
     const int minLod = _tileSystem.getLod(resolutionRange.x);
     const int maxLod = _tileSystem.getLod(resolutionRange.y);
 
     const vec3d min{origin.x, origin.y, 0};
     const vec3d max{origin.x + size.x, origin.y + size.y, 0};
+    auto image = std::make_shared<const Image>(img);
 
     for (int lod = minLod; lod <= maxLod; ++lod) {
         TileCoordinates tileMin = _tileSystem.getTileCoordinates(min, lod);
@@ -197,15 +400,36 @@ void HeightmapGround::paintTexture(const vec2d &origin, const vec2d &size,
                 TileCoordinates current{x, y, 0, lod};
                 vec3d imgCoords =
                     (tileMin._pos - current._pos) * tileSize + localMin;
-                ImageUtils::paintTexturef(provideTerrain(current).getTexture(),
-                                          img, {imgCoords.x, imgCoords.y},
-                                          {imgSize.x, imgSize.y});
+                TexturePaint paint{image,
+                                   {imgCoords.x, imgCoords.y},
+                                   {imgSize.x, imgSize.y}};
+                _internal->_paints[current].push_back(paint);
+
+                // A texture generated later receives all the paints
+                Tile &tile = provide(current);
+
+                if (tile._textureGenerated) {
+                    applyPaint(tile, paint);
+                } else {
+                    generateTextures({current});
+                }
+
+                std::lock_guard<std::mutex> publishedLock(
+                    _internal->_publishedMutex);
+                auto published = _internal->_published.find(current);
+
+                if (published != _internal->_published.end()) {
+                    published->second._itemKey = getTerrainDataId(current);
+                    published->second._texture = provideSharedTexture(current);
+                }
             }
         }
     }
 }
 
 void HeightmapGround::addWorkerInternal(ITerrainWorker *worker) {
+    worker->setSeed(
+        deriveSeed(_internal->_seed, u64(_internal->_generators.size())));
     _internal->_generators.emplace_back(worker);
     auto *storage = worker->getStorage();
 
@@ -215,67 +439,252 @@ void HeightmapGround::addWorkerInternal(ITerrainWorker *worker) {
 }
 
 double HeightmapGround::observeAltitudeAt(double x, double y, int lvl) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
     TileCoordinates key = _tileSystem.getTileCoordinates({x, y, 0}, lvl);
     vec3d inTile = _tileSystem.getLocalCoordinates({x, y, 0}, lvl);
 
-    const Terrain &terrain = this->provideTerrain(key);
-    return _minAltitude +
-           getAltitudeRange() * terrain.getExactHeightAt(inTile.x, inTile.y);
+    Tile *tile;
+    double height;
+
+    // The tile is only generated if the workers can not compute the point
+    if (_internal->_terrains.tryGet(key, &tile)) {
+        height = tile->_terrain.getExactHeightAt(inTile.x, inTile.y);
+    } else if (!computePointHeight(key, vec2d(inTile), height)) {
+        checkConfiguration();
+        const Terrain &terrain = this->provideTerrain(key);
+        height = terrain.getExactHeightAt(inTile.x, inTile.y);
+    }
+    return _minAltitude + getAltitudeRange() * height;
 }
 
-inline ItemKey terrainToItem(const std::string &key) { return {"_" + key}; }
+bool HeightmapGround::computePointHeight(const TileCoordinates &key,
+                                         const vec2d &pos, double &height) {
+    const int lod = key._lod;
+    auto isActive = [lod](const WorkerEntry &entry) {
+        return entry._constraints._lodMin <= lod &&
+               entry._constraints._lodMax >= lod &&
+               !entry._worker->isTexturer();
+    };
+
+    for (auto &entry : _internal->_generators) {
+        if (isActive(entry) && !entry._worker->supportsPoints()) {
+            return false;
+        }
+    }
+
+    const BoundingBox bounds = getTileBounds(key);
+    const int width = _terrainRes - 1;
+
+    auto computeSample = [&](int x, int y) {
+        TerrainPoint point{key, bounds, {double(x) / width, double(y) / width}};
+        double value = 0;
+
+        for (auto &entry : _internal->_generators) {
+            if (isActive(entry)) {
+                value = entry._worker->processPoint(point, value);
+            }
+        }
+        return value;
+    };
+
+    // Same cell and triangle as Terrain::getExactHeightAt
+    const double x = pos.x * width;
+    const double y = pos.y * width;
+    const int xi = clamp(static_cast<int>(floor(x)), 0, width - 1);
+    const int yi = clamp(static_cast<int>(floor(y)), 0, width - 1);
+    const double xd = x - xi;
+    const double yd = y - yi;
+
+    arma::mat samples(2, 2, arma::fill::zeros);
+
+    if (xd + yd > 1) {
+        samples(1, 1) = computeSample(xi + 1, yi + 1);
+    } else {
+        samples(0, 0) = computeSample(xi, yi);
+    }
+    samples(1, 0) = computeSample(xi + 1, yi);
+    samples(0, 1) = computeSample(xi, yi + 1);
+
+    // The samples are stored the same way as in the tiles
+    Terrain cell(samples);
+    cell.setStorage(_terrainStorage);
+    height = cell.getExactHeightAt(xd, yd);
+    return true;
+}
+
+BoundingBox HeightmapGround::getTileBounds(const TileCoordinates &key) const {
+    double terrainSize = _tileSystem.getTileSize(key._lod).x;
+    return BoundingBox(
+        {terrainSize * key._pos.x, terrainSize * key._pos.y, _minAltitude},
+        {terrainSize * (key._pos.x + 1), terrainSize * (key._pos.y + 1),
+         _maxAltitude});
+}
 
 void HeightmapGround::addTerrain(const TileCoordinates &key,
                                  ICollector &collector) {
-    ItemKey itemKey = terrainToItem(getTerrainDataId(key));
-    Terrain &terrain = this->provideTerrain(key);
+    const Terrain &terrain = provideTerrain(key);
+    addTerrain(
+        key, getTerrainDataId(key), terrain.getBoundingBox().getLowerBound(),
+        [&] { return provideSharedCompactMesh(key); },
+        [&] { return provideSharedMesh(key); },
+        [&] { return provideSharedTexture(key); }, collector);
+}
+
+void HeightmapGround::addTerrain(
+    const TileCoordinates &key, const ItemKey &itemKey, const vec3d &offset,
+    const std::function<std::shared_ptr<const CompactMesh>()> &compactMesh,
+    const std::function<std::shared_ptr<const Mesh>()> &mesh,
+    const std::function<std::shared_ptr<const Image>()> &texture,
+    ICollector &collector) {
+    const bool compact = collector.hasChannel<CompactMesh>();
 
-    if (collector.hasChannel<SceneNode>() && collector.hasChannel<Mesh>()) {
+    if (collector.hasChannel<SceneNode>() &&
+        (compact || collector.hasChannel<Mesh>())) {
 
         auto &objChannel = collector.getChannel<SceneNode>();
-        auto &meshChannel = collector.getChannel<Mesh>();
 
-        if (!objChannel.has(itemKey)) {
-            // Relocate the terrain
-            auto &bbox = terrain.getBoundingBox();
-            vec3d offset = bbox.getLowerBound();
+        // Each asset is checked separately, so that in delta collects all
+        // the assets of a terrain collected previously are kept. The meshes
+        // are only converted for the collectors that can not take them
+        // compact.
+        if (compact) {
+            auto &meshChannel = collector.getChannel<CompactMesh>();
 
-            // Create the mesh
-            meshChannel.put(itemKey, provideMesh(key));
+            if (!meshChannel.keep(itemKey)) {
+                meshChannel.putShared(itemKey, compactMesh());
+            }
+        } else {
+            auto &meshChannel = collector.getChannel<Mesh>();
 
+            if (!meshChannel.keep(itemKey)) {
+                meshChannel.putShared(itemKey, mesh());
+            }
+        }
+
+        if (!objChannel.keep(itemKey)) {
+            // Relocate the terrain
             SceneNode object(itemKey.str());
             object.setPosition(offset);
 
-            // Create the material
-            Material material("terrain");
-            material.setKd(1, 1, 1);
-// #define DEBUG_COLOR
-#ifdef DEBUG_COLOR
-            double value = (double)key._lod / _tileSystem._maxLod;
-            double _void;
-            material.setKd(modf(0.5 + value, &_void), 1 - value, value);
-#endif
-            material.setMapKd("texture01");
-
-            // Retrieve the texture
-            auto &texture = terrain.getTexture();
-
             if (collector.hasChannel<Material>()) {
-                auto &matChan = collector.getChannel<Material>();
                 object.setMaterialID(itemKey.str());
+            }
+            objChannel.put(itemKey, object);
+        }
+
+        if (collector.hasChannel<Material>()) {
+            auto &matChan = collector.getChannel<Material>();
+
+            if (collector.hasChannel<Image>()) {
+                auto &imageChan = collector.getChannel<Image>();
 
-                if (collector.hasChannel<Image>()) {
-                    auto &imageChan = collector.getChannel<Image>();
-                    material.setMapKd(itemKey.str());
-                    imageChan.put(itemKey, texture);
+                if (!imageChan.keep(itemKey)) {
+                    imageChan.putShared(itemKey, texture());
                 }
+            }
 
+            if (!matChan.keep(itemKey)) {
+                // Create the material
+                Material material("terrain");
+                material.setKd(1, 1, 1);
+// #define DEBUG_COLOR
+#ifdef DEBUG_COLOR
+                double value = (double)key._lod / _tileSystem._maxLod;
+                double _void;
+                material.setKd(modf(0.5 + value, &_void), 1 - value, value);
+#endif
+                material.setMapKd(collector.hasChannel<Image>() ? itemKey.str()
+                                                                : "texture01");
                 matChan.put(itemKey, material);
             }
+        }
+    }
+}
 
-            objChannel.put(itemKey, object);
+void HeightmapGround::collectAsync(ICollector &collector,
+                                   const IResolutionModel &resolutionModel) {
+    {
+        // The generation thread holds the tiles while generating, in which
+        // case the configuration is checked by the generation thread
+        std::unique_lock<std::recursive_mutex> lock(_internal->_mutex,
+                                                    std::try_to_lock);
+
+        if (lock.owns_lock()) {
+            checkConfiguration();
         }
     }
+
+    auto &queue = *_internal->_queue;
+    // Requests from the previous point of view are not relevant anymore
+    queue.clear();
+
+    std::lock_guard<std::mutex> lock(_internal->_publishedMutex);
+    auto &published = _internal->_published;
+    auto isReady = [&](const TileCoordinates &key) {
+        return published.find(key) != published.end();
+    };
+
+    auto request = [&](const TileCoordinates &key) {
+        vec3d offset = _tileSystem.getTileOffset(key);
+        vec3d size = _tileSystem.getTileSize(key._lod);
+        BoundingBox bbox({offset.x, offset.y, _minAltitude},
+                         {offset.x + size.x, offset.y + size.y, _maxAltitude});
+        queue.request(key, resolutionModel.getMaxResolutionIn(bbox));
+    };
+
+    // Missing tiles are replaced by their nearest ready parent. Their
+    // parents are requested too, so that a coarse version of the terrain
+    // shows up quickly.
+    std::set<TileCoordinates> toCollect;
+
+    for (auto it = _tileSystem.iterate(resolutionModel,
+                                       resolutionModel.getBounds());
+         !it.endReached(); ++it) {
+
+        TileCoordinates key = *it;
+
+        while (!isReady(key)) {
+            request(key);
+
+            if (key._lod == 0)
+                break;
+
+            key = _tileSystem.getParentTileCoordinates(key);
+        }
+
+        if (isReady(key)) {
+            toCollect.insert(key);
+        }
+    }
+
+    // A tile that replaces its missing children may overlap with their ready
+    // siblings: the siblings are not collected in that case.
+    for (auto it = toCollect.begin(); it != toCollect.end();) {
+        bool covered = false;
+
+        for (TileCoordinates key = *it; key._lod != 0 && !covered;) {
+            key = _tileSystem.getParentTileCoordinates(key);
+            covered = toCollect.find(key) != toCollect.end();
+        }
+
+        it = covered ? toCollect.erase(it) : ++it;
+    }
+
+    for (auto &key : toCollect) {
+        PublishedTile &tile = published.at(key);
+        auto convertMesh = [&] {
+            auto mesh = tile._convertedMesh.lock();
+
+            if (!mesh) {
+                mesh = std::make_shared<const Mesh>(tile._mesh->toMesh());
+                tile._convertedMesh = mesh;
+            }
+            return mesh;
+        };
+        addTerrain(
+            key, tile._itemKey, tile._offset, [&] { return tile._mesh; },
+            convertMesh, [&] { return tile._texture; }, collector);
+    }
 }
 
 // ==== ACCESS
@@ -295,8 +704,8 @@ Terrain &HeightmapGround::provideTerrain(const TileCoordinates &key) {
     return provide(key)._terrain;
 }
 
-Mesh &HeightmapGround::provideMesh(const TileCoordinates &key) {
-    auto &mesh = provide(key)._mesh;
+CompactMesh &HeightmapGround::provideMesh(const TileCoordinates &key) {
+    CompactMesh &mesh = *provide(key)._mesh;
 
     if (mesh.empty()) {
         generateMesh(key);
@@ -305,17 +714,312 @@ Mesh &HeightmapGround::provideMesh(const TileCoordinates &key) {
     return mesh;
 }
 
+std::shared_ptr<const CompactMesh> HeightmapGround::provideSharedCompactMesh(
+    const TileCoordinates &key) {
+    provideMesh(key);
+    return provide(key)._mesh;
+}
+
+std::shared_ptr<const Mesh> HeightmapGround::provideSharedMesh(
+    const TileCoordinates &key) {
+    Tile &tile = provide(key);
+    auto mesh = tile._sharedMesh.lock();
+
+    if (!mesh) {
+        mesh = std::make_shared<const Mesh>(provideMesh(key).toMesh());
+        tile._sharedMesh = mesh;
+    }
+    return mesh;
+}
+
+std::shared_ptr<const Image> HeightmapGround::provideSharedTexture(
+    const TileCoordinates &key) {
+    Tile &tile = provide(key);
+    auto texture = tile._sharedTexture.lock();
+
+    if (!texture) {
+        generateTextures({key});
+        texture = std::make_shared<const Image>(tile._terrain.getTexture());
+        tile._sharedTexture = texture;
+    }
+    return texture;
+}
+
+std::shared_ptr<const CompactMesh> HeightmapGround::provideGridIndices(
+    int res) {
+    auto &indices = _internal->_gridIndices[res];
+
+    if (!indices) {
+        auto grid = std::make_shared<CompactMesh>();
+        auto indice = [res](int x, int y) -> u32 { return u32(y * res + x); };
+        const int res_1 = res - 1;
+        grid->reserveFaces(u32(res_1 * res_1 * 2));
+
+        for (int y = 0; y < res_1; y++) {
+            for (int x = 0; x < res_1; x++) {
+                grid->addFace(indice(x, y), indice(x + 1, y),
+                              indice(x, y + 1));
+                grid->addFace(indice(x + 1, y + 1), indice(x, y + 1),
+                              indice(x + 1, y));
+            }
+        }
+        indices = grid;
+    }
+    return indices;
+}
+
 bool HeightmapGround::isGenerated(const TileCoordinates &key) {
     return _internal->_terrains.has(key);
 }
 
+void HeightmapGround::publish(const TileCoordinates &key) {
+    PublishedTile tile{getTerrainDataId(key),
+                       provideTerrain(key).getBoundingBox().getLowerBound(),
+                       provideSharedCompactMesh(key),
+                       {},
+                       provideSharedTexture(key)};
+    std::lock_guard<std::mutex> lock(_internal->_publishedMutex);
+    _internal->_published[key] = std::move(tile);
+}
+
+
+NodeKey HeightmapGround::getTerrainDataId(const TileCoordinates &key) const {
+    // The version changes with the content of the tile, so that collectors
+    // in delta mode replace the items of the tile
+    auto paints = _internal->_paints.find(key);
+    const u64 paintCount =
+        paints == _internal->_paints.end() ? 0 : paints->second.size();
+
+    u64 id[2];
+    id[0] = static_cast<u64>(key._pos.x & 0x0FFFFFFFu) +
+            (static_cast<u64>(key._pos.y & 0x0FFFFFFFu) << 24u) +
+            (static_cast<u64>(key._lod & 0xFFu) << 48u);
+    id[1] = (static_cast<u64>(_internal->_generation) << 32u) + paintCount;
+    return NodeKey(reinterpret_cast<const char *>(id), sizeof(id));
+}
+
+
+// ==== CACHE
+
+bool HeightmapGround::updateCachePrefix() {
+    std::stringstream config;
+    config << std::setprecision(17) << _tileSystem._maxLod << " "
+           << _tileSystem._factor << _tileSystem._bufferRes
+           << _tileSystem._baseSize << _minAltitude << " " << _maxAltitude
+           << " " << _terrainRes << " " << _textureRes << ";";
+
+    for (auto &entry : _internal->_generators) {
+        config << entry._constraints._lodMin << " "
+               << entry._constraints._lodMax << ";";
+        entry._worker->writeConfig(config);
+    }
+
+    // FNV-1a, stable between runs and platforms
+    u64 hash = 0xcbf29ce484222325ull;
+
+    for (char c : config.str()) {
+        hash = (hash ^ static_cast<u8>(c)) * 0x100000001b3ull;
+    }
+
+    std::stringstream hex;
+    hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+    std::string &prefix = _internal->_cachePrefix;
+    const bool changed = !prefix.empty() && prefix != hex.str();
+    prefix = hex.str();
+    return changed;
+}
+
+void HeightmapGround::checkConfiguration() {
+    if (updateCachePrefix()) {
+        removeAllTiles();
+    }
+}
+
+void HeightmapGround::removeAllTiles() {
+    _internal->_reducer.removeAll();
+    ++_internal->_generation;
+    std::lock_guard<std::mutex> lock(_internal->_publishedMutex);
+    _internal->_published.clear();
+}
+
+std::string HeightmapGround::getCacheKey(const TileCoordinates &key,
+                                         char kind) {
+    if (_internal->_cachePrefix.empty()) {
+        updateCachePrefix();
+    }
+
+    std::stringstream result;
+    result << _internal->_cachePrefix << "_" << kind << "_" << key._lod << "_" << key._pos.x
+           << "_" << key._pos.y << "_" << key._pos.z;
+    return result.str();
+}
+
+bool HeightmapGround::loadTerrain(Tile &tile) {
+    if (!_internal->_cache)
+        return false;
+
+    auto view = _internal->_cache->load(getCacheKey(tile._key, 't'));
+
+    if (!view)
+        return false;
+
+    BlobReader reader(*view);
+    Terrain &terrain = tile._terrain;
+    const int res = terrain.getResolution();
+    const int border = terrain.getBorder();
+    const int bufferRes = terrain.getBufferResolution();
+    u32 version;
+    s32 cachedRes, cachedBorder;
+
+    if (!reader.read(version) || version != TILE_CACHE_VERSION ||
+        !reader.read(cachedRes) || cachedRes != res ||
+        !reader.read(cachedBorder) || cachedBorder != border) {
+        return false;
+    }
+
+    std::vector<double> values(bufferRes * bufferRes);
+
+    if (!reader.read(values.data(), values.size() * sizeof(double)))
+        return false;
+
+    for (int y = -border; y < res + border; ++y) {
+        for (int x = -border; x < res + border; ++x) {
+            terrain(x, y) = values[(y + border) * bufferRes + x + border];
+        }
+    }
+    return true;
+}
+
+void HeightmapGround::saveTerrain(const Tile &tile) {
+    if (!_internal->_cache)
+        return;
+
+    const Terrain &terrain = tile._terrain;
+    const s32 res = terrain.getResolution();
+    const s32 border = terrain.getBorder();
+
+    BlobWriter writer;
+    writer.write(TILE_CACHE_VERSION);
+    writer.write(res);
+    writer.write(border);
+
+    for (int y = -border; y < res + border; ++y) {
+        for (int x = -border; x < res + border; ++x) {
+            writer.write(terrain(x, y));
+        }
+    }
+
+    try {
+        _internal->_cache->save(getCacheKey(tile._key, 't'),
+                                writer._data.data(), writer._data.size());
+    } catch (std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+bool HeightmapGround::loadTexture(Tile &tile) {
+    if (!_internal->_cache)
+        return false;
+
+    auto view = _internal->_cache->load(getCacheKey(tile._key, 'x'));
+
+    if (!view)
+        return false;
+
+    BlobReader reader(*view);
+    u32 version;
+    s32 width, height, type;
+
+    if (!reader.read(version) || version != TILE_CACHE_VERSION ||
+        !reader.read(width) || !reader.read(height) || !reader.read(type)) {
+        return false;
+    }
+
+    Image texture(width, height, static_cast<ImageType>(type));
+
+    if (!reader.read(texture.data(), texture.size()))
+        return false;
+
+    tile._terrain.setTexture(std::move(texture));
+    return true;
+}
+
+void HeightmapGround::saveTexture(const Tile &tile) {
+    if (!_internal->_cache)
+        return;
+
+    const Image &texture = tile._terrain.getTexture();
+
+    BlobWriter writer;
+    writer.write(TILE_CACHE_VERSION);
+    writer.write(static_cast<s32>(texture.width()));
+    writer.write(static_cast<s32>(texture.height()));
+    writer.write(static_cast<s32>(texture.type()));
+    writer.write(texture.data(), texture.size());
+
+    try {
+        _internal->_cache->save(getCacheKey(tile._key, 'x'),
+                                writer._data.data(), writer._data.size());
+    } catch (std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+bool HeightmapGround::loadMesh(Tile &tile) {
+    if (!_internal->_cache)
+        return false;
+
+    auto view = _internal->_cache->load(getCacheKey(tile._key, 'm'));
+
+    if (!view)
+        return false;
+
+    BlobReader reader(*view);
+    const int res = tile._terrain.getResolution();
+    u32 version, vertCount;
+
+    if (!reader.read(version) || version != TILE_CACHE_VERSION ||
+        !reader.read(vertCount) || vertCount != u32(res * res)) {
+        return false;
+    }
+
+    // The buffers of the compact mesh are filled directly, the indices are
+    // the same for all the tiles and are not cached
+    CompactMesh &mesh = *tile._mesh;
+    mesh.resize(vertCount, 0);
+    bool success =
+        reader.read(mesh.positions(), vertCount * 3 * sizeof(float)) &&
+        reader.read(mesh.quantizedNormals(), vertCount * 3 * sizeof(s16)) &&
+        reader.read(mesh.textures(), vertCount * 2 * sizeof(float));
+
+    if (success) {
+        mesh.setSharedIndices(provideGridIndices(res));
+    } else {
+        mesh.clear();
+    }
+    return success;
+}
 
-std::string HeightmapGround::getTerrainDataId(
-    const TileCoordinates &key) const {
-    u64 id = static_cast<u64>(key._pos.x & 0x0FFFFFFFu) +
-             (static_cast<u64>(key._pos.y & 0x0FFFFFFFu) << 24u) +
-             (static_cast<u64>(key._lod & 0xFFu) << 48u);
-    return std::to_string(id);
+void HeightmapGround::saveMesh(const Tile &tile) {
+    if (!_internal->_cache)
+        return;
+
+    const CompactMesh &mesh = *tile._mesh;
+    const u32 vertCount = mesh.getVerticesCount();
+
+    BlobWriter writer;
+    writer.write(TILE_CACHE_VERSION);
+    writer.write(vertCount);
+    writer.write(mesh.positions(), vertCount * 3 * sizeof(float));
+    writer.write(mesh.quantizedNormals(), vertCount * 3 * sizeof(s16));
+    writer.write(mesh.textures(), vertCount * 2 * sizeof(float));
+
+    try {
+        _internal->_cache->save(getCacheKey(tile._key, 'm'),
+                                writer._data.data(), writer._data.size());
+    } catch (std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+    }
 }
 
 
@@ -341,6 +1045,7 @@ void HeightmapGround::addNotGeneratedParents(std::set<TileCoordinates> &keys) {
 }
 
 void HeightmapGround::generateTerrains(const std::set<TileCoordinates> &keys) {
+    WORLD_TRACE_ZONE("HeightmapGround::generateTerrains");
     typedef std::vector<Tile *> generateTiles_t;
     std::vector<generateTiles_t> lods(_tileSystem._maxLod + 1);
 
@@ -348,140 +1053,309 @@ void HeightmapGround::generateTerrains(const std::set<TileCoordinates> &keys) {
         Tile *tile = &_internal->_terrains.getOrCreate(key, key, _terrainRes);
         lods[key._lod].push_back(tile);
     }
+    _internal->_generatedCount += keys.size();
 
     // Each lod is generated separately to ensure parents are
     // created before generating children
     int lod = 0;
 
-    for (auto &generatedTiles : lods) {
+    for (auto &lodTiles : lods) {
+        // Tiles found in the cache are only restored
+        generateTiles_t generatedTiles;
+        generateTiles_t loadedTiles;
 
-        // Allocation of terrain and textures
-        for (auto &tile : generatedTiles) {
+        // Allocation of terrains
+        for (auto &tile : lodTiles) {
             const auto &key = tile->_key;
             Terrain &terrain = tile->_terrain;
-            terrain.setTexture(Image(_textureRes, _textureRes, ImageType::RGB));
 
-            double terrainSize = _tileSystem.getTileSize(key._lod).x;
-            terrain.setBounds(terrainSize * key._pos.x,
-                              terrainSize * key._pos.y, _minAltitude,
-                              terrainSize * (key._pos.x + 1),
-                              terrainSize * (key._pos.y + 1), _maxAltitude);
+            const BoundingBox bbox = getTileBounds(key);
+            const vec3d lower = bbox.getLowerBound();
+            const vec3d upper = bbox.getUpperBound();
+            terrain.setBounds(lower.x, lower.y, lower.z, upper.x, upper.y,
+                              upper.z);
+
+            if (loadTerrain(*tile)) {
+                loadedTiles.push_back(tile);
+            } else {
+                generatedTiles.push_back(tile);
+            }
         }
 
         // Generation
+        bool bordersFilled = true;
+
         for (auto &entry : _internal->_generators) {
             auto &generator = entry._worker;
             auto &constraints = entry._constraints;
 
-            GroundContext context(this, &entry, nullptr);
-
             // check if constraints are fullfilled
-            bool doGeneration =
-                constraints._lodMin <= lod && constraints._lodMax >= lod;
+            bool doGeneration = constraints._lodMin <= lod &&
+                                constraints._lodMax >= lod &&
+                                !generator->isTexturer();
 
             if (doGeneration) {
-                for (auto &tile : generatedTiles) {
-                    Terrain &terrain = tile->_terrain;
-
-                    context._tile = tile;
+                bordersFilled = bordersFilled && generator->fillsBorder();
+                WORLD_TRACE_ZONE("ITerrainWorker::process",
+                                 typeid(*generator).name());
+
+                auto processTile = [&](size_t i) {
+                    WORLD_TRACE_ZONE("ITerrainWorker::processTile",
+                                     typeid(*generator).name());
+                    GroundContext context(this, &entry, generatedTiles[i]);
                     generator->processTile(context);
+                };
+
+                // Tiles of a same lod do not depend on each other, so they
+                // can be processed concurrently if the worker allows it
+                if (_internal->_threadPool && generator->isReentrant()) {
+                    _internal->_threadPool->parallelFor(generatedTiles.size(),
+                                                        processTile);
+                } else {
+                    for (size_t i = 0; i < generatedTiles.size(); ++i) {
+                        processTile(i);
+                    }
                 }
 
                 generator->flush();
+
+                for (auto &tile : loadedTiles) {
+                    GroundContext context(this, &entry, tile);
+                    generator->restoreTile(context);
+                }
             }
         }
 
+        for (auto &tile : generatedTiles) {
+            if (!bordersFilled) {
+                TerrainOps::extrapolateBorder(tile->_terrain);
+            }
+            saveTerrain(*tile);
+            tile->_terrain.setStorage(_terrainStorage);
+        }
+
+        for (auto &tile : loadedTiles) {
+            tile->_terrain.setStorage(_terrainStorage);
+        }
+
         ++lod;
     }
 }
 
-void HeightmapGround::generateMesh(const TileCoordinates &key) {
-    // Find required terrains
-    Terrain *terrains[3][3];
+void HeightmapGround::generateTextures(
+    const std::set<TileCoordinates> &keys) {
+    WORLD_TRACE_ZONE("HeightmapGround::generateTextures");
+    // Textures found in the cache are only restored
+    std::vector<Tile *> generatedTiles;
+    std::vector<Tile *> loadedTiles;
+
+    for (const TileCoordinates &key : keys) {
+        Tile &tile = provide(key);
+
+        if (tile._textureGenerated) {
+            continue;
+        }
 
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            TileCoordinates jitteredKey = key;
-            jitteredKey._pos.x += i - 1;
-            jitteredKey._pos.y += j - 1;
-            terrains[i][j] = &provideTerrain(jitteredKey);
+        if (loadTexture(tile)) {
+            loadedTiles.push_back(&tile);
+        } else {
+            tile._terrain.setTexture(
+                Image(_textureRes, _textureRes, ImageType::RGB));
+            generatedTiles.push_back(&tile);
         }
     }
 
-    // Fill mesh
-    // Same as Terrain::createMesh, but may become different
-    // + here we compute normals a different way (for tiling to be acceptable).
-    Mesh &mesh = provide(key)._mesh;
+    if (generatedTiles.empty() && loadedTiles.empty()) {
+        return;
+    }
 
-    // TODO compute size from TileSystem
-    BoundingBox bbox = terrains[1][1]->getBoundingBox();
-    const double offsetX = 0, offsetY = 0, offsetZ = 0;
-    const double sizeX = bbox.getDimensions().x;
-    const double sizeY = bbox.getDimensions().y;
-    const double sizeZ = bbox.getDimensions().z;
+    for (auto &entry : _internal->_generators) {
+        auto &generator = entry._worker;
+        auto &constraints = entry._constraints;
 
-    const int size = terrains[1][1]->getResolution();
-    const int size_1 = size - 1;
-    const double inv_size_1 = 1. / size_1;
-
-    auto valueAt = [&terrains, size](int x, int y) -> double {
-        // xl = x_local, xg = x_global
-        int xl = mod(x, size);
-        int yl = mod(y, size);
-        int xg = 1 + (x - xl) / size;
-        int yg = 1 + (y - yl) / size;
-        return terrains[xg][yg]->operator()(xl + xg - 1, yl + yg - 1);
-    };
+        if (!generator->isTexturer()) {
+            continue;
+        }
 
-    // Memory allocation
-    int vertCount = size * size;
-    mesh.reserveVertices(vertCount);
+        auto inLodRange = [&](const Tile *tile) {
+            return constraints._lodMin <= tile->_key._lod &&
+                   constraints._lodMax >= tile->_key._lod;
+        };
+        std::vector<Tile *> tiles;
+        std::copy_if(generatedTiles.begin(), generatedTiles.end(),
+                     std::back_inserter(tiles), inLodRange);
+
+        WORLD_TRACE_ZONE("ITerrainWorker::process", typeid(*generator).name());
+
+        auto processTile = [&](size_t i) {
+            WORLD_TRACE_ZONE("ITerrainWorker::processTile",
+                             typeid(*generator).name());
+            GroundContext context(this, &entry, tiles[i]);
+            generator->processTile(context);
+        };
+
+        if (_internal->_threadPool && generator->isReentrant()) {
+            _internal->_threadPool->parallelFor(tiles.size(), processTile);
+        } else {
+            for (size_t i = 0; i < tiles.size(); ++i) {
+                processTile(i);
+            }
+        }
 
-    // Vertices
-    for (int y = 0; y < size; y++) {
-        const double yd = y * inv_size_1;
-        const double ypos = yd * sizeY + offsetY;
+        generator->flush();
 
-        for (int x = 0; x < size; x++) {
-            const double xd = x * inv_size_1;
-            const double xpos = xd * sizeX + offsetX;
+        for (auto &tile : loadedTiles) {
+            if (inLodRange(tile)) {
+                GroundContext context(this, &entry, tile);
+                generator->restoreTile(context);
+            }
+        }
+    }
 
-            Vertex &vert = mesh.newVertex();
+    for (auto &tile : generatedTiles) {
+        saveTexture(*tile);
+    }
 
-            vert.setPosition(xpos, ypos, valueAt(x, y) * sizeZ + offsetZ);
-            vert.setTexture(xd, 1 - yd);
-            if (vert.getTexture().y > 1 || vert.getTexture().y < 0)
-                std::cout << vert.getTexture().y << std::endl;
+    // The paints are not saved in the cache with the textures
+    for (auto &tiles : {generatedTiles, loadedTiles}) {
+        for (auto &tile : tiles) {
+            auto paints = _internal->_paints.find(tile->_key);
 
-            // Compute normal
-            double xUnit = sizeX * inv_size_1;
-            double yUnit = sizeY * inv_size_1;
-            vec3d nx{(valueAt(x - 1, y) - valueAt(x + 1, y)) * sizeZ, 0,
-                     xUnit * 2};
-            vec3d ny{0, (valueAt(x, y - 1) - valueAt(x, y + 1)) * sizeZ,
-                     yUnit * 2};
-            vert.setNormal((nx + ny).normalize());
+            if (paints != _internal->_paints.end()) {
+                for (const TexturePaint &paint : paints->second) {
+                    applyPaint(*tile, paint);
+                }
+            }
+            tile->_textureGenerated = true;
+            tile->_sharedTexture.reset();
         }
     }
+}
 
-    // Faces
-    auto indice = [size](int x, int y) -> int { return y * size + x; };
-    mesh.reserveFaces(size_1 * size_1 * 2);
+void HeightmapGround::applyPaint(Tile &tile, const TexturePaint &paint) {
+    ImageUtils::paintTexturef(tile._terrain.getTexture(), *paint._image,
+                              paint._position, paint._size);
+    tile._sharedTexture.reset();
+}
+
+void HeightmapGround::releaseTextures(const std::set<TileCoordinates> &keep) {
+    _internal->_terrains.forEach([&](Tile &tile) {
+        if (tile._textureGenerated && keep.find(tile._key) == keep.end()) {
+            tile._terrain.setTexture(Image(1, 1, ImageType::RGB));
+            tile._textureGenerated = false;
+            tile._sharedTexture.reset();
+
+            std::lock_guard<std::mutex> lock(_internal->_publishedMutex);
+            _internal->_published.erase(tile._key);
+        }
+    });
+}
 
-    for (int y = 0; y < size_1; y++) {
-        for (int x = 0; x < size_1; x++) {
-            Face &face1 = mesh.newFace();
-            Face &face2 = mesh.newFace();
+void HeightmapGround::generateAsync(const TileCoordinates &key) {
+    std::lock_guard<std::recursive_mutex> lock(_internal->_mutex);
+    checkConfiguration();
+    provideMesh(key);
+    generateTextures({key});
+    publish(key);
+    reduceStorage();
+}
+
+void HeightmapGround::reduceStorage() {
+    WORLD_TRACE_ZONE("HeightmapGround::reduceStorage");
+    _internal->_reducer.reduceStorage();
 
-            face1.setID(0, indice(x, y));
-            face1.setID(1, indice(x + 1, y));
-            face1.setID(2, indice(x, y + 1));
+    std::lock_guard<std::mutex> lock(_internal->_publishedMutex);
+    auto &published = _internal->_published;
 
-            face2.setID(0, indice(x + 1, y + 1));
-            face2.setID(1, indice(x, y + 1));
-            face2.setID(2, indice(x + 1, y));
+    for (auto it = published.begin(); it != published.end();) {
+        it = _internal->_terrains.has(it->first) ? std::next(it)
+                                                 : published.erase(it);
+    }
+}
+
+void HeightmapGround::generateMesh(const TileCoordinates &key) {
+    WORLD_TRACE_ZONE("HeightmapGround::generateMesh");
+    if (loadMesh(provide(key))) {
+        return;
+    }
+
+    // Same as Terrain::createMesh, but the normals on the edges are computed
+    // with the border of the tile (for tiling to be acceptable).
+    const Terrain &center = provideTerrain(key);
+    const int size = center.getResolution();
+    const int size_1 = size - 1;
+
+    // Heights of the tile with a border of one height, so that the vertices
+    // are computed without any branch.
+    const int padded = size + 2;
+    std::vector<float> heights(padded * padded);
+    auto height = [&](int x, int y) -> float & {
+        return heights[(y + 1) * padded + x + 1];
+    };
+
+    for (int y = -1; y <= size; y++) {
+        for (int x = -1; x <= size; x++) {
+            height(x, y) = float(center.getHeight(x, y));
         }
     }
+
+    // TODO compute size from TileSystem
+    const vec3d dims = center.getBoundingBox().getDimensions();
+    const float sizeZ = float(dims.z);
+    const float xStep = float(dims.x / size_1);
+    const float yStep = float(dims.y / size_1);
+    const float uvStep = 1.f / size_1;
+    const float normalZ = 2 * (xStep + yStep);
+
+    // Fill mesh
+    CompactMesh &mesh = *provide(key)._mesh;
+    mesh.resize(u32(size * size), 0);
+    float *positions = mesh.positions();
+    float *textures = mesh.textures();
+    float *normals = mesh.normals();
+    s16 *quantizedNormals = mesh.quantizedNormals();
+    std::vector<float> rowNormals(size * 3);
+
+    for (int y = 0; y < size; y++) {
+        const float *row = &height(0, y);
+        const float *below = &height(0, y - 1);
+        const float *above = &height(0, y + 1);
+        const int offset = y * size;
+
+        for (int x = 0; x < size; x++) {
+            const int i = offset + x;
+            positions[i * 3] = x * xStep;
+            positions[i * 3 + 1] = y * yStep;
+            positions[i * 3 + 2] = row[x] * sizeZ;
+            textures[i * 2] = x * uvStep;
+            textures[i * 2 + 1] = 1 - y * uvStep;
+        }
+
+        for (int x = 0; x < size; x++) {
+            float nx = (row[x - 1] - row[x + 1]) * sizeZ;
+            float ny = (below[x] - above[x]) * sizeZ;
+            float norm = 1 / std::sqrt(nx * nx + ny * ny + normalZ * normalZ);
+            rowNormals[x * 3] = nx * norm;
+            rowNormals[x * 3 + 1] = ny * norm;
+            rowNormals[x * 3 + 2] = normalZ * norm;
+        }
+
+        if (quantizedNormals != nullptr) {
+            s16 *dst = quantizedNormals + offset * 3;
+
+            for (int c = 0; c < size * 3; ++c) {
+                float n = rowNormals[c];
+                dst[c] = static_cast<s16>(n * 32767 + (n < 0 ? -0.5f : 0.5f));
+            }
+        } else {
+            std::copy(rowNormals.begin(), rowNormals.end(),
+                      normals + offset * 3);
+        }
+    }
+
+    mesh.setSharedIndices(provideGridIndices(size));
+
+    saveMesh(provide(key));
 }
 
 } // namespace world
@@ -5,9 +5,11 @@
 
 #include <utility>
 #include <functional>
+#include <memory>
 #include <set>
 
 #include "world/core/TileSystem.h"
+#include "world/core/ICache.h"
 #include "world/flat/IGround.h"
 #include "Terrain.h"
 #include "ITerrainWorker.h"
@@ -15,13 +17,29 @@
 namespace world {
 
 class PGround;
+struct TexturePaint;
 
 class HeightmapGroundTile : public TerrainTile, public IGridElement {
 public:
+    /** The tiles have a border of one sample, so that the normals of their
+     * meshes can be computed without the neighbouring tiles. */
     HeightmapGroundTile(TileCoordinates coords, int terrainRes)
-            : TerrainTile(coords, terrainRes) {}
+            : TerrainTile(coords, terrainRes, 1) {}
+
+    size_t getMemoryUsage() const override {
+        return _terrain.getMemoryUsage() + _mesh->getMemoryUsage();
+    }
 
 private:
+    /// True once the texturers were run on the tile or its texture was
+    /// loaded from the cache
+    bool _textureGenerated = false;
+
+    /// Assets exported to the collectors, shared by all of them as long as
+    /// one of them uses it
+    std::weak_ptr<const Mesh> _sharedMesh;
+    std::weak_ptr<const Image> _sharedTexture;
+
     friend class HeightmapGround;
 };
 
@@ -50,6 +68,17 @@ public:
 
     void setTerrainResolution(int terrainRes) { _terrainRes = terrainRes; }
 
+    /** Set the storage of the heights of the tiles once they are generated.
+     * Workers always generate the tiles in TerrainStorage::FLOAT64, then the
+     * tiles are converted. With TerrainStorage::UINT16 the heights are
+     * quantized between the minimum and the maximum altitude, ie. in
+     * [0, 1] in terrain space. */
+    void setTerrainStorage(TerrainStorage storage) {
+        _terrainStorage = storage;
+    }
+
+    TerrainStorage getTerrainStorage() const { return _terrainStorage; }
+
     void setTextureRes(int textureRes) {
         _textureRes = textureRes;
         _tileSystem._bufferRes.x = _tileSystem._bufferRes.y =
@@ -58,6 +87,45 @@ public:
 
     void setMaxLOD(int lod) { _tileSystem._maxLod = lod; }
 
+    /** Set the number of threads used to generate the tiles of a same level
+     * of detail. 1 means that all the tiles are generated on the calling
+     * thread, 0 means one thread per hardware core. Only the workers that
+     * are reentrant (see ITerrainWorker::isReentrant) process several tiles
+     * at the same time. */
+    void setThreadCount(int threadCount);
+
+    /** Set the maximum number of bytes used by the generated tiles, including
+     * the storages of the workers. When the budget is exceeded, the least
+     * recently used tiles are deleted. 0 means no limit. */
+    void setMemoryBudget(size_t bytes);
+
+    /** Get the number of bytes currently used by the generated tiles and by
+     * the storages of the workers. */
+    size_t getMemoryUsage() const override;
+
+    /** Get the number of tiles generated or loaded from the cache since the
+     * creation of the ground. */
+    size_t getGeneratedTileCount() const;
+
+    /** Get the number of tiles deleted from memory since the creation of the
+     * ground, either to stay within the memory budget or because there were
+     * too many tiles. */
+    size_t getEvictedTileCount() const;
+
+    /** Set the cache used to store the generated tiles. Tiles found in the
+     * cache are loaded instead of being generated. Cache entries are tied to
+     * the configuration of the ground and of its workers, which should not
+     * be modified after the cache is set. */
+    void setCache(std::shared_ptr<ICache> cache);
+
+    /** Set the seed of the ground. Each worker receives a seed derived from
+     * this one and from its position in the worker chain, including the
+     * workers added later. The seed should be set before any tile is
+     * generated. */
+    void setSeed(u64 seed);
+
+    u64 getSeed() const;
+
     // TERRAIN WORKERS
     /** Adds a default worker set to generate heightmaps in the
      * ground. This method is for quick-setup purpose. */
@@ -73,12 +141,33 @@ public:
     void setLodRange(const ITerrainWorker &worker, int minLod, int maxLod);
 
     // EXPLORATION
+    /** Get the altitude of the ground at the given level of detail. If the
+     * tile is not generated yet and all its workers support points (see
+     * ITerrainWorker::supportsPoints), the altitude is computed directly
+     * by the workers without generating the tile, at the samples around the
+     * point. The result is the same as if the tile was generated. */
     double observeAltitudeAt(double x, double y, double resolution) override;
 
+    /** Collects the terrains. If the context is asynchronous, only the tiles
+     * that are fully generated are collected, missing tiles being replaced by
+     * their nearest generated parent, and the missing tiles are generated in
+     * background. An asynchronous collect never waits for the generation
+     * thread.
+     *
+     * The meshes are put in the CompactMesh channel of the collector if it
+     * has one, without any conversion, and in the Mesh channel otherwise. */
     void collect(ICollector &collector, const IResolutionModel &resolutionModel,
                  const ExplorationContext &ctx =
                      ExplorationContext::getDefault()) override;
 
+    /** Blocks until all the tiles scheduled by asynchronous collects are
+     * generated. */
+    void waitForGeneration();
+
+    size_t getAsyncGenerationCount() const override;
+
+    /** The paint is kept with the tiles, and painted again when their
+     * textures are generated again or loaded from the cache. */
     void paintTexture(const vec2d &origin, const vec2d &size,
                       const vec2d &resolutionRange, const Image &img) override;
 
@@ -92,6 +181,7 @@ private:
     double _maxAltitude;
 
     int _terrainRes = 33;
+    TerrainStorage _terrainStorage = TerrainStorage::FLOAT64;
     int _textureRes = 128;
     /** The wanted "size" of a texture pixel in the final picture. Ideally 1,
      * set it to more if you need performances. */
@@ -104,22 +194,100 @@ private:
 
     double observeAltitudeAt(double x, double y, int lvl);
 
+    /** Compute the height of one point of a tile with the workers, in
+     * terrain space. The samples of the tile around the point are computed
+     * and stored as in a generated tile, then interpolated as in
+     * Terrain::getExactHeightAt. Returns false if one of the workers does
+     * not support points. */
+    bool computePointHeight(const TileCoordinates &key, const vec2d &pos,
+                            double &height);
+
+    BoundingBox getTileBounds(const TileCoordinates &key) const;
+
     void addTerrain(const TileCoordinates &key, ICollector &collector);
 
+    /** Puts the assets of a tile in the collector. The mesh and the texture
+     * are only requested if the collector does not have them yet. The mesh
+     * is put compact if the collector has a CompactMesh channel, otherwise
+     * it is converted. */
+    void addTerrain(
+        const TileCoordinates &key, const ItemKey &itemKey, const vec3d &offset,
+        const std::function<std::shared_ptr<const CompactMesh>()> &compactMesh,
+        const std::function<std::shared_ptr<const Mesh>()> &mesh,
+        const std::function<std::shared_ptr<const Image>()> &texture,
+        ICollector &collector);
+
+    void collectAsync(ICollector &collector,
+                      const IResolutionModel &resolutionModel);
+
 
     // ACCESS
     HeightmapGround::Tile &provide(const TileCoordinates &key);
 
     Terrain &provideTerrain(const TileCoordinates &key);
 
-    Mesh &provideMesh(const TileCoordinates &key);
+    CompactMesh &provideMesh(const TileCoordinates &key);
+
+    /** Get the mesh of the tile, to be shared with the collectors. */
+    std::shared_ptr<const CompactMesh> provideSharedCompactMesh(
+        const TileCoordinates &key);
+
+    /** Get the mesh of the tile converted for the collectors that only take
+     * Mesh. The mesh is only converted once for all the collectors using
+     * it. */
+    std::shared_ptr<const Mesh> provideSharedMesh(const TileCoordinates &key);
+
+    std::shared_ptr<const Image> provideSharedTexture(
+        const TileCoordinates &key);
+
+    /** Get the indices of the triangles of a tile mesh with the given
+     * resolution. All the tile meshes share the same index buffer. */
+    std::shared_ptr<const CompactMesh> provideGridIndices(int res);
 
     bool isGenerated(const TileCoordinates &key);
 
+    /** Makes the assets of a tile available to the asynchronous collects.
+     * The terrain, the mesh and the texture of the tile must be generated. */
+    void publish(const TileCoordinates &key);
+
 
     // DATA
-    /** Gets a unique string id for the given tile in the Ground. */
-    std::string getTerrainDataId(const TileCoordinates &key) const;
+    /** Gets a unique key for the given tile in the Ground. The key changes
+     * when the content of the tile changes, ie. when the tile is painted or
+     * generated with another configuration. */
+    NodeKey getTerrainDataId(const TileCoordinates &key) const;
+
+    // CACHE
+    /** Computes the prefix of the cache keys from the configuration of the
+     * ground and of its workers. Returns true if the configuration changed
+     * since the last call. */
+    bool updateCachePrefix();
+
+    /** Drops every generated tile if the configuration of the ground or of
+     * its workers changed since the last generation. It is called when
+     * entering the ground, so that the workers can be configured at any
+     * time. */
+    void checkConfiguration();
+
+    /** Drops every tile, including the ones published for the asynchronous
+     * collects. */
+    void removeAllTiles();
+
+    /** Gets the key of the cache entry for the given tile. kind is 't' for
+     * the terrain, 'x' for the texture and 'm' for the mesh. */
+    std::string getCacheKey(const TileCoordinates &key, char kind);
+
+    bool loadTerrain(Tile &tile);
+
+    void saveTerrain(const Tile &tile);
+
+    bool loadTexture(Tile &tile);
+
+    void saveTexture(const Tile &tile);
+
+    bool loadMesh(Tile &tile);
+
+    void saveMesh(const Tile &tile);
 
 
     // GENERATION
@@ -129,8 +297,29 @@ private:
      * the terrains already exist they are not generated again. */
     void generateTerrains(const std::set<TileCoordinates> &keys);
 
+    /** Run the texturers on the tiles located at the given keys, if their
+     * texture is not generated yet. The terrains must be generated. */
+    void generateTextures(const std::set<TileCoordinates> &keys);
+
+    /** Paint an image on the texture of a tile, see #paintTexture. */
+    void applyPaint(Tile &tile, const TexturePaint &paint);
+
+    /** Free the textures of the tiles that are not in the given set. The
+     * textures are generated again when the tiles are collected, with their
+     * paints. */
+    void releaseTextures(const std::set<TileCoordinates> &keep);
+
     void generateMesh(const TileCoordinates &key);
 
+    /** Reduces the storages to the memory budget, and withdraws the evicted
+     * tiles from the asynchronous collects. */
+    void reduceStorage();
+
+    /** Generates a tile requested by an asynchronous collect, then
+     * publishes it. This method is run by the generation thread, the
+     * asynchronous collects do not wait for it. */
+    void generateAsync(const TileCoordinates &key);
+
     friend class PGround;
     friend class GroundContext;
 };
@@ -3,9 +3,16 @@
 
 #include "world/core/WorldConfig.h"
 
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <typeinfo>
+
 #include "world/core/TileSystem.h"
+#include "world/math/RandomStream.h"
 
 #include "Terrain.h"
+#include "world/assets/CompactMesh.h"
 #include "world/core/GridStorage.h"
 
 namespace world {
@@ -14,16 +21,21 @@ class WORLDAPI_EXPORT TerrainTile {
 public:
     TileCoordinates _key;
     Terrain _terrain;
-    Mesh _mesh;
+    /// Not modified once generated, so that it can be shared with the
+    /// collectors
+    std::shared_ptr<CompactMesh> _mesh;
 
 
-    TerrainTile(TileCoordinates key, int size) : _key(key), _terrain(size) {}
+    TerrainTile(TileCoordinates key, int size, int border = 0)
+            : _key(key), _terrain(size, TerrainStorage::FLOAT64, border),
+              _mesh(std::make_shared<CompactMesh>(
+                  CompactMesh::NormalFormat::SNORM16)) {}
 
     Terrain &terrain() { return _terrain; }
 
     Image &texture() { return _terrain.getTexture(); }
 
-    Mesh &mesh() { return _mesh; }
+    CompactMesh &mesh() { return *_mesh; }
 };
 
 class WORLDAPI_EXPORT ITileContext {
@@ -49,6 +61,16 @@ public:
     */
 };
 
+/** A point of a tile whose height is computed without generating the tile,
+ * see ITerrainWorker::processPoint. */
+struct WORLDAPI_EXPORT TerrainPoint {
+    TileCoordinates _coords;
+    /** Bounds of the tile, like Terrain::getBoundingBox */
+    BoundingBox _bbox;
+    /** Position of the point in the tile, between 0 and 1 on each axis */
+    vec2d _pos;
+};
+
 class WORLDAPI_EXPORT ITerrainWorker {
 public:
     virtual ~ITerrainWorker() = default;
@@ -65,6 +87,58 @@ public:
 
     virtual void processTile(ITileContext &context) = 0;
 
+    /** Returns true if #processTile can be called on several tiles of the
+     * same level of detail at the same time, from different threads. Workers
+     * that are not reentrant always process their tiles one after the other
+     * on the calling thread. */
+    virtual bool isReentrant() const { return false; }
+
+    /** Returns true if the worker computes the border samples of the
+     * terrains it modifies (see Terrain::getBorder) like the inner ones, or
+     * if it does not modify the heights at all. When a worker of the chain
+     * does not, HeightmapGround extrapolates the borders of the tiles from
+     * their inner samples after the generation. */
+    virtual bool fillsBorder() const { return false; }
+
+    /** Returns true if the worker only generates the texture of the tiles.
+     * HeightmapGround runs the texturers separately from the other workers,
+     * once the heights of a tile are generated and only if the texture of
+     * the tile is actually needed. */
+    virtual bool isTexturer() const { return false; }
+
+    /** Returns true if the worker can compute the height of a single point
+     * with #processPoint. When all the workers of a level of detail can,
+     * HeightmapGround answers the altitude queries on the tiles that are
+     * not generated yet without generating them. */
+    virtual bool supportsPoints() const { return false; }
+
+    /** Compute the height of a single point of a tile, from the height
+     * given by the previous workers at this point. At the samples of the
+     * tile, the result must be the one #processTile would produce. Only
+     * called if #supportsPoints returns true. */
+    virtual double processPoint(const TerrainPoint &point, double height) {
+        throw std::runtime_error("Worker does not support points");
+    }
+
+    /** Set the seed of all the random values used by this worker. A worker
+     * with a given seed must always produce the same tile at the same
+     * coordinates, whatever the order in which the tiles are processed.
+     * HeightmapGround gives each of its workers a seed derived from its
+     * own. */
+    virtual void setSeed(u64 seed) {}
+
+    /** Called instead of #processTile when the tile was loaded from a cache.
+     * Workers that keep information about the tiles they processed can
+     * restore it from the final tile. */
+    virtual void restoreTile(ITileContext &context) {}
+
+    /** Writes all the parameters that have an influence on the generated
+     * tiles. Two workers that write the same configuration must produce the
+     * same tiles: this is used to know if cached tiles are still valid. */
+    virtual void writeConfig(std::ostream &stream) const {
+        stream << typeid(*this).name() << ";";
+    }
+
     /** This method apply all modifications to the terrains before the next
      * worker starts processing. This may be useful if this ITerrainWorker can
      * run several jobs concurrently. */
@@ -1,64 +1,119 @@
-#include <world/assets/ImageUtils.h>
 #include "MultilayerGroundTexture.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace world {
 
 using MultilayerElement = MultilayerGroundTexture::Element;
 
+namespace {
+
+/** Cubic interpolation weights of each texel of an axis, with the same
+ * sample positions as Terrain::getCubicHeight. They are the same for all
+ * the texels of a row or of a column, so they are computed once per axis. */
+struct CubicAxis {
+    std::vector<int> _indices;
+    std::vector<float> _weights;
+
+    CubicAxis(int texelCount, int terrainRes)
+            : _indices(texelCount * 4), _weights(texelCount * 4) {
+        for (int i = 0; i < texelCount; ++i) {
+            double t = double(i) / (texelCount - 1) * terrainRes;
+            int ti = static_cast<int>(floor(t));
+            double x = t - ti, x2 = x * x, x3 = x2 * x;
+
+            // Coefficients of each value in cuberp
+            double weights[4] = {-x3 / 2 + x2 - x / 2, 3 * x3 / 2 - 5 * x2 / 2 + 1,
+                                 -3 * x3 / 2 + 2 * x2 + x / 2, x3 / 2 - x2 / 2};
+
+            for (int k = 0; k < 4; ++k) {
+                _indices[i * 4 + k] = clamp(ti + k, 0, terrainRes - 1);
+                _weights[i * 4 + k] = float(weights[k]);
+            }
+        }
+    }
+};
+
+double ramp(double a, double b, double c, double d, double lowb, double highb,
+            double x) {
+    double ya = (x - a) / (b - a);
+    double yc = (d - x) / (d - c);
+    double yr = min(ya, yc);
+    return clamp(yr, lowb, highb);
+}
+} // namespace
+
 MultilayerGroundTexture::MultilayerGroundTexture() = default;
 
 void MultilayerGroundTexture::processTerrain(Terrain &terrain) {
-    process(terrain, terrain.getTexture(), {});
+    process(terrain, terrain.getTexture(), {}, false);
 }
 
 void MultilayerGroundTexture::processTile(ITileContext &context) {
     process(context.getTile().terrain(), context.getTile().texture(),
-            context.getCoords());
+            context.getCoords(), true);
 }
 
 void MultilayerGroundTexture::addLayer(DistributionParams params) {
     _layers.push_back(params);
 }
 
-GridStorageBase *MultilayerGroundTexture::getStorage() { return &_storage; }
-
-double ramp(double a, double b, double c, double d, double lowb, double highb,
-            double x) {
-    double ya = (x - a) / (b - a);
-    double yc = (d - x) / (d - c);
-    double yr = min(ya, yc);
-    return clamp(yr, lowb, highb);
-}
+void MultilayerGroundTexture::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
 
-void MultilayerGroundTexture::process(Terrain &terrain, Image &image,
-                                      const TileCoordinates &tc) {
+    for (const DistributionParams &layer : _layers) {
+        stream << layer;
+    }
 
-    if (_texProvider == nullptr) {
-        throw std::runtime_error("Texture provider is nullptr");
+    if (_texProvider != nullptr) {
+        _texProvider->writeConfig(stream);
     }
+}
 
-    const int imWidth = image.width();
-    const int imHeight = image.height();
-    const u32 tRes = u32(terrain.getResolution());
-    Image proxy(imWidth, imHeight, ImageType::RGBA);
+void MultilayerGroundTexture::addDefaultLayers() {
+    // Rock
+    addLayer(DistributionParams{-1, 0, 1, 2, // h
+                                -1, 0, 1, 2, // dh
+                                0, 1, 0, 1, 0.2});
+    // Sand
+    addLayer(DistributionParams{-1, 0, 0.4, 0.45, // h
+                                -1, 0, 0.4, 0.6,  // dh
+                                0, 1, 0, 1, 0.2});
+    // Soil
+    addLayer(DistributionParams{0.33, 0.4, 0.6, 0.75, // h
+                                -1, 0, 0.4, 0.9,      // dh
+                                0, 0.85, 0.25, 0.85, 0.2});
+    // Grass
+    addLayer(DistributionParams{0.33, 0.4, 0.6, 0.7, // h
+                                -1, 0, 0.2, 0.6,     // dh
+                                0., 1., 0.25, 0.6, 0.2});
+    // Snow
+    addLayer(DistributionParams{0.65, 0.8, 1, 2, // h
+                                -1, 0, 0.5, 0.7, // dh
+                                0.0, 1.0, 0, 1., 0.2});
+}
 
-    MultilayerElement &elem = _storage.getOrCreate(tc);
+GridStorageBase *MultilayerGroundTexture::getStorage() { return &_storage; }
 
-    for (size_t layer = 0; layer < _layers.size(); ++layer) {
-        // Compute distribution
-        elem._distributions.emplace_back(tRes);
-        Terrain &distrib = elem._distributions.back();
+void MultilayerGroundTexture::computeDistributions(const Terrain &terrain,
+                                                   MultilayerElement &elem) {
+    const int tRes = terrain.getResolution();
+    const arma::mat heights = terrain.toMatrix();
+    const arma::mat slopes = terrain.getSlopes();
+    elem._distributions.clear();
 
-        DistributionParams &params = _layers.at(layer);
+    for (const DistributionParams &params : _layers) {
+        // Compute distribution, in [0, 1]
+        elem._distributions.emplace_back(tRes, TerrainStorage::UINT16);
+        Terrain &distrib = elem._distributions.back();
 
-        for (u32 y = 0; y < tRes; ++y) {
-            for (u32 x = 0; x < tRes; ++x) {
+        for (int y = 0; y < tRes; ++y) {
+            for (int x = 0; x < tRes; ++x) {
                 // See shader distribution-height.frag in vkworld for more
                 // details
-                vec2d uv = vec2d{vec2u{x, y}} / (tRes - 1);
-                double h = terrain.getExactHeightAt(uv.x, uv.y);
-                double dh =
-                    std::atan(terrain.getSlopeAt(uv.x, uv.y)) * 2.0 / M_PI;
+                double h = heights(x, y);
+                double dh = std::atan(slopes(x, y)) * 2.0 / M_PI;
 
                 double r1 = ramp(params.ha, params.hb, params.hc, params.hd,
                                  params.hmin, params.hmax, h);
@@ -67,40 +122,118 @@ void MultilayerGroundTexture::process(Terrain &terrain, Image &image,
                 double r = r1 * r2;
                 double t = 0.5; // TODO perlin(noiseParams, uv.x, uv.y, 0);
 
-                distrib(x, y) =
-                    smoothstep(r + params.threshold, r - params.threshold, t);
+                distrib.setHeight(x, y, smoothstep(r + params.threshold,
+                                                   r - params.threshold, t));
             }
         }
+    }
+}
 
-        // Sum with final image
-        Image &layerTex = _texProvider->getTexture(layer, tc._lod);
-        const int texWidth = layerTex.width();
-        const int texHeight = layerTex.height();
-        vec2i offset(world::mod<int>(tc._pos.x * imWidth, texWidth),
-                     world::mod<int>(tc._pos.y * imHeight, texHeight));
+void MultilayerGroundTexture::process(Terrain &terrain, Image &image,
+                                      const TileCoordinates &tc, bool reuse) {
+
+    if (_texProvider == nullptr) {
+        throw std::runtime_error("Texture provider is nullptr");
+    }
+
+    const int imWidth = image.width();
+    const int imHeight = image.height();
+    const int tRes = terrain.getResolution();
+    const size_t layerCount = _layers.size();
+
+    MultilayerElement &elem = _storage.getOrCreate(tc);
+
+    if (!reuse || elem._distributions.size() != layerCount) {
+        computeDistributions(terrain, elem);
+    }
+
+    // The distributions are resampled to the size of the image with a
+    // separable cubic interpolation: along x for each row of the
+    // distribution first, then along y for each row of the image.
+    const CubicAxis xs(imWidth, tRes), ys(imHeight, tRes);
+    std::vector<float> distribRows(layerCount * tRes * imWidth);
+
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        const arma::mat distrib = elem._distributions[layer].toMatrix();
+
+        for (int y = 0; y < tRes; ++y) {
+            const double *src = distrib.colptr(y);
+            float *dst = &distribRows[(layer * tRes + y) * imWidth];
 
-        for (int y = 0; y < imHeight; ++y) {
             for (int x = 0; x < imWidth; ++x) {
-                auto origin = proxy.rgba(x, y);
-                auto texPix = layerTex.rgba((x + offset.x) % texWidth,
-                                            (y + offset.y) % texHeight);
-
-                vec2d uv =
-                    vec2d{vec2i{x, y}} / vec2i{imWidth - 1, imHeight - 1};
-                double p = distrib.getCubicHeight(uv.x, uv.y);
-                double alpha = p * texPix.getAlphaf();
-
-                auto &dest = proxy.rgba(x, y);
-                dest.setf(
-                    origin.getRedf() * (1 - alpha) + texPix.getRedf() * alpha,
-                    origin.getGreenf() * (1 - alpha) +
-                        texPix.getGreenf() * alpha,
-                    origin.getBluef() * (1 - alpha) + texPix.getBluef() * alpha,
-                    origin.getAlphaf() + (1 - texPix.getAlphaf()) * alpha);
+                const int *i = &xs._indices[x * 4];
+                const float *w = &xs._weights[x * 4];
+                dst[x] = float(w[0] * src[i[0]] + w[1] * src[i[1]] +
+                               w[2] * src[i[2]] + w[3] * src[i[3]]);
             }
         }
     }
 
-    image = ImageUtils::toType(proxy, ImageType::RGB);
+    // Texture of each layer, and where the tile starts in it
+    std::vector<const Image *> layerTexs(layerCount);
+    std::vector<vec2i> offsets(layerCount);
+
+    for (size_t layer = 0; layer < layerCount; ++layer) {
+        const Image &layerTex = _texProvider->getTexture(int(layer), tc._lod);
+        layerTexs[layer] = &layerTex;
+        offsets[layer] = {world::mod<int>(tc._pos.x * imWidth, layerTex.width()),
+                          world::mod<int>(tc._pos.y * imHeight,
+                                          layerTex.height())};
+    }
+
+    if (image.type() != ImageType::RGB) {
+        image = Image(imWidth, imHeight, ImageType::RGB);
+    }
+
+    // All the layers are blended in one pass over each row, in BGR order
+    std::vector<float> colors(imWidth * 3);
+    std::vector<float> p(imWidth);
+
+    for (int y = 0; y < imHeight; ++y) {
+        std::fill(colors.begin(), colors.end(), 0.f);
+        const int *iy = &ys._indices[y * 4];
+        const float *wy = &ys._weights[y * 4];
+
+        for (size_t layer = 0; layer < layerCount; ++layer) {
+            const float *rows = &distribRows[layer * tRes * imWidth];
+            const float *r0 = rows + iy[0] * imWidth;
+            const float *r1 = rows + iy[1] * imWidth;
+            const float *r2 = rows + iy[2] * imWidth;
+            const float *r3 = rows + iy[3] * imWidth;
+
+            for (int x = 0; x < imWidth; ++x) {
+                p[x] = wy[0] * r0[x] + wy[1] * r1[x] + wy[2] * r2[x] +
+                       wy[3] * r3[x];
+            }
+
+            const Image &layerTex = *layerTexs[layer];
+            const int texWidth = layerTex.width();
+            const int elemSize = layerTex.elemSize();
+            const bool hasAlpha = elemSize == 4;
+            const int texY = (y + offsets[layer].y) % layerTex.height();
+            const u8 *texRow = layerTex.data() + texY * texWidth * elemSize;
+            int texX = offsets[layer].x;
+
+            for (int x = 0; x < imWidth; ++x) {
+                const u8 *texPix = texRow + texX * elemSize;
+                float alpha = p[x] * (hasAlpha ? texPix[3] : 255) / 255.f;
+                float *color = &colors[x * 3];
+
+                for (int c = 0; c < 3; ++c) {
+                    color[c] += (texPix[c] / 255.f - color[c]) * alpha;
+                }
+
+                if (++texX == texWidth) {
+                    texX = 0;
+                }
+            }
+        }
+
+        u8 *dst = image.data() + y * imWidth * 3;
+
+        for (int i = 0; i < imWidth * 3; ++i) {
+            dst[i] = static_cast<u8>(clamp(colors[i], 0.f, 1.f) * 255.f);
+        }
+    }
 }
 } // namespace world
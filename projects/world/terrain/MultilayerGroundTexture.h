@@ -14,12 +14,27 @@ public:
     virtual ~ITextureProvider() = default;
 
     virtual Image &getTexture(int layer, int lod) = 0;
+
+    /** Writes all the parameters that have an influence on the textures,
+     * see ITerrainWorker::writeConfig. */
+    virtual void writeConfig(std::ostream &stream) const {
+        stream << typeid(*this).name() << ";";
+    }
 };
 
 class WORLDAPI_EXPORT MultilayerGroundTexture : public ITerrainWorker {
 public:
     struct Element : public IGridElement {
         std::vector<Terrain> _distributions;
+
+        size_t getMemoryUsage() const override {
+            size_t bytes = 0;
+
+            for (const Terrain &distribution : _distributions) {
+                bytes += distribution.getMemoryUsage();
+            }
+            return bytes;
+        }
     };
 
     MultilayerGroundTexture();
@@ -31,10 +46,21 @@ public:
 
     void processTile(ITileContext &context) override;
 
+    bool fillsBorder() const override { return true; }
+
+    bool isTexturer() const override { return true; }
+
     void addLayer(DistributionParams params);
 
+    /** Add the layers of VkwMultilayerGroundTexture::addDefaultLayers: rock,
+     * sand, soil, grass and snow. The texture provider gives the texture of
+     * each of them. */
+    void addDefaultLayers();
+
     GridStorageBase *getStorage() override;
 
+    void writeConfig(std::ostream &stream) const override;
+
 private:
     GridStorage<Element> _storage;
 
@@ -42,7 +68,15 @@ private:
     std::vector<DistributionParams> _layers;
 
 
-    void process(Terrain &terrain, Image &image, const TileCoordinates &tc);
+    /** Compute the distribution of each layer at the resolution of the
+     * terrain. */
+    void computeDistributions(const Terrain &terrain, Element &elem);
+
+    /** Blend the layers in the image. The distributions are computed again
+     * only if they are not cached for the given tile, or if reuse is
+     * false. */
+    void process(Terrain &terrain, Image &image, const TileCoordinates &tc,
+                 bool reuse);
 };
 
 template <typename T, typename... Args>
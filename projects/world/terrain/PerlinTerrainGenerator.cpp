@@ -25,6 +25,22 @@ PerlinTerrainGenerator::PerlinTerrainGenerator(int octaveCount,
     _perlinInfo.offsetY = 0;
 }
 
+template <typename... Args>
+void PerlinTerrainGenerator::generateNoise(Terrain &terrain, PerlinInfo info,
+                                           Args &&... args) {
+    info.border = terrain._border;
+
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        _perlin.generatePerlinNoise2D(terrain._array, info,
+                                      std::forward<Args>(args)...);
+    } else {
+        mat heights(terrain._stride, terrain._stride);
+        _perlin.generatePerlinNoise2D(heights, info,
+                                      std::forward<Args>(args)...);
+        terrain.setHeights(heights);
+    }
+}
+
 void PerlinTerrainGenerator::setFrequency(double frequency) {
     _perlinInfo.frequency = frequency;
 }
@@ -42,12 +58,27 @@ void PerlinTerrainGenerator::setMaxOctaveCount(u32 maxOctaveCount) {
 }
 
 void PerlinTerrainGenerator::processTerrain(Terrain &terrain) {
-    _perlin.generatePerlinNoise2D(terrain._array, _perlinInfo);
+    generateNoise(terrain, _perlinInfo);
 
     // Normalize relatively to the first lod level
     TerrainOps::multiply(terrain, 1 / _perlin.getMaxPossibleValue(_perlinInfo));
 }
 
+void PerlinTerrainGenerator::setSeed(u64 seed) {
+    _perlin = Perlin(seed);
+    _perlin.setNormalize(false);
+}
+
+void PerlinTerrainGenerator::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _perlinInfo.octaves << " " << _perlinInfo.persistence << " "
+           << _perlinInfo.frequency << " " << _maxOctaves << ";";
+
+    for (u8 h : _perlin.getHash()) {
+        stream << static_cast<int>(h) << ",";
+    }
+}
+
 void PerlinTerrainGenerator::processTile(ITileContext &context) {
     processByTileCoords(context.getTile().terrain(), context);
 }
@@ -88,15 +119,21 @@ void PerlinTerrainGenerator::processByNeighbours(world::Terrain &terrain,
         }
     };
 
-    _perlin.generatePerlinNoise2D(terrain._array, _perlinInfo, modifier);
+    generateNoise(terrain, _perlinInfo, modifier);
 
     _storage.set(tc, terrain);
 }
 
-void PerlinTerrainGenerator::processByTileCoords(Terrain &terrain,
-                                                 ITileContext &context) {
+double PerlinTerrainGenerator::processPoint(const TerrainPoint &point,
+                                            double height) {
+    return _perlin.getValue(point._pos.x, point._pos.y,
+                            getTileInfo(point._coords)) /
+           _perlin.getMaxPossibleValue(_perlinInfo);
+}
+
+PerlinInfo PerlinTerrainGenerator::getTileInfo(const TileCoordinates &coords,
+                                               int border) const {
     PerlinInfo localInfo = _perlinInfo;
-    TileCoordinates coords = context.getCoords();
     localInfo.reference = coords._lod;
     // TODO require the frequency to be integer to avoid confusion
     vec2i tileCoords =
@@ -106,8 +143,13 @@ void PerlinTerrainGenerator::processByTileCoords(Terrain &terrain,
     localInfo.octaves += localInfo.reference;
     if (_maxOctaves > 0 && localInfo.octaves > _maxOctaves)
         localInfo.octaves = _maxOctaves;
+    localInfo.border = border;
+    return localInfo;
+}
 
-    _perlin.generatePerlinNoise2D(terrain._array, localInfo);
+void PerlinTerrainGenerator::processByTileCoords(Terrain &terrain,
+                                                 ITileContext &context) {
+    generateNoise(terrain, getTileInfo(context.getCoords()));
 
     // Normalize relatively to the first lod level
     TerrainOps::multiply(terrain, 1 / _perlin.getMaxPossibleValue(_perlinInfo));
@@ -33,6 +33,18 @@ public:
 
     void processTile(ITileContext &context) override;
 
+    bool isReentrant() const override { return true; }
+
+    bool fillsBorder() const override { return true; }
+
+    bool supportsPoints() const override { return true; }
+
+    double processPoint(const TerrainPoint &point, double height) override;
+
+    void writeConfig(std::ostream &stream) const override;
+
+    void setSeed(u64 seed) override;
+
 private:
     PerlinInfo _perlinInfo;
     Perlin _perlin;
@@ -40,8 +52,21 @@ private:
 
     TerrainGrid _storage;
 
+    friend class PerlinStage;
+
+    /** Parameters of the noise of the tile at the given coordinates, with
+     * the given number of border samples */
+    PerlinInfo getTileInfo(const TileCoordinates &coords,
+                           int border = 0) const;
+
     void processByNeighbours(Terrain &terrain, ITileContext &context);
 
     void processByTileCoords(Terrain &terrain, ITileContext &context);
+
+    /** Generates the noise directly in the terrain if it stores doubles,
+     * or in a temporary matrix which is then copied in the terrain. The
+     * borders of the terrain are generated too. */
+    template <typename... Args>
+    void generateNoise(Terrain &terrain, PerlinInfo info, Args &&... args);
 };
 } // namespace world
@@ -15,8 +15,7 @@ namespace world {
 
 // -----
 ReliefMapModifier::ReliefMapModifier(double width, int resolution)
-        : _rng(static_cast<u32>(time(NULL))),
-          _tileSystem(0, vec3i{resolution, resolution, 0},
+        : _tileSystem(0, vec3i{resolution, resolution, 0},
                       vec3d{width, width, 0}) {}
 
 void ReliefMapModifier::setMapResolution(int mapres) {
@@ -24,54 +23,85 @@ void ReliefMapModifier::setMapResolution(int mapres) {
 }
 
 void ReliefMapModifier::processTerrain(Terrain &terrain) {
-    // Terrain
-    int size = terrain.getResolution();
-
-    // Map
-    ReliefMapEntry &reliefMap = provideMap(0, 0);
-    Terrain &heightMap = reliefMap._height;
-    Terrain &diffMap = reliefMap._diff;
-
-    // Setup variables
-    const vec3d terrainDims = terrain.getBoundingBox().getDimensions();
-    const vec3d terrainPos = terrain.getBoundingBox().getLowerBound();
-    const double mapSize = _tileSystem._baseSize.x;
-    const double ratio = terrainDims.x / mapSize;
-    const double mapOx = 0.5 + terrainPos.x / mapSize;
-    const double mapOy = 0.5 + terrainPos.y / mapSize;
+    const int size = terrain.getResolution();
+    const int border = terrain.getBorder();
+    TerrainRelief relief(*this, provideMap(0, 0), terrain);
+    std::vector<double> row(terrain.getBufferResolution());
+
+    for (int y = -border; y < size + border; y++) {
+        for (int x = -border; x < size + border; x++) {
+            row[x + border] = terrain(x, y);
+        }
 
-    const double offsetCoef = 0.5;
-    const double diffCoef = 1 - offsetCoef;
+        relief.applyToRow(y, row.data());
 
-    // std::cout << "apply to " << mapOx << ", " << mapOy << std::endl;
+        for (int x = -border; x < size + border; x++) {
+            terrain(x, y) = row[x + border];
+        }
+    }
+}
 
-    arma::mat bufferOffset(size, size);
-    arma::mat bufferDiff(size, size);
+namespace {
 
-    for (int x = 0; x < size; x++) {
-        for (int y = 0; y < size; y++) {
-            double mapX = mapOx + ((double)x / (size - 1)) * ratio;
-            double mapY = mapOy + ((double)y / (size - 1)) * ratio;
+/** Contribution of each map to the final height */
+const double OFFSET_COEF = 0.5;
+const double DIFF_COEF = 1 - OFFSET_COEF;
 
-            double offset = heightMap.getCubicHeight(mapX, mapY) * offsetCoef;
-            double diff = diffMap.getCubicHeight(mapX, mapY) * diffCoef;
+/** Distance between two samples of the terrain in the relief map. */
+double getMapStep(const Terrain &terrain, double mapSize) {
+    const vec3d terrainDims = terrain.getBoundingBox().getDimensions();
+    return terrainDims.x / mapSize / (terrain.getResolution() - 1);
+}
 
-            bufferOffset(x, y) = offset;
-            bufferDiff(x, y) = diff;
+/** Coordinates of the first sample of the terrain (at x = y = -border) in
+ * the relief map. */
+vec2d getMapOrigin(const Terrain &terrain, double mapSize) {
+    const vec3d terrainPos = terrain.getBoundingBox().getLowerBound();
+    const double step = getMapStep(terrain, mapSize);
+    const double border = terrain.getBorder();
 
-            // to unapply
-            // bufferOffset(x, y) = -offset;
-            // bufferDiff(x, y) = diff > std::numeric_limits<double>::epsilon()
-            // ? 1 / diff : 0;
-        }
+    return {0.5 + terrainPos.x / mapSize - border * step,
+            0.5 + terrainPos.y / mapSize - border * step};
+}
+} // namespace
+
+ReliefMapModifier::TerrainRelief::TerrainRelief(
+    const ReliefMapModifier &modifier, const ReliefMapEntry &map,
+    const Terrain &terrain)
+        : _offset(map._height, TerrainResampler::Mode::CUBIC,
+                  getMapOrigin(terrain, modifier._tileSystem._baseSize.x),
+                  getMapStep(terrain, modifier._tileSystem._baseSize.x),
+                  terrain.getBufferResolution()),
+          _diff(map._diff, TerrainResampler::Mode::CUBIC,
+                getMapOrigin(terrain, modifier._tileSystem._baseSize.x),
+                getMapStep(terrain, modifier._tileSystem._baseSize.x),
+                terrain.getBufferResolution()),
+          _border(terrain.getBorder()),
+          _offsetRow(terrain.getBufferResolution()),
+          _diffRow(terrain.getBufferResolution()) {}
+
+void ReliefMapModifier::TerrainRelief::applyToRow(int y, double *heights) {
+    _offset.getRow(y + _border, _offsetRow.data());
+    _diff.getRow(y + _border, _diffRow.data());
+
+    for (size_t x = 0; x < _offsetRow.size(); x++) {
+        // to unapply: (h - offset) / diff
+        heights[x] = heights[x] * _diffRow[x] * DIFF_COEF +
+                     _offsetRow[x] * OFFSET_COEF;
     }
+}
 
-    TerrainOps::multiply(terrain, bufferDiff);
-    TerrainOps::applyOffset(terrain, bufferOffset);
+double ReliefMapModifier::processPoint(const TerrainPoint &point,
+                                       double height) {
+    const ReliefMapEntry &map = provideMap(0, 0);
+    const double mapSize = _tileSystem._baseSize.x;
+    const vec3d lower = point._bbox.getLowerBound();
+    const vec3d dims = point._bbox.getDimensions();
+    const double mapX = 0.5 + (lower.x + point._pos.x * dims.x) / mapSize;
+    const double mapY = 0.5 + (lower.y + point._pos.y * dims.y) / mapSize;
 
-    // To unapply
-    // TerrainOps::applyOffset(terrain, bufferOffset);
-    // TerrainOps::multiply(terrain, bufferDiff);
+    return height * map._diff.getCubicHeight(mapX, mapY) * DIFF_COEF +
+           map._height.getCubicHeight(mapX, mapY) * OFFSET_COEF;
 }
 
 void ReliefMapModifier::processTile(ITileContext &context) {
@@ -82,9 +112,45 @@ const ReliefMapEntry &ReliefMapModifier::obtainMap(int x, int y) {
     return provideMap(x, y);
 }
 
+void ReliefMapModifier::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _seed << ";" << _tileSystem._baseSize << _tileSystem._bufferRes
+           << ";";
+
+    for (const Region &region : _regions) {
+        stream << region._center << region._radius << " "
+               << region._curvature << " " << region._height << " "
+               << region._diff << ";";
+    }
+}
+
+void ReliefMapModifier::setSeed(u64 seed) {
+    std::lock_guard<std::mutex> lock(_reliefMapMutex);
+    _seed = seed;
+    _reliefMap = GridStorage<ReliefMapEntry>();
+}
+
 void ReliefMapModifier::setRegion(const vec2d &center, double radius,
                                   double curvature, double height,
                                   double diff) {
+    std::lock_guard<std::mutex> lock(_reliefMapMutex);
+    _regions.push_back({center, radius, curvature, height, diff});
+
+    // If the map is not generated yet, the region is applied at generation
+    ReliefMapEntry *map;
+
+    if (_reliefMap.tryGet(TileCoordinates({0, 0, 0}, 0), &map)) {
+        applyRegion(*map, _regions.back());
+    }
+}
+
+void ReliefMapModifier::applyRegion(ReliefMapEntry &map,
+                                    const Region &region) {
+    const vec2d &center = region._center;
+    const double radius = region._radius;
+    const double curvature = region._curvature;
+    const double height = region._height;
+    const double diff = region._diff;
 
     const vec3d mapOffset = _tileSystem._baseSize / 2;
     const double mapRes = _tileSystem._bufferRes.x;
@@ -97,33 +163,43 @@ void ReliefMapModifier::setRegion(const vec2d &center, double radius,
         (_tileSystem.getLocalCoordinates(coords + hsize, 0) * (mapRes - 1))
             .ceil();
 
-    auto &map = provideMap(0, 0);
-
     const auto interp = [curvature](double x) { return pow(x, curvature); };
 
     for (int x = lmin.x; x < lmax.x; ++x) {
         for (int y = lmin.y; y < lmax.y; ++y) {
-            double prevHeight = map._height(x, y);
-            double prevDiff = map._diff(x, y);
+            double prevHeight = map._height.floatAt(x, y);
+            double prevDiff = map._diff.floatAt(x, y);
 
             const vec2d gc = vec2d(_tileSystem.getGlobalCoordinates(
                 {{}, 0}, vec3d(x, y, 0) / (mapRes - 1)));
             double d = center.length(gc - vec2d(mapOffset));
 
-            map._height(x, y) = Interpolation::interpolate(
-                0, height, radius, prevHeight, d, interp);
-            map._diff(x, y) = Interpolation::interpolate(0, diff, radius,
-                                                         prevDiff, d, interp);
+            map._height.floatAt(x, y) = float(Interpolation::interpolate(
+                0, height, radius, prevHeight, d, interp));
+            map._diff.floatAt(x, y) = float(Interpolation::interpolate(
+                0, diff, radius, prevDiff, d, interp));
         }
     }
 }
 
 ReliefMapEntry &ReliefMapModifier::provideMap(int x, int y) {
+    std::lock_guard<std::mutex> lock(_reliefMapMutex);
     int resolution = _tileSystem._bufferRes.x;
 
+    TileCoordinates coords({x, y, 0}, 0);
+
     return _reliefMap.getOrCreateCallback(
-        TileCoordinates({x, y, 0}, 0),
-        [&](ReliefMapEntry &elem) { generate(elem._height, elem._diff); },
+        coords,
+        [&](ReliefMapEntry &elem) {
+            RandomStream rng(_seed, coords);
+            generate(elem._height, elem._diff, rng);
+
+            if (x == 0 && y == 0) {
+                for (const Region &region : _regions) {
+                    applyRegion(elem, region);
+                }
+            }
+        },
         resolution);
 }
 
@@ -146,7 +222,16 @@ void CustomWorldRMModifier::setDifferentialLaw(const AltDiffParam &law) {
     _diffLaw = law;
 }
 
-void CustomWorldRMModifier::generate(Terrain &height, Terrain &heightDiff) {
+void CustomWorldRMModifier::writeConfig(std::ostream &stream) const {
+    ReliefMapModifier::writeConfig(stream);
+    stream << _biomeDensity << " " << _limitBrightness << ";";
+}
+
+void CustomWorldRMModifier::generate(Terrain &height, Terrain &heightDiff,
+                                     RandomStream &rng) {
+    // The laws draw their values from the parameter stream of this thread
+    Params<double>::rng().seed(rng());
+
     // Nombre de biomes  gnrer.
     int size = height.getResolution() * height.getResolution();
     int biomeCount =
@@ -193,7 +278,7 @@ void CustomWorldRMModifier::generate(Terrain &height, Terrain &heightDiff) {
     for (int i = 0; i < biomeCount; i++) { // TODO dans les cas limites la
                                            // grille peut se vider totalement
         // Gnration des coordonnes des points
-        int randIndex = (int)(rand(_rng) * grid.size());
+        int randIndex = (int)(rand(rng) * grid.size());
         std::pair<int, int> randPoint = grid.at(randIndex);
         grid.erase(grid.begin() + randIndex);
 
@@ -236,8 +321,8 @@ void CustomWorldRMModifier::generate(Terrain &height, Terrain &heightDiff) {
         }
 
         //  partir des limites on peut dterminer la position random du point
-        double randX = rand(_rng);
-        double randY = rand(_rng);
+        double randX = rand(rng);
+        double randY = rand(rng);
 
         // TODO L'utilisateur n'a aucun contrle sur le premier paramtre.
         double elevation = _offsetLaw();
@@ -269,8 +354,8 @@ void CustomWorldRMModifier::generate(Terrain &height, Terrain &heightDiff) {
         for (int y = 0; y < height.getResolution(); y++) {
             vec2d pt(x + 0.5, y + 0.5);
             vec2d result = interpolator.getData(pt);
-            height(x, y) = result.x;
-            heightDiff(x, y) = result.y;
+            height.setHeight(x, y, result.x);
+            heightDiff.setHeight(x, y, result.y);
         }
     }
 }
@@ -4,12 +4,14 @@
 
 #include <vector>
 #include <map>
-#include <random>
 #include <memory>
+#include <mutex>
 
 #include "world/core/TileSystem.h"
+#include "world/math/RandomStream.h"
 #include "ITerrainWorker.h"
 #include "ReliefParameters.h"
+#include "TerrainResampler.h"
 
 namespace world {
 
@@ -17,7 +19,13 @@ struct ReliefMapEntry : public IGridElement {
     Terrain _height;
     Terrain _diff;
 
-    ReliefMapEntry(int resolution) : _height(resolution), _diff(resolution) {}
+    ReliefMapEntry(int resolution)
+            : _height(resolution, TerrainStorage::FLOAT32),
+              _diff(resolution, TerrainStorage::FLOAT32) {}
+
+    size_t getMemoryUsage() const override {
+        return _height.getMemoryUsage() + _diff.getMemoryUsage();
+    }
 };
 
 /** Base class for generating relief maps.
@@ -38,21 +46,76 @@ public:
 
     void processTile(ITileContext &context) override;
 
+    bool isReentrant() const override { return true; }
+
+    bool fillsBorder() const override { return true; }
+
+    bool supportsPoints() const override { return true; }
+
+    double processPoint(const TerrainPoint &point, double height) override;
+
+    void writeConfig(std::ostream &stream) const override;
+
+    /** Set the seed of the relief maps. The maps already generated are
+     * dropped, and generated again with the new seed. */
+    void setSeed(u64 seed) override;
+
+    /** Part of a relief map that covers one terrain, resampled at the
+     * resolution of the terrain. */
+    class WORLDAPI_EXPORT TerrainRelief {
+    public:
+        TerrainRelief(const ReliefMapModifier &modifier,
+                      const ReliefMapEntry &map, const Terrain &terrain);
+
+        /** Apply the relief map to the row y of the terrain: each height
+         * is multiplied by the height differential of the map, then the
+         * offset of the map is added. heights holds the samples of the
+         * row, from x = -border to x = resolution + border - 1. */
+        void applyToRow(int y, double *heights);
+
+    private:
+        TerrainResampler _offset;
+        TerrainResampler _diff;
+        int _border;
+        std::vector<double> _offsetRow;
+        std::vector<double> _diffRow;
+    };
+
     const ReliefMapEntry &obtainMap(int x, int y);
 
     void setRegion(const vec2d &center, double radius, double curvature,
                    double height, double diff);
 
 protected:
-    mutable std::mt19937 _rng;
+    struct Region {
+        vec2d _center;
+        double _radius;
+        double _curvature;
+        double _height;
+        double _diff;
+    };
+
+    u64 _seed = DEFAULT_SEED;
     TileSystem _tileSystem;
 
     GridStorage<ReliefMapEntry> _reliefMap;
+    /** Protects the relief map storage when tiles are processed
+     * concurrently. */
+    std::mutex _reliefMapMutex;
+    /** Parameters of all the calls to #setRegion. They are applied again
+     * each time the central map is generated. */
+    std::vector<Region> _regions;
 
 
     ReliefMapEntry &provideMap(int x, int y);
 
-    virtual void generate(Terrain &height, Terrain &heightDiff) = 0;
+    void applyRegion(ReliefMapEntry &map, const Region &region);
+
+    /** Generates the relief map. All the random values are taken from the
+     * given stream, which only depends on the seed and on the position of
+     * the map. */
+    virtual void generate(Terrain &height, Terrain &heightDiff,
+                          RandomStream &rng) = 0;
 };
 
 class WORLDAPI_EXPORT CustomWorldRMModifier : public ReliefMapModifier {
@@ -65,8 +128,11 @@ public:
 
     void setDifferentialLaw(const AltDiffParam &law);
 
+    void writeConfig(std::ostream &stream) const override;
+
 protected:
-    void generate(Terrain &height, Terrain &heightDiff) override;
+    void generate(Terrain &height, Terrain &heightDiff,
+                  RandomStream &rng) override;
 
 private:
     // la largeur d'un carr unit.
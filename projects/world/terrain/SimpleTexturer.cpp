@@ -3,14 +3,29 @@
 namespace world {
 
 SimpleTexturer::SimpleTexturer()
-        : _rng(static_cast<u32>(time(NULL))), _colorMap({513, 65}) {}
+        : _colorMap({513, 65}) {}
 
 ColorMap &SimpleTexturer::getColorMap() { return _colorMap; }
 
 void SimpleTexturer::processTerrain(Terrain &terrain) {
+    RandomStream rng(_seed, terrain.getBoundingBox().getLowerBound());
+    processTerrain(terrain, rng);
+}
+
+void SimpleTexturer::processTile(ITileContext &context) {
+    RandomStream rng(_seed, context.getCoords());
+    processTerrain(context.getTile().terrain(), rng);
+}
+
+void SimpleTexturer::processTerrain(Terrain &terrain, RandomStream &rng) {
     Image &texture = terrain.getTexture();
     auto dims = terrain.getBoundingBox().getDimensions();
 
+    {
+        std::lock_guard<std::mutex> lock(_colorMapMutex);
+        _colorMap.update();
+    }
+
     std::uniform_real_distribution<double> positive(0, 1);
 
     for (int x = 0; x < texture.width(); x++) {
@@ -22,7 +37,7 @@ void SimpleTexturer::processTerrain(Terrain &terrain) {
 
             // get the parameters to pick in the colormap
             double p1 = clamp(altitude, 0, 1);
-            double p2 = positive(_rng);
+            double p2 = positive(rng);
 
             // pick the color
             Color4d color = _colorMap.getColorAt({p1, p2});
@@ -33,7 +48,9 @@ void SimpleTexturer::processTerrain(Terrain &terrain) {
     }
 }
 
-void SimpleTexturer::processTile(ITileContext &context) {
-    processTerrain(context.getTile().terrain());
+void SimpleTexturer::writeConfig(std::ostream &stream) const {
+    ITerrainWorker::writeConfig(stream);
+    stream << _seed << ";";
+    _colorMap.write(stream);
 }
 } // namespace world
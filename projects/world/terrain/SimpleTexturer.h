@@ -3,9 +3,10 @@
 
 #include "world/core/WorldConfig.h"
 
-#include <random>
+#include <mutex>
 
 #include "world/core/ColorMap.h"
+#include "world/math/RandomStream.h"
 #include "ITerrainWorker.h"
 
 namespace world {
@@ -20,9 +21,24 @@ public:
 
     void processTile(ITileContext &context) override;
 
+    bool isReentrant() const override { return true; }
+
+    bool fillsBorder() const override { return true; }
+
+    bool isTexturer() const override { return true; }
+
+    void writeConfig(std::ostream &stream) const override;
+
+    void setSeed(u64 seed) override { _seed = seed; }
+
 private:
-    std::mt19937 _rng;
+    /** Each terrain has its own random stream derived from this seed. */
+    u64 _seed = DEFAULT_SEED;
+    std::mutex _colorMapMutex;
     ColorMap _colorMap;
+
+
+    void processTerrain(Terrain &terrain, RandomStream &rng);
 };
 } // namespace world
 
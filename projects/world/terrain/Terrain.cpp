@@ -14,15 +14,30 @@ using namespace arma;
 
 namespace world {
 
-Terrain::Terrain(int size)
-        : _bbox({-0.5, -0.5, -0.0}, {0.5, 0.5, 0.4}), _array(size, size),
+Terrain::Terrain(int size, TerrainStorage storage, int border)
+        : _bbox({-0.5, -0.5, -0.0}, {0.5, 0.5, 0.4}), _res(size),
+          _border(border), _stride(size + 2 * border), _storage(storage),
           _texture(1, 1, ImageType::RGB) {
 
+    const size_t count = size_t(_stride) * _stride;
+
+    switch (storage) {
+    case TerrainStorage::FLOAT32:
+        _floats.resize(count);
+        break;
+    case TerrainStorage::UINT16:
+        _quantized.resize(count);
+        break;
+    default:
+        _array.set_size(_stride, _stride);
+    }
     _texture.rgb(0, 0).set(255, 255, 255);
 }
 
 Terrain::Terrain(const Mat<double> &data)
-        : _bbox({-0.5, -0.5, -0.0}, {0.5, 0.5, 0.4}), _array(data),
+        : _bbox({-0.5, -0.5, -0.0}, {0.5, 0.5, 0.4}),
+          _res(static_cast<int>(data.n_rows)), _border(0), _stride(_res),
+          _storage(TerrainStorage::FLOAT64), _array(data),
           _texture(1, 1, ImageType::RGB) {
 
     if (data.n_rows != data.n_cols) {
@@ -32,22 +47,112 @@ Terrain::Terrain(const Mat<double> &data)
 }
 
 Terrain::Terrain(const Terrain &terrain)
-        : _bbox(terrain._bbox), _array(terrain._array),
+        : _bbox(terrain._bbox), _res(terrain._res), _border(terrain._border),
+          _stride(terrain._stride), _storage(terrain._storage),
+          _array(terrain._array),
+          _floats(terrain._floats), _quantized(terrain._quantized),
+          _quantMin(terrain._quantMin), _quantStep(terrain._quantStep),
           _texture(terrain._texture) {}
 
 Terrain::Terrain(Terrain &&terrain)
-        : _bbox(terrain._bbox), _array(std::move(terrain._array)),
+        : _bbox(terrain._bbox), _res(terrain._res), _border(terrain._border),
+          _stride(terrain._stride), _storage(terrain._storage),
+          _array(std::move(terrain._array)),
+          _floats(std::move(terrain._floats)),
+          _quantized(std::move(terrain._quantized)),
+          _quantMin(terrain._quantMin), _quantStep(terrain._quantStep),
           _texture(std::move(terrain._texture)) {}
 
 Terrain::~Terrain() = default;
 
 Terrain &Terrain::operator=(const Terrain &terrain) {
     _bbox = terrain._bbox;
+    _res = terrain._res;
+    _border = terrain._border;
+    _stride = terrain._stride;
+    _storage = terrain._storage;
     _array = terrain._array;
+    _floats = terrain._floats;
+    _quantized = terrain._quantized;
+    _quantMin = terrain._quantMin;
+    _quantStep = terrain._quantStep;
     _texture = terrain._texture;
     return *this;
 }
 
+void Terrain::setStorage(TerrainStorage storage, double min, double max) {
+    if (storage == TerrainStorage::UINT16 && max <= min) {
+        throw std::runtime_error("Terrain::setStorage : empty height range");
+    }
+
+    if (storage == _storage && storage != TerrainStorage::UINT16) {
+        return;
+    }
+
+    Mat<double> heights = getHeights();
+    _array.reset();
+    _floats = std::vector<float>();
+    _quantized = std::vector<u16>();
+
+    switch (storage) {
+    case TerrainStorage::FLOAT32:
+        _floats.resize(heights.n_elem);
+        break;
+    case TerrainStorage::UINT16:
+        _quantized.resize(heights.n_elem);
+        _quantMin = min;
+        _quantStep = (max - min) / 65535;
+        break;
+    default:
+        _array.set_size(_stride, _stride);
+    }
+
+    _storage = storage;
+    setHeights(heights);
+}
+
+Mat<double> Terrain::toMatrix() const {
+    if (_border == 0) {
+        return getHeights();
+    }
+
+    Mat<double> heights(_res, _res);
+
+    for (int y = 0; y < _res; ++y) {
+        for (int x = 0; x < _res; ++x) {
+            heights(x, y) = at(x, y);
+        }
+    }
+    return heights;
+}
+
+Mat<double> Terrain::getHeights() const {
+    if (_storage == TerrainStorage::FLOAT64) {
+        return _array;
+    }
+
+    Mat<double> heights(_stride, _stride);
+    double *values = heights.memptr();
+
+    for (int i = 0; i < _stride * _stride; ++i) {
+        values[i] = getAt(i);
+    }
+    return heights;
+}
+
+void Terrain::setHeights(const Mat<double> &heights) {
+    if (_storage == TerrainStorage::FLOAT64) {
+        _array = heights;
+        return;
+    }
+
+    const double *values = heights.memptr();
+
+    for (int i = 0; i < _stride * _stride; ++i) {
+        setAt(i, values[i]);
+    }
+}
+
 void Terrain::setBounds(double xmin, double ymin, double zmin, double xmax,
                         double ymax, double zmax) {
     _bbox.reset({xmin, ymin, zmin}, {xmax, ymax, zmax});
@@ -61,10 +166,10 @@ vec3d Terrain::getNormal(int x, int y) const {
     const double yUnit = xUnit;
 
     int xa = max(x - 1, 0), xb = min(x + 1, size_1), xm = xb - xa;
-    vec3d nx{(_array(xa, y) - _array(xb, y)), 0, xm * xUnit};
+    vec3d nx{(at(xa, y) - at(xb, y)), 0, xm * xUnit};
 
     int ya = max(y - 1, 0), yb = min(y + 1, size_1), ym = yb - ya;
-    vec3d ny{0, (_array(x, ya) - _array(x, yb)), ym * yUnit};
+    vec3d ny{0, (at(x, ya) - at(x, yb)), ym * yUnit};
     return (nx * ym + ny * xm).normalize();
 }
 
@@ -75,28 +180,56 @@ double Terrain::getSlope(int x, int y) const {
     return sqrt(nx * nx + ny * ny) / normal.z;
 }
 
+Mat<double> Terrain::getSlopes() const {
+    Mat<double> slopes(_res, _res);
+    Mat<double> heights = toMatrix();
+    const int size_1 = _res - 1;
+
+    // The normal of getNormal does not need to be normalized, as the slope
+    // is a ratio of its components. Its z component is 2 * xm * ym * unit,
+    // which gives this factor once simplified.
+    const double factor = size_1 / 2.;
+
+    for (int y = 0; y < _res; ++y) {
+        const int ya = max(y - 1, 0), yb = min(y + 1, size_1);
+        const double *rowA = heights.colptr(ya);
+        const double *row = heights.colptr(y);
+        const double *rowB = heights.colptr(yb);
+        const double yFactor = factor / (yb - ya);
+        double *out = slopes.colptr(y);
+
+        for (int x = 0; x < _res; ++x) {
+            const int xa = max(x - 1, 0), xb = min(x + 1, size_1);
+            const double dx = (row[xa] - row[xb]) * factor / (xb - xa);
+            const double dy = (rowA[x] - rowB[x]) * yFactor;
+            out[x] = sqrt(dx * dx + dy * dy);
+        }
+    }
+    return slopes;
+}
+
 double Terrain::getRawHeight(double x, double y) const {
     int size = getResolution();
     int posX = clamp(static_cast<int>(round(x * (size - 1))), 0, size - 1);
     int posY = clamp(static_cast<int>(round(y * (size - 1))), 0, size - 1);
 
-    return _array(posX, posY);
+    return at(posX, posY);
 }
 
 double Terrain::getInterpolatedHeight(
     double x, double y, const Interpolation::interpFunc &func) const {
-    int width = (int)(_array.n_rows - 1);
-    int height = (int)(_array.n_cols - 1);
+    int width = _res - 1;
+    int height = _res - 1;
 
     x *= width;
     y *= height;
-    int xi = clamp((int)floor(x), 0, width - 1);
-    int yi = clamp((int)floor(y), 0, height - 1);
+    int xi = clamp((int)floor(x), -_border, width - 1 + _border);
+    int yi = clamp((int)floor(y), -_border, height - 1 + _border);
 
-    double v1 = Interpolation::interpolate(xi, _array(xi, yi), xi + 1,
-                                           _array(xi + 1, yi), x, func);
-    double v2 = Interpolation::interpolate(xi, _array(xi, yi + 1), xi + 1,
-                                           _array(xi + 1, yi + 1), x, func);
+    double v1 = Interpolation::interpolate(xi, at(xi, yi), xi + 1,
+                                           at(xi + 1, yi), x, func);
+    double v2 = Interpolation::interpolate(xi, at(xi, yi + 1), xi + 1,
+                                           at(xi + 1, yi + 1), x, func);
     return Interpolation::interpolate(yi, v1, yi + 1, v2, y, func);
 }
 
@@ -111,8 +244,7 @@ double Terrain::getCubicHeight(double x, double y) const {
     for (int xn = 0; xn < 4; ++xn) {
         double vy[4];
         for (int yn = 0; yn < 4; ++yn) {
-            vy[yn] =
-                _array(clamp(xi + xn, 0, res - 1), clamp(yi + yn, 0, res - 1));
+            vy[yn] = at(clamp(xi + xn, 0, res - 1), clamp(yi + yn, 0, res - 1));
         }
         vx[xn] = cuberp(vy, y - yi);
     }
@@ -120,8 +252,8 @@ double Terrain::getCubicHeight(double x, double y) const {
 }
 
 double Terrain::getExactHeightAt(double x, double y) const {
-    int width = (int)(_array.n_rows - 1);
-    int height = (int)(_array.n_cols - 1);
+    int width = _res - 1;
+    int height = _res - 1;
 
     x *= width;
     y *= height;
@@ -141,17 +273,17 @@ double Terrain::getExactHeightAt(double x, double y) const {
         xd = 1 - yd;
         yd = 1 - temp;
         sumd = 2 - sumd;
-        a = _array(xi + 1, yi + 1);
+        a = at(xi + 1, yi + 1);
     } else {
-        a = _array(xi, yi);
+        a = at(xi, yi);
     }
 
     if (sumd <= std::numeric_limits<double>::epsilon()) {
         return a;
     }
 
-    double b = _array(xi + 1, yi);
-    double c = _array(xi, yi + 1);
+    double b = at(xi + 1, yi);
+    double c = at(xi, yi + 1);
 
     double ab = a * (1 - sumd) + b * sumd;
     double ac = a * (1 - sumd) + c * sumd;
@@ -186,7 +318,7 @@ Mesh *Terrain::createMesh(double offsetX, double offsetY, double offsetZ,
                           double sizeX, double sizeY, double sizeZ) const {
     Mesh *mesh = new Mesh();
 
-    const int size = static_cast<int>(_array.n_rows);
+    const int size = _res;
     const int size_1 = size - 1;
     const double inv_size_1 = 1. / size_1;
 
@@ -205,20 +337,17 @@ Mesh *Terrain::createMesh(double offsetX, double offsetY, double offsetZ,
 
             Vertex &vert = mesh->newVertex();
 
-            vert.setPosition(xpos, ypos, _array(x, y) * sizeZ + offsetZ);
+            vert.setPosition(xpos, ypos, at(x, y) * sizeZ + offsetZ);
             vert.setTexture(xd, 1 - yd);
 
             // Compute normal
             double xUnit = sizeX * inv_size_1;
             double yUnit = sizeY * inv_size_1;
             vec3d nx{
-                (_array(max(x - 1, 0), y) - _array(min(x + 1, size_1), y)) *
-                    sizeZ,
-                0, xUnit * 2};
+                (at(max(x - 1, 0), y) - at(min(x + 1, size_1), y)) * sizeZ, 0,
+                xUnit * 2};
             vec3d ny{
-                0,
-                (_array(x, max(y - 1, 0)) - _array(x, min(y + 1, size_1))) *
-                    sizeZ,
+                0, (at(x, max(y - 1, 0)) - at(x, min(y + 1, size_1))) * sizeZ,
                 yUnit * 2};
             vert.setNormal((nx + ny).normalize());
         }
@@ -226,7 +355,7 @@ Mesh *Terrain::createMesh(double offsetX, double offsetY, double offsetZ,
 
     // Faces
     auto indice = [this](int x, int y) -> int {
-        return y * this->_array.n_rows + x;
+        return y * this->_res + x;
     };
     mesh->reserveFaces(size_1 * size_1 * 2);
 
@@ -248,7 +377,7 @@ Mesh *Terrain::createMesh(double offsetX, double offsetY, double offsetZ,
     return mesh;
 }
 
-Image Terrain::createImage() const { return Image(this->_array); }
+Image Terrain::createImage() const { return Image(toMatrix()); }
 
 void Terrain::setTexture(const Image &image) { _texture = image; }
 
@@ -258,9 +387,13 @@ Image &Terrain::getTexture() { return _texture; }
 
 const Image &Terrain::getTexture() const { return _texture; }
 
+size_t Terrain::getMemoryUsage() const {
+    return _array.n_elem * sizeof(double) + _floats.size() * sizeof(float) +
+           _quantized.size() * sizeof(u16) + _texture.getMemoryUsage();
+}
+
 vec2i Terrain::getPixelPos(double x, double y) const {
-    return {(int)min(x * _array.n_rows, _array.n_rows - 1),
-            (int)min(y * _array.n_cols, _array.n_cols - 1)};
+    return {(int)min(x * _res, _res - 1), (int)min(y * _res, _res - 1)};
 }
 
 // -------
@@ -14,6 +14,18 @@
 
 namespace world {
 
+/** Format of the height values of a Terrain in memory. */
+enum class TerrainStorage {
+    /** 64-bit floating point values, the default. */
+    FLOAT64,
+    /** 32-bit floating point values, half of the memory. */
+    FLOAT32,
+    /** 16-bit unsigned integers mapped linearly on the storage range of the
+     * terrain, a quarter of the memory. Heights outside of the range are
+     * clamped. */
+    UINT16,
+};
+
 /* Please note:
  * All matrix-shaped resources generated by this class are using the
  * COLUMN MAJOR ORDER. Thus:
@@ -24,11 +36,19 @@ namespace world {
 /** A Terrain is a squared Heightmap with spatial bounds and
  * a bunch of convenience methods. A terrain can be converted
  * to a mesh, or an image, depending on what use one needs.
- * The terrain can embed a texture. */
+ * The terrain can embed a texture.
+ *
+ * A terrain can have a border of samples around its resolution, which
+ * continue the heightmap outside of its bounds. Border samples are
+ * accessed with coordinates from -border to resolution - 1 + border, and
+ * let a terrain compute its normals and interpolations near its edges
+ * without its neighbours. */
 class WORLDAPI_EXPORT Terrain {
 
 public:
-    explicit Terrain(int size);
+    explicit Terrain(int size,
+                     TerrainStorage storage = TerrainStorage::FLOAT64,
+                     int border = 0);
 
     explicit Terrain(const arma::Mat<double> &data);
 
@@ -40,21 +60,63 @@ public:
 
     Terrain &operator=(const Terrain &terrain);
 
+    /** Convert the height values to the given storage. The range [min, max]
+     * is used by TerrainStorage::UINT16 only, heights of HeightmapGround
+     * tiles being in [0, 1]. */
+    void setStorage(TerrainStorage storage, double min = 0, double max = 1);
+
+    TerrainStorage getStorage() const { return _storage; }
+
     void setBounds(double xmin, double ymin, double zmin, double xmax,
                    double ymax, double zmax);
 
     const BoundingBox &getBoundingBox() const;
 
-    int getResolution() const { return static_cast<int>(_array.n_rows); }
+    int getResolution() const { return _res; }
+
+    /** Get the number of samples on each side of the terrain outside of its
+     * resolution. */
+    int getBorder() const { return _border; }
+
+    /** Get the number of samples of a row of the terrain including the
+     * borders, ie. resolution + 2 * border. */
+    int getBufferResolution() const { return _stride; }
+
+    /** Get the height at (x, y). The terrain must be in
+     * TerrainStorage::FLOAT64, use getHeight and setHeight, or floatAt, with
+     * the other storages. */
+    double &operator()(int x, int y) { return _array(index(x, y)); }
+
+    const double &operator()(int x, int y) const {
+        return _array(index(x, y));
+    }
 
-    double &operator()(int x, int y) { return _array(x, y); }
+    /** Get the height at (x, y) whatever the storage of the terrain is. */
+    double getHeight(int x, int y) const { return getAt(index(x, y)); }
 
-    const double &operator()(int x, int y) const { return _array(x, y); }
+    /** Set the height at (x, y) whatever the storage of the terrain is. With
+     * TerrainStorage::UINT16 the height is clamped to the storage range. */
+    void setHeight(int x, int y, double height) {
+        setAt(index(x, y), height);
+    }
+
+    /** Get the height at (x, y) of a terrain in TerrainStorage::FLOAT32. */
+    float &floatAt(int x, int y) { return _floats[index(x, y)]; }
+
+    float floatAt(int x, int y) const { return _floats[index(x, y)]; }
+
+    /** Get the height values as a matrix of doubles, whatever the storage
+     * of the terrain is. The borders are not included. */
+    arma::Mat<double> toMatrix() const;
 
     vec3d getNormal(int x, int y) const;
 
     double getSlope(int x, int y) const;
 
+    /** Get the slope (see #getSlope) at each sample of the terrain, computed
+     * in a single pass. The borders are not included. */
+    arma::Mat<double> getSlopes() const;
+
     /** Get the height from the height map case which is the
      * nearest to (x, y).  */
     double getRawHeight(double x, double y) const;
@@ -62,7 +124,9 @@ public:
     /** Get the height of the terrain at the specified point,
      * using the given interpolation method. This method perform
      * an interpolation on both x and y axis between the nearest
-     * heightmap points around (x, y). */
+     * heightmap points around (x, y). Points slightly outside of [0, 1]
+     * are interpolated between the border samples if the terrain has a
+     * border. */
     double getInterpolatedHeight(double x, double y,
                                  const Interpolation::interpFunc &func) const;
 
@@ -109,9 +173,25 @@ public:
 
     const Image &getTexture() const;
 
+    /** Get the number of bytes used by the height values and the texture. */
+    size_t getMemoryUsage() const;
+
 private:
     BoundingBox _bbox;
+    int _res;
+    int _border;
+    /// Resolution including the borders
+    int _stride;
+    TerrainStorage _storage;
+    /// Heights in FLOAT64 storage
     arma::Mat<double> _array;
+    /// Heights in FLOAT32 storage, in column major order like _array
+    std::vector<float> _floats;
+    /// Heights in UINT16 storage, in column major order like _array
+    std::vector<u16> _quantized;
+    /// Height of the quantized value 0, and height step between two values
+    double _quantMin = 0;
+    double _quantStep = 1. / 65535;
     Image _texture;
 
     // ------
@@ -120,6 +200,47 @@ private:
 
     friend class TerrainOps;
 
+    template <typename... Stages> friend class TerrainPipeline;
+
+    double getAt(int i) const {
+        switch (_storage) {
+        case TerrainStorage::FLOAT32:
+            return _floats[i];
+        case TerrainStorage::UINT16:
+            return _quantMin + _quantized[i] * _quantStep;
+        default:
+            return _array.memptr()[i];
+        }
+    }
+
+    void setAt(int i, double value) {
+        switch (_storage) {
+        case TerrainStorage::FLOAT32:
+            _floats[i] = static_cast<float>(value);
+            break;
+        case TerrainStorage::UINT16:
+            _quantized[i] = static_cast<u16>(
+                clamp((value - _quantMin) / _quantStep + 0.5, 0., 65535.));
+            break;
+        default:
+            _array.memptr()[i] = value;
+        }
+    }
+
+    int index(int x, int y) const {
+        return x + _border + (y + _border) * _stride;
+    }
+
+    double at(int x, int y) const { return getAt(index(x, y)); }
+
+    /** Get all the height values including the borders. */
+    arma::Mat<double> getHeights() const;
+
+    /** Replace all the height values including the borders, keeping the
+     * current storage. */
+    void setHeights(const arma::Mat<double> &heights);
+
     vec2i getPixelPos(double x, double y) const;
 };
+
 } // namespace world
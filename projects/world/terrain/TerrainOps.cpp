@@ -4,36 +4,96 @@
 
 namespace world {
 
+// Compact storages are converted on the fly, value by value
+template <typename F> void TerrainOps::transform(Terrain &terrain, F f) {
+    const int count = terrain._stride * terrain._stride;
+
+    for (int i = 0; i < count; ++i) {
+        terrain.setAt(i, f(i, terrain.getAt(i)));
+    }
+}
+
 void TerrainOps::fill(Terrain &terrain, double value) {
-    terrain._array.fill(value);
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        terrain._array.fill(value);
+    } else {
+        transform(terrain, [value](int, double) { return value; });
+    }
 }
 
 void TerrainOps::applyOffset(Terrain &terrain, const arma::mat &offset) {
-    if (offset.n_rows != terrain._array.n_rows ||
-        offset.n_cols != terrain._array.n_cols) {
+    if (offset.n_rows != u32(terrain._stride) ||
+        offset.n_cols != u32(terrain._stride)) {
         throw std::runtime_error(
             "TerrainManipulator::applyOffset : bad matrix dimensions");
     }
 
-    terrain._array += offset;
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        terrain._array += offset;
+    } else {
+        const double *values = offset.memptr();
+        transform(terrain, [values](int i, double h) { return h + values[i]; });
+    }
 }
 
 void TerrainOps::applyOffset(world::Terrain &terrain, double offset) {
-    terrain._array += offset;
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        terrain._array += offset;
+    } else {
+        transform(terrain, [offset](int, double h) { return h + offset; });
+    }
 }
 
 void TerrainOps::multiply(Terrain &terrain, const arma::mat &factor) {
-    if (factor.n_rows != terrain._array.n_rows ||
-        factor.n_cols != terrain._array.n_cols) {
+    if (factor.n_rows != u32(terrain._stride) ||
+        factor.n_cols != u32(terrain._stride)) {
         throw std::runtime_error(
             "TerrainManipulator::multiply : bad matrix dimensions");
     }
 
-    terrain._array %= factor;
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        terrain._array %= factor;
+    } else {
+        const double *values = factor.memptr();
+        transform(terrain, [values](int i, double h) { return h * values[i]; });
+    }
 }
 
 void TerrainOps::multiply(Terrain &terrain, double factor) {
-    terrain._array *= factor;
+    if (terrain._storage == TerrainStorage::FLOAT64) {
+        terrain._array *= factor;
+    } else {
+        transform(terrain, [factor](int, double h) { return h * factor; });
+    }
+}
+
+void TerrainOps::extrapolateBorder(Terrain &terrain) {
+    const int b = terrain.getBorder();
+    const int m = terrain.getResolution() - 1;
+
+    // Along y on the inner columns, then along x on all the rows so that
+    // the corners are extrapolated too
+    for (int x = 0; x <= m; ++x) {
+        const double dlow = terrain.getHeight(x, 0) - terrain.getHeight(x, 1);
+        const double dhigh =
+            terrain.getHeight(x, m) - terrain.getHeight(x, m - 1);
+
+        for (int k = 1; k <= b; ++k) {
+            terrain.setHeight(x, -k, terrain.getHeight(x, 0) + k * dlow);
+            terrain.setHeight(x, m + k, terrain.getHeight(x, m) + k * dhigh);
+        }
+    }
+
+    for (int y = -b; y <= m + b; ++y) {
+        const double dlow = terrain.getHeight(0, y) - terrain.getHeight(1, y);
+        const double dhigh =
+            terrain.getHeight(m, y) - terrain.getHeight(m - 1, y);
+
+        for (int k = 1; k <= b; ++k) {
+            terrain.setHeight(-k, y, terrain.getHeight(0, y) + k * dlow);
+            terrain.setHeight(m + k, y, terrain.getHeight(m, y) + k * dhigh);
+        }
+    }
 }
 
 void TerrainOps::copyNeighbours(Terrain &terrain, const TileCoordinates &coords,
@@ -44,43 +104,43 @@ void TerrainOps::copyNeighbours(Terrain &terrain, const TileCoordinates &coords,
     // corners
     TerrainElement *neighbour;
     if (storage.tryGet(coords + vec2i{-1, -1}, &neighbour)) {
-        terrain(0, 0) = neighbour->_terrain(m, m);
+        terrain.setHeight(0, 0, neighbour->_terrain.getHeight(m, m));
     }
 
     if (storage.tryGet(coords + vec2i{-1, 1}, &neighbour)) {
-        terrain(0, m) = neighbour->_terrain(m, 0);
+        terrain.setHeight(0, m, neighbour->_terrain.getHeight(m, 0));
     }
 
     if (storage.tryGet(coords + vec2i{1, -1}, &neighbour)) {
-        terrain(m, 0) = neighbour->_terrain(0, m);
+        terrain.setHeight(m, 0, neighbour->_terrain.getHeight(0, m));
     }
 
     if (storage.tryGet(coords + vec2i{1, 1}, &neighbour)) {
-        terrain(m, m) = neighbour->_terrain(0, 0);
+        terrain.setHeight(m, m, neighbour->_terrain.getHeight(0, 0));
     }
 
     // sides
     if (storage.tryGet(coords + vec2i{-1, 0}, &neighbour)) {
         for (int i = 0; i <= m; ++i) {
-            terrain(0, i) = neighbour->_terrain(m, i);
+            terrain.setHeight(0, i, neighbour->_terrain.getHeight(m, i));
         }
     }
 
     if (storage.tryGet(coords + vec2i{1, 0}, &neighbour)) {
         for (int i = 0; i <= m; ++i) {
-            terrain(m, i) = neighbour->_terrain(0, i);
+            terrain.setHeight(m, i, neighbour->_terrain.getHeight(0, i));
         }
     }
 
     if (storage.tryGet(coords + vec2i{0, -1}, &neighbour)) {
         for (int i = 0; i <= m; ++i) {
-            terrain(i, 0) = neighbour->_terrain(i, m);
+            terrain.setHeight(i, 0, neighbour->_terrain.getHeight(i, m));
         }
     }
 
     if (storage.tryGet(coords + vec2i{0, 1}, &neighbour)) {
         for (int i = 0; i <= m; ++i) {
-            terrain(i, m) = neighbour->_terrain(i, 0);
+            terrain.setHeight(i, m, neighbour->_terrain.getHeight(i, 0));
         }
     }
 }
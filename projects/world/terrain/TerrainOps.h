@@ -7,6 +7,9 @@
 
 namespace world {
 
+/** Operations on the heights of a terrain. The operations with a matrix
+ * apply to the borders of the terrain too, so the matrix must have the
+ * size given by Terrain::getBufferResolution. */
 class WORLDAPI_EXPORT TerrainOps {
 public:
     static void fill(Terrain &terrain, double value);
@@ -19,7 +22,15 @@ public:
 
     static void multiply(Terrain &terrain, double factor);
 
+    /** Set the border samples of the terrain by extrapolating linearly its
+     * inner samples. */
+    static void extrapolateBorder(Terrain &terrain);
+
     static void copyNeighbours(Terrain &terrain, const TileCoordinates &coords,
                                const TerrainGrid &storage);
+
+private:
+    /** Replace each height h at index i by f(i, h). */
+    template <typename F> static void transform(Terrain &terrain, F f);
 };
 } // namespace world
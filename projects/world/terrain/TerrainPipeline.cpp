@@ -0,0 +1,22 @@
+#include "TerrainPipeline.h"
+
+namespace world {
+
+PerlinStage::Tile::Tile(PerlinStage &stage, Terrain &terrain,
+                        const TileCoordinates &coords)
+        : _rows(stage._generator._perlin,
+                stage._generator.getTileInfo(coords, terrain.getBorder()),
+                terrain.getBufferResolution(), terrain.getBufferResolution()),
+          _border(terrain.getBorder()),
+          _factor(1 / stage._generator._perlin.getMaxPossibleValue(
+                           stage._generator._perlinInfo)) {}
+
+void PerlinStage::Tile::processRow(int y, double *row, int count) const {
+    _rows.generateRow(y + _border, row);
+
+    // Normalize relatively to the first lod level
+    for (int x = 0; x < count; ++x) {
+        row[x] *= _factor;
+    }
+}
+} // namespace world
@@ -0,0 +1,291 @@
+#ifndef WORLD_TERRAINPIPELINE_H
+#define WORLD_TERRAINPIPELINE_H
+
+#include "world/core/WorldConfig.h"
+
+#include <ostream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "world/math/Perlin.h"
+#include "ITerrainWorker.h"
+#include "ReliefMapModifier.h"
+#include "PerlinTerrainGenerator.h"
+
+namespace world {
+
+/** A terrain worker made of several per-sample stages, composed at compile
+ * time. Instead of one pass over the whole tile per worker, the pipeline
+ * runs all its stages on one row of the tile before moving to the next
+ * row, so each row stays in the cache while it is processed. The borders
+ * of the tile are processed like the other rows.
+ *
+ * A pipeline is an ITerrainWorker: it can be added to a HeightmapGround
+ * between other workers, which then see the result of all its stages.
+ *
+ * Each stage is a class with these members:
+ *
+ *     class Stage {
+ *     public:
+ *         // State of the stage for one tile
+ *         class Tile {
+ *         public:
+ *             Tile(Stage &stage, Terrain &terrain,
+ *                  const TileCoordinates &coords);
+ *
+ *             // Process the row y of the terrain, in place. The row holds
+ *             // count samples, from x = -border.
+ *             void processRow(int y, double *row, int count) const;
+ *         };
+ *
+ *         bool isReentrant() const;
+ *         void setSeed(u64 seed);
+ *         void writeConfig(std::ostream &stream) const;
+ *     };
+ *
+ * The rows contain the heights produced by the previous workers when the
+ * first stage of the pipeline reads them. */
+template <typename... Stages> class TerrainPipeline : public ITerrainWorker {
+public:
+    template <size_t I>
+    using stage_type =
+        typename std::tuple_element<I, std::tuple<Stages...>>::type;
+
+    template <size_t I> stage_type<I> &getStage() {
+        return std::get<I>(_stages);
+    }
+
+    void processTerrain(Terrain &terrain) override {
+        process(terrain, TileCoordinates(), Indices());
+    }
+
+    void processTile(ITileContext &context) override {
+        process(context.getTile().terrain(), context.getCoords(), Indices());
+    }
+
+    bool isReentrant() const override {
+        bool reentrant = true;
+        forEachStage([&](const auto &stage) {
+            reentrant = reentrant && stage.isReentrant();
+        });
+        return reentrant;
+    }
+
+    bool fillsBorder() const override { return true; }
+
+    void setSeed(u64 seed) override {
+        u64 index = 0;
+        forEachStage(
+            [&](auto &stage) { stage.setSeed(deriveSeed(seed, index++)); });
+    }
+
+    void writeConfig(std::ostream &stream) const override {
+        ITerrainWorker::writeConfig(stream);
+        forEachStage([&](const auto &stage) { stage.writeConfig(stream); });
+    }
+
+private:
+    using Indices = std::index_sequence_for<Stages...>;
+
+    std::tuple<Stages...> _stages;
+
+
+    template <typename F> void forEachStage(F f) {
+        forEachStage(f, Indices());
+    }
+
+    template <typename F> void forEachStage(F f) const {
+        forEachStage(f, Indices());
+    }
+
+    template <typename F, size_t... I>
+    void forEachStage(F &f, std::index_sequence<I...>) {
+        int unused[] = {0, (f(std::get<I>(_stages)), 0)...};
+        (void)unused;
+    }
+
+    template <typename F, size_t... I>
+    void forEachStage(F &f, std::index_sequence<I...>) const {
+        int unused[] = {0, (f(std::get<I>(_stages)), 0)...};
+        (void)unused;
+    }
+
+    template <size_t... I>
+    void process(Terrain &terrain, const TileCoordinates &coords,
+                 std::index_sequence<I...>) {
+        std::tuple<typename Stages::Tile...> tiles(
+            typename Stages::Tile(std::get<I>(_stages), terrain, coords)...);
+
+        const int res = terrain.getResolution();
+        const int border = terrain.getBorder();
+        const int count = terrain.getBufferResolution();
+        const bool inPlace = terrain._storage == TerrainStorage::FLOAT64;
+        std::vector<double> buffer(inPlace ? 0 : count);
+
+        for (int y = -border; y < res + border; ++y) {
+            const int start = terrain.index(-border, y);
+            double *row = inPlace ? terrain._array.memptr() + start
+                                  : buffer.data();
+
+            if (!inPlace) {
+                for (int x = 0; x < count; ++x) {
+                    row[x] = terrain.getAt(start + x);
+                }
+            }
+
+            int unused[] = {0, (std::get<I>(tiles).processRow(y, row, count),
+                                0)...};
+            (void)unused;
+
+            if (!inPlace) {
+                for (int x = 0; x < count; ++x) {
+                    terrain.setAt(start + x, row[x]);
+                }
+            }
+        }
+    }
+};
+
+/** Stage that replaces the heights with the perlin noise of a
+ * PerlinTerrainGenerator. The generator is owned by the stage and can be
+ * configured with #getGenerator. */
+class WORLDAPI_EXPORT PerlinStage {
+public:
+    class WORLDAPI_EXPORT Tile {
+    public:
+        Tile(PerlinStage &stage, Terrain &terrain,
+             const TileCoordinates &coords);
+
+        void processRow(int y, double *row, int count) const;
+
+    private:
+        PerlinRows _rows;
+        int _border;
+        double _factor;
+    };
+
+    PerlinStage(int octaveCount = 5, double frequency = 8,
+                double persistence = 0.5)
+            : _generator(octaveCount, frequency, persistence) {}
+
+    PerlinTerrainGenerator &getGenerator() { return _generator; }
+
+    bool isReentrant() const { return _generator.isReentrant(); }
+
+    void setSeed(u64 seed) { _generator.setSeed(seed); }
+
+    void writeConfig(std::ostream &stream) const {
+        _generator.writeConfig(stream);
+    }
+
+private:
+    PerlinTerrainGenerator _generator;
+};
+
+/** Stage that applies the relief map of a ReliefMapModifier to the heights.
+ * The modifier is owned by the stage and can be configured with
+ * #getModifier. */
+template <typename TModifier = CustomWorldRMModifier> class ReliefStage {
+public:
+    class Tile {
+    public:
+        Tile(ReliefStage &stage, Terrain &terrain, const TileCoordinates &)
+                : _relief(stage._modifier, stage._modifier.obtainMap(0, 0),
+                          terrain) {}
+
+        void processRow(int y, double *row, int) const {
+            _relief.applyToRow(y, row);
+        }
+
+    private:
+        /** Holds the row buffers of the tile */
+        mutable ReliefMapModifier::TerrainRelief _relief;
+    };
+
+    TModifier &getModifier() { return _modifier; }
+
+    bool isReentrant() const { return _modifier.isReentrant(); }
+
+    void setSeed(u64 seed) { _modifier.setSeed(seed); }
+
+    void writeConfig(std::ostream &stream) const {
+        _modifier.writeConfig(stream);
+    }
+
+private:
+    TModifier _modifier;
+};
+
+/** Stage that clamps the heights between two values. */
+class WORLDAPI_EXPORT ClampStage {
+public:
+    class Tile {
+    public:
+        Tile(ClampStage &stage, Terrain &, const TileCoordinates &)
+                : _min(stage._min), _max(stage._max) {}
+
+        void processRow(int, double *row, int count) const {
+            for (int x = 0; x < count; ++x) {
+                row[x] = clamp(row[x], _min, _max);
+            }
+        }
+
+    private:
+        double _min, _max;
+    };
+
+    ClampStage(double min = 0, double max = 1) : _min(min), _max(max) {}
+
+    bool isReentrant() const { return true; }
+
+    void setSeed(u64) {}
+
+    void writeConfig(std::ostream &stream) const {
+        stream << "clamp " << _min << " " << _max << ";";
+    }
+
+private:
+    double _min, _max;
+};
+
+/** Stage that maps the heights linearly from one range to another. */
+class WORLDAPI_EXPORT RemapStage {
+public:
+    class Tile {
+    public:
+        Tile(RemapStage &stage, Terrain &, const TileCoordinates &)
+                : _scale((stage._toMax - stage._toMin) /
+                         (stage._fromMax - stage._fromMin)),
+                  _offset(stage._toMin - stage._fromMin * _scale) {}
+
+        void processRow(int, double *row, int count) const {
+            for (int x = 0; x < count; ++x) {
+                row[x] = row[x] * _scale + _offset;
+            }
+        }
+
+    private:
+        double _scale, _offset;
+    };
+
+    RemapStage(double fromMin = 0, double fromMax = 1, double toMin = 0,
+               double toMax = 1)
+            : _fromMin(fromMin), _fromMax(fromMax), _toMin(toMin),
+              _toMax(toMax) {}
+
+    bool isReentrant() const { return true; }
+
+    void setSeed(u64) {}
+
+    void writeConfig(std::ostream &stream) const {
+        stream << "remap " << _fromMin << " " << _fromMax << " " << _toMin
+               << " " << _toMax << ";";
+    }
+
+private:
+    double _fromMin, _fromMax, _toMin, _toMax;
+};
+} // namespace world
+
+#endif // WORLD_TERRAINPIPELINE_H
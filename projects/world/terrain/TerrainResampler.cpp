@@ -0,0 +1,106 @@
+#include "TerrainResampler.h"
+
+#include <algorithm>
+
+namespace world {
+
+TerrainResampler::Axis::Axis(const Terrain &terrain, Mode mode, double origin,
+                             double step, int count) {
+    const int res = terrain.getResolution();
+    _taps = mode == Mode::CUBIC ? 4 : 2;
+    _indices.resize(count * _taps);
+    _weights.resize(count * _taps);
+
+    for (int i = 0; i < count; ++i) {
+        int *indices = &_indices[i * _taps];
+        double *weights = &_weights[i * _taps];
+        const double u = origin + i * step;
+
+        if (mode == Mode::CUBIC) {
+            const double pos = u * res;
+            const int pi = static_cast<int>(floor(pos));
+            const double t = pos - pi, t2 = t * t, t3 = t2 * t;
+
+            // Coefficients of each value in cuberp
+            weights[0] = -t3 / 2 + t2 - t / 2;
+            weights[1] = 3 * t3 / 2 - 5 * t2 / 2 + 1;
+            weights[2] = -3 * t3 / 2 + 2 * t2 + t / 2;
+            weights[3] = t3 / 2 - t2 / 2;
+
+            for (int k = 0; k < 4; ++k) {
+                indices[k] = clamp(pi + k, 0, res - 1);
+            }
+        } else {
+            const int border = terrain.getBorder();
+            const double pos = u * (res - 1);
+            const int pi = clamp(static_cast<int>(floor(pos)), -border,
+                                 res - 2 + border);
+            const double t = clamp(pos - pi, 0, 1);
+
+            indices[0] = pi;
+            indices[1] = pi + 1;
+            weights[0] = 1 - t;
+            weights[1] = t;
+        }
+    }
+}
+
+TerrainResampler::TerrainResampler(const Terrain &terrain, Mode mode,
+                                   const vec2d &origin, double step,
+                                   int count)
+        : _xAxis(terrain, mode, origin.x, step, count),
+          _yAxis(terrain, mode, origin.y, step, count), _count(count) {
+
+    // The indices only grow along an axis
+    const int minX = *std::min_element(_xAxis._indices.begin(),
+                                       _xAxis._indices.end());
+    const int maxX = *std::max_element(_xAxis._indices.begin(),
+                                       _xAxis._indices.end());
+    const int minY = *std::min_element(_yAxis._indices.begin(),
+                                       _yAxis._indices.end());
+    const int maxY = *std::max_element(_yAxis._indices.begin(),
+                                       _yAxis._indices.end());
+    _firstRow = minY;
+    _rows.resize((maxY - minY + 1) * count);
+
+    // Needed part of each terrain row
+    std::vector<double> source(maxX - minX + 1);
+    const int taps = _xAxis._taps;
+
+    for (int y = minY; y <= maxY; ++y) {
+        for (int x = minX; x <= maxX; ++x) {
+            source[x - minX] = terrain.getHeight(x, y);
+        }
+
+        double *row = &_rows[(y - minY) * count];
+
+        for (int i = 0; i < count; ++i) {
+            const int *indices = &_xAxis._indices[i * taps];
+            const double *weights = &_xAxis._weights[i * taps];
+            double value = 0;
+
+            for (int k = 0; k < taps; ++k) {
+                value += weights[k] * source[indices[k] - minX];
+            }
+            row[i] = value;
+        }
+    }
+}
+
+void TerrainResampler::getRow(int y, double *out) const {
+    const int taps = _yAxis._taps;
+    const int *indices = &_yAxis._indices[y * taps];
+    const double *weights = &_yAxis._weights[y * taps];
+
+    std::fill(out, out + _count, 0.);
+
+    for (int k = 0; k < taps; ++k) {
+        const double *row = &_rows[(indices[k] - _firstRow) * _count];
+        const double w = weights[k];
+
+        for (int i = 0; i < _count; ++i) {
+            out[i] += w * row[i];
+        }
+    }
+}
+} // namespace world
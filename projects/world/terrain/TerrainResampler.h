@@ -0,0 +1,65 @@
+#ifndef WORLD_TERRAINRESAMPLER_H
+#define WORLD_TERRAINRESAMPLER_H
+
+#include "world/core/WorldConfig.h"
+
+#include <vector>
+
+#include "world/math/Vector.h"
+#include "Terrain.h"
+
+namespace world {
+
+/** Interpolates a terrain on a regular grid of points, for example to map
+ * a terrain onto a tile of another terrain. The interpolation is
+ * separable: the weights of each output column and row are computed once,
+ * then the terrain is interpolated along x on the rows it needs at
+ * construction, and along y each time an output row is requested.
+ *
+ * The resampler does not keep a reference on the terrain. */
+class WORLDAPI_EXPORT TerrainResampler {
+public:
+    enum class Mode {
+        /** Same values as Terrain::getCubicHeight */
+        CUBIC,
+        /** Same values as Terrain::getInterpolatedHeight with
+         * Interpolation::LINEAR. The borders of the terrain are used. */
+        LINEAR,
+    };
+
+    /** @param origin coordinates of the first output point, in the same
+     * unit as the coordinates of Terrain::getCubicHeight
+     * @param step distance between two consecutive output points on each
+     * axis, in the same unit
+     * @param count number of output points along each axis */
+    TerrainResampler(const Terrain &terrain, Mode mode, const vec2d &origin,
+                     double step, int count);
+
+    /** Write the row y of the output in out, which must hold count
+     * values. This method can be called from several threads at the same
+     * time. */
+    void getRow(int y, double *out) const;
+
+private:
+    /** Interpolation taps of each output point along one axis */
+    struct Axis {
+        int _taps;
+        /** _taps indices of terrain samples for each output point */
+        std::vector<int> _indices;
+        std::vector<double> _weights;
+
+        Axis(const Terrain &terrain, Mode mode, double origin, double step,
+             int count);
+    };
+
+    Axis _xAxis;
+    Axis _yAxis;
+    int _count;
+    /** Index of the first terrain row in _rows */
+    int _firstRow;
+    /** Terrain rows interpolated along x, _count values each */
+    std::vector<double> _rows;
+};
+} // namespace world
+
+#endif // WORLD_TERRAINRESAMPLER_H
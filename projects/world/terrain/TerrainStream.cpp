@@ -49,7 +49,7 @@ int HeightMapInputStream::read(char *buffer, int count) {
         // COLUMN MAJOR ORDER
         int y = _position % res;
         int x = (_position - y) / res;
-        double data = _terrain(x, y) * _scale + _offset;
+        double data = _terrain.getHeight(x, y) * _scale + _offset;
 
         switch (_format) {
         case HeightMapFormat::F32:
@@ -1,12 +1,14 @@
 #include "ForestLayer.h"
 
+#include <random>
+
 #include "world/core/Chunk.h"
 #include "TreeGroup.h"
 
 namespace world {
 
 ForestLayer::ForestLayer(FlatWorld *flatWorld)
-        : _rng(static_cast<u32>(time(NULL))), _flatWorld(flatWorld),
+        : _flatWorld(flatWorld),
           _treeSprite(3, 3, ImageType::RGB) {
 
     for (int x = 0; x < 3; ++x) {
@@ -33,12 +35,16 @@ void ForestLayer::decorate(Chunk &chunk) {
     vec3d chunkOffset = chunk.getPosition3D();
     const double area = chunkSize.x * chunkSize.y;
 
+    // Each chunk has its own stream, so that it does not depend on the order
+    // in which the chunks are decorated
+    RandomStream rng(_seed, chunkOffset, chunkSize);
+
     // Max tree count
     std::uniform_real_distribution<double> stddistrib(0, 1);
     double maxTreeCountf = _maxDensity * area / 1e6;
     u32 maxTreeCount = static_cast<u32>(floor(maxTreeCountf));
 
-    if (stddistrib(_rng) < maxTreeCountf - maxTreeCount) {
+    if (stddistrib(rng) < maxTreeCountf - maxTreeCount) {
         maxTreeCount++;
     }
 
@@ -51,7 +57,7 @@ void ForestLayer::decorate(Chunk &chunk) {
     std::uniform_real_distribution<double> ydistrib(0, chunkSize.y);
 
     for (u32 i = 0; i < maxTreeCount; ++i) {
-        randomPoints.emplace_back(xdistrib(_rng), ydistrib(_rng));
+        randomPoints.emplace_back(xdistrib(rng), ydistrib(rng));
     }
 
     // Populate trees
@@ -68,7 +74,7 @@ void ForestLayer::decorate(Chunk &chunk) {
             continue;
         }
 
-        if (stddistrib(_rng) < getDensityAtAltitude(altitude)) {
+        if (stddistrib(rng) < getDensityAtAltitude(altitude)) {
             if (remainingTrees <= 0) {
                 treeGroup = &chunk.addChild<TreeGroup>();
                 treeGroup->setPosition3D(chunkSize / 2.0);
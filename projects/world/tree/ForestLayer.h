@@ -3,9 +3,8 @@
 
 #include "world/core/WorldConfig.h"
 
-#include <random>
-
 #include "world/core/IChunkDecorator.h"
+#include "world/math/RandomStream.h"
 #include "world/flat/FlatWorld.h"
 #include "world/assets/Image.h"
 
@@ -17,8 +16,10 @@ public:
 
     void decorate(Chunk &chunk) override;
 
+    void setSeed(u64 seed) override { _seed = seed; }
+
 private:
-    std::mt19937 _rng;
+    u64 _seed = DEFAULT_SEED;
 
     FlatWorld *_flatWorld;
 
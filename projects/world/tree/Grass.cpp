@@ -9,7 +9,7 @@
 namespace world {
 
 Grass::Grass()
-        : _rng(std::random_device{}()), _texture(32, 256, ImageType::RGB) {
+        : _texture(32, 256, ImageType::RGB) {
     generateTexture();
 }
 
@@ -13,6 +13,7 @@
 #include "world/assets/Mesh.h"
 #include "world/assets/Image.h"
 #include "world/core/IInstanceGenerator.h"
+#include "world/math/RandomStream.h"
 
 namespace world {
 
@@ -28,6 +29,9 @@ public:
 
     void setWidth(double width) { _width = width; }
 
+    /** Set the seed used to create the species and the bushes. */
+    void setSeed(u64 seed) { _rng.seed(seed); }
+
     void addBush(const vec3d &root = {});
 
     void removeAllBushes();
@@ -44,7 +48,7 @@ public:
     HabitatFeatures randomize();
 
 private:
-    std::mt19937_64 _rng;
+    RandomStream _rng;
 
     typedef std::vector<vec3d> GrassPoints;
     std::vector<GrassPoints> _points;
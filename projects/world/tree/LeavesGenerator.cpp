@@ -5,7 +5,7 @@
 namespace world {
 
 LeavesGenerator::LeavesGenerator(double leafDensity, double weightThreshold)
-        : _rng(static_cast<u32>(time(NULL))), _distrib(0, 1),
+        : _distrib(0, 1),
           _leafDensity(leafDensity), _weightThreshold(weightThreshold) {}
 
 void LeavesGenerator::setLeafDensity(double density) { _leafDensity = density; }
@@ -14,6 +14,7 @@ void LeavesGenerator::process(Tree &tree) {
     Mesh &leaves = tree.leavesMesh();
     Mesh &trunk = tree.getTrunkMesh();
     TreeSkeletton &skeletton = tree.getSkeletton();
+    _rng.seed(deriveSeed(tree.getSeed(), "leaves"));
 
     processNode(*skeletton.getPrimaryNode(), leaves, trunk);
 }
@@ -5,6 +5,7 @@
 
 #include <random>
 
+#include "world/math/RandomStream.h"
 #include "ITreeWorker.h"
 #include "TreeSkeletton.h"
 #include "world/assets/Mesh.h"
@@ -22,7 +23,8 @@ public:
     LeavesGenerator *clone() const override;
 
 private:
-    std::mt19937 _rng;
+    /** Reseeded from the seed of each processed tree. */
+    RandomStream _rng;
     std::uniform_real_distribution<double> _distrib;
 
     double _leafDensity;
@@ -12,8 +12,7 @@ namespace world {
 
 SimpleTreeDecorator::SimpleTreeDecorator(FlatWorld *flatWorld,
                                          int maxTreesPerChunk)
-        : _flatWorld(flatWorld), _maxTreesPerChunk(maxTreesPerChunk),
-          _rng(static_cast<u32>(time(NULL))) {
+        : _flatWorld(flatWorld), _maxTreesPerChunk(maxTreesPerChunk) {
 
     auto &skeletton = _model.addWorker<TreeSkelettonGenerator>();
     skeletton.setRootWeight(TreeParamsd::gaussian(3, 0.2));
@@ -42,6 +41,7 @@ void SimpleTreeDecorator::decorate(Chunk &chunk) {
     vec3d offset = chunk.getPosition3D();
 
     std::vector<vec2d> positions;
+    RandomStream rng(_seed, offset, chunkSize);
     std::uniform_real_distribution<double> distribX(0, chunkSize.x);
     std::uniform_real_distribution<double> distribY(0, chunkSize.y);
 
@@ -49,7 +49,7 @@ void SimpleTreeDecorator::decorate(Chunk &chunk) {
 
     for (int i = 0; i < _maxTreesPerChunk; i++) {
         // On gnre une position pour l'arbre
-        vec2d position(distribX(_rng), distribY(_rng));
+        vec2d position(distribX(rng), distribY(rng));
 
         // On vrifie que les autres arbres ne sont pas trop prs
         bool addTree = true;
@@ -80,6 +80,7 @@ void SimpleTreeDecorator::decorate(Chunk &chunk) {
         // Cration de l'arbre
         Tree &tree = chunk.addChild<Tree>();
         tree.setup(_model);
+        tree.setSeed(rng());
         tree.setPosition3D(pos3D);
 
         // Remember position
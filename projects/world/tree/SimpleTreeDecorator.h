@@ -6,6 +6,7 @@
 
 #include "world/flat/FlatWorld.h"
 #include "world/core/IChunkDecorator.h"
+#include "world/math/RandomStream.h"
 #include "Tree.h"
 
 namespace world {
@@ -18,11 +19,13 @@ public:
 
     void decorate(Chunk &chunk) override;
 
+    void setSeed(u64 seed) override { _seed = seed; }
+
 private:
     int _maxTreesPerChunk;
     Tree _model;
     FlatWorld *_flatWorld;
 
-    std::mt19937 _rng;
+    u64 _seed = DEFAULT_SEED;
 };
 } // namespace world
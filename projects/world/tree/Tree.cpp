@@ -8,11 +8,13 @@
 #include "TreeSkelettonGenerator.h"
 #include "TrunkGenerator.h"
 #include "LeavesGenerator.h"
+#include "TreeSkelettonParameters.h"
 
 namespace world {
 class PTree {
 public:
     std::vector<std::unique_ptr<ITreeWorker>> _workers;
+    u64 _seed = DEFAULT_SEED;
 };
 
 Tree::Tree() : _internal(new PTree()), _trunkMaterial("trunk") {
@@ -222,7 +224,20 @@ HabitatFeatures Tree::randomize() {
     return HabitatFeatures{};
 }
 
+void Tree::setSeed(u64 seed) {
+    _internal->_seed = seed;
+    reset();
+}
+
+u64 Tree::getSeed() const { return _internal->_seed; }
+
 void Tree::generateBase() {
+    // The parameters of the workers draw their values from the parameter
+    // streams of this thread.
+    Params<double>::rng().seed(deriveSeed(_internal->_seed, 0));
+    TreeParamsd::rng().seed(deriveSeed(_internal->_seed, 1));
+    TreeParamsi::rng().seed(deriveSeed(_internal->_seed, 2));
+
     for (auto &worker : _internal->_workers) {
         worker->process(*this);
     }
@@ -47,6 +47,12 @@ public:
 
     HabitatFeatures randomize();
 
+    /** Set the seed of the tree. Two trees with the same seed and the same
+     * workers are identical. */
+    void setSeed(u64 seed);
+
+    u64 getSeed() const;
+
 public:
     Mesh _simpleTrunk;
     Mesh _simpleLeaves;
@@ -15,11 +15,10 @@ Application::Application()
     _resModel->setFarDistance(10000);
     _lastUpdatePos = {0, 0, 0};
 
-    // Collectors
-    for (int i = 0; i < 2; i++) {
-        auto collector = std::make_unique<Collector>(CollectorPresets::SCENE);
-        _emptyCollectors.emplace_back(std::move(collector));
-    }
+    // Collector, in delta mode so that the view only updates what changed
+    auto collector = std::make_unique<Collector>(CollectorPresets::SCENE);
+    collector->setDeltaMode(true);
+    _emptyCollectors.emplace_back(std::move(collector));
 }
 
 void Application::run(int argc, char **argv) {
@@ -41,8 +40,11 @@ void Application::run(int argc, char **argv) {
             }
             _paramLock.unlock();
 
-            if ((newUpdatePos - _lastUpdatePos).norm() > 0.01 &&
-                !_emptyCollectors.empty()) {
+            bool moved = (newUpdatePos - _lastUpdatePos).norm() > 0.01;
+            size_t generationCount = _world->getAsyncGenerationCount();
+            bool outdated = generationCount != _lastGenerationCount;
+
+            if ((moved || outdated) && !_emptyCollectors.empty()) {
                 // get collector
                 _paramLock.lock();
                 std::unique_ptr<Collector> collector =
@@ -56,6 +58,7 @@ void Application::run(int argc, char **argv) {
 
                 auto start = std::chrono::steady_clock::now();
                 _world->collect(*collector, *_resModel);
+                collector->endCollect();
 
                 if (_dbgOn) {
                     std::cout << "Temps d'exploration : "
@@ -73,6 +76,7 @@ void Application::run(int argc, char **argv) {
                 // Mise  jour de la vue
                 _mainView->onWorldChange();
                 _lastUpdatePos = newUpdatePos;
+                _lastGenerationCount = generationCount;
             }
         }
 
@@ -135,4 +139,8 @@ void Application::loadWorld(int argc, char **argv) {
     }
     _world = std::unique_ptr<FlatWorld>(FlatWorld::createDemoFlatWorld());
 #endif
+
+    // Tiles are generated in background, so that the user can move while the
+    // world is being generated.
+    _world->setAsyncCollect(true);
 }
\ No newline at end of file
@@ -40,6 +40,9 @@ private:
 
     world::vec3d _newUpdatePos;
     world::vec3d _lastUpdatePos;
+    /** The world is collected asynchronously, so it is collected again
+     * when new parts were generated in background since the last collect. */
+    size_t _lastGenerationCount = 0;
 
     std::unique_ptr<MainView> _mainView;
 
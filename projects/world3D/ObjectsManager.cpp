@@ -166,8 +166,8 @@ ObjectsManager::~ObjectsManager() {
 
 void ObjectsManager::initialize(Collector &collector) {
     _objects.clear();
-
-    update(collector);
+    updateAll(collector);
+    _driver->removeAllHardwareBuffers();
 }
 
 void ObjectsManager::update(Collector &collector) {
@@ -177,6 +177,35 @@ void ObjectsManager::update(Collector &collector) {
         _objects.clear();
     }
 
+    auto &objects = collector.getStorageChannel<SceneNode>();
+
+    if (collector.isDeltaMode() && _partialUpdate) {
+        // Only process the objects that changed since the last collect
+        for (const ItemKey &key : objects.getRemovedKeys()) {
+            _dbgRemoved += _objects.erase(key);
+        }
+
+        for (const ItemKey &key : objects.getAddedKeys()) {
+            _objects[key] = std::make_unique<ObjectNodeHandler>(
+                *this, objects.get(key), collector);
+            _dbgAdded++;
+        }
+    } else {
+        updateAll(collector);
+    }
+    _driver->removeAllHardwareBuffers();
+
+    _elapsedTime += std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    if (_dbgOn) {
+        std::cout << _dbgAdded << " " << _dbgRemoved << " " << _elapsedTime
+                  << std::endl;
+    }
+}
+
+void ObjectsManager::updateAll(Collector &collector) {
     // Set remove tag to true
     for (auto &pair : _objects) {
         pair.second->removeTag = true;
@@ -210,16 +239,6 @@ void ObjectsManager::update(Collector &collector) {
             ++iter;
         }
     }
-    _driver->removeAllHardwareBuffers();
-
-    _elapsedTime += std::chrono::duration_cast<std::chrono::milliseconds>(
-                        std::chrono::steady_clock::now() - start)
-                        .count();
-
-    if (_dbgOn) {
-        std::cout << _dbgAdded << " " << _dbgRemoved << " " << _elapsedTime
-                  << std::endl;
-    }
 }
 
 ITexture *ObjectsManager::getOrLoadTexture(const std::string &path,
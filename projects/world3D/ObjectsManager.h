@@ -61,6 +61,10 @@ private:
     std::map<world::ItemKey, std::unique_ptr<ObjectNodeHandler>> _objects;
     std::map<std::string, int> _loadedTextures;
 
+    /** Adds all the objects of the collector that are not displayed yet,
+     * and removes the displayed objects that are not in the collector. */
+    void updateAll(world::Collector &collector);
+
     /** If true, on each update, objects that were already present
      * on the last update are not updated to save time and avoid lags.*/
     bool _partialUpdate = true;
@@ -0,0 +1,448 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <world/core.h>
+#include <world/flat.h>
+#include <world/terrain.h>
+
+using namespace world;
+
+// ===== Allocation counting
+
+namespace {
+std::atomic<u64> allocationCount{0};
+std::atomic<u64> allocatedBytes{0};
+} // namespace
+
+void *operator new(size_t size) {
+    ++allocationCount;
+    allocatedBytes += size;
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+
+// ===== Harness
+
+/** Measures the time and the allocations of the parts of an iteration that
+ * are benchmarked. The setup of each iteration is done outside of
+ * start() / stop(). */
+class Stopwatch {
+public:
+    void start() {
+        _allocStart = allocationCount;
+        _bytesStart = allocatedBytes;
+        _start = std::chrono::steady_clock::now();
+    }
+
+    void stop() {
+        auto end = std::chrono::steady_clock::now();
+        _seconds += std::chrono::duration<double>(end - _start).count();
+        _allocations += allocationCount - _allocStart;
+        _bytes += allocatedBytes - _bytesStart;
+    }
+
+    double _seconds = 0;
+    u64 _allocations = 0;
+    u64 _bytes = 0;
+
+private:
+    std::chrono::steady_clock::time_point _start;
+    u64 _allocStart = 0;
+    u64 _bytesStart = 0;
+};
+
+/** A benchmark runs one iteration and returns the amount of work done,
+ * expressed in the unit of the benchmark. */
+typedef std::function<double(Stopwatch &)> BenchFunction;
+
+struct Benchmark {
+    std::string _name;
+    std::string _unit;
+    int _iterations;
+    /// The first iteration is run once without being measured
+    bool _warmup;
+    BenchFunction _function;
+};
+
+struct BenchResult {
+    std::string _name;
+    std::string _unit;
+    int _iterations;
+    double _medianSeconds;
+    double _minSeconds;
+    /// Median of the work done per second
+    double _throughput;
+    double _allocations;
+    double _bytes;
+};
+
+BenchResult runBenchmark(const Benchmark &bench, int iterations) {
+    if (bench._warmup) {
+        Stopwatch warmup;
+        bench._function(warmup);
+    }
+
+    std::vector<double> seconds, throughputs;
+    u64 allocations = 0, bytes = 0;
+
+    for (int i = 0; i < iterations; ++i) {
+        Stopwatch stopwatch;
+        double work = bench._function(stopwatch);
+
+        seconds.push_back(stopwatch._seconds);
+        throughputs.push_back(work / std::max(stopwatch._seconds, 1e-9));
+        allocations += stopwatch._allocations;
+        bytes += stopwatch._bytes;
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    std::sort(throughputs.begin(), throughputs.end());
+
+    BenchResult result;
+    result._name = bench._name;
+    result._unit = bench._unit;
+    result._iterations = iterations;
+    result._medianSeconds = seconds[iterations / 2];
+    result._minSeconds = seconds[0];
+    result._throughput = throughputs[iterations / 2];
+    result._allocations = double(allocations) / iterations;
+    result._bytes = double(bytes) / iterations;
+    return result;
+}
+
+void writeJson(std::ostream &stream, const std::vector<BenchResult> &results) {
+    stream << "{\n  \"build\": \"" << WORLD_BENCH_BUILD_TYPE << "\",\n"
+           << "  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        stream << (i == 0 ? "" : ",") << "\n    {\"name\": \"" << r._name
+               << "\", \"iterations\": " << r._iterations
+               << ", \"median_ms\": " << r._medianSeconds * 1000
+               << ", \"min_ms\": " << r._minSeconds * 1000
+               << ", \"throughput\": " << r._throughput << ", \"unit\": \""
+               << r._unit << "\", \"allocations\": " << r._allocations
+               << ", \"allocated_bytes\": " << r._bytes << "}";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+// ===== Fixtures
+
+Terrain createPerlinTerrain(int size) {
+    Perlin perlin(12);
+    Terrain terrain(perlin.generatePerlinNoise2D(
+        size, {6, 0.4, false, 0, 4., 0, 0}));
+    terrain.setBounds(0, 0, 0, 1000, 1000, 400);
+    return terrain;
+}
+
+class FlatTextureProvider : public ITextureProvider {
+public:
+    FlatTextureProvider() : _texture(256, 256, ImageType::RGBA) {
+        for (int y = 0; y < _texture.height(); ++y) {
+            for (int x = 0; x < _texture.width(); ++x) {
+                _texture.rgba(x, y).setf(x / 255., y / 255., 0.5, 1);
+            }
+        }
+    }
+
+    Image &getTexture(int layer, int lod) override { return _texture; }
+
+private:
+    Image _texture;
+};
+
+class BenchElement : public IGridElement {};
+
+FirstPersonView createView() {
+    FirstPersonView view(700);
+    view.setFarDistance(10000);
+    view.setPosition({100, 100, 1000});
+    return view;
+}
+
+size_t countFaces(Collector &collector) {
+    size_t faces = 0;
+
+    for (auto entry : collector.getStorageChannel<Mesh>()) {
+        faces += entry._value.getFaceCount();
+    }
+    return faces;
+}
+
+// ===== Benchmarks
+
+std::vector<Benchmark> createBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"Perlin::generatePerlinNoise2D", "Mpixels/s", 10,
+                          true, [](Stopwatch &sw) {
+                              Perlin perlin(12);
+                              arma::mat noise(513, 513);
+                              sw.start();
+                              perlin.generatePerlinNoise2D(
+                                  noise, {6, 0.4, false, 0, 4., 0, 0});
+                              sw.stop();
+                              return noise.n_elem / 1e6;
+                          }});
+
+    benchmarks.push_back(
+        {"HeightmapGround::generateMesh", "triangles/s", 5, false,
+         [](Stopwatch &sw) {
+             HeightmapGround ground;
+             ground.addWorker<PerlinTerrainGenerator>(3, 4., 0.35);
+             FirstPersonView view = createView();
+
+             // Terrains are generated first, so that only the meshes are
+             // generated during the measured collect
+             Collector terrains;
+             ground.collect(terrains, view);
+
+             Collector collector;
+             collector.addStorageChannel<SceneNode>();
+             collector.addStorageChannel<Mesh>();
+             sw.start();
+             ground.collect(collector, view);
+             sw.stop();
+             return double(countFaces(collector));
+         }});
+
+    benchmarks.push_back({"AltitudeTexturer::processTerrain", "Mpixels/s", 10,
+                          true, [](Stopwatch &sw) {
+                              AltitudeTexturer texturer;
+                              ColorMap &colorMap = texturer.getColorMap();
+                              colorMap.addPoint({0, 0}, Color4u(209, 207, 153));
+                              colorMap.addPoint({0.5, 1}, Color4u(72, 132, 65));
+                              colorMap.addPoint({1, 0}, Color4u(160, 160, 160));
+
+                              Terrain terrain = createPerlinTerrain(129);
+                              terrain.setTexture(
+                                  Image(512, 512, ImageType::RGB));
+                              sw.start();
+                              texturer.processTerrain(terrain);
+                              sw.stop();
+                              return 512 * 512 / 1e6;
+                          }});
+
+    benchmarks.push_back(
+        {"MultilayerGroundTexture::process", "Mpixels/s", 5, true,
+         [](Stopwatch &sw) {
+             MultilayerGroundTexture texturer;
+             texturer.setTextureProvider<FlatTextureProvider>();
+             texturer.addLayer(DistributionParams{
+                 -1, 0, 1, 2, -1, 0, 1, 2, 0, 1, 0, 1, 0.2});
+             texturer.addLayer(DistributionParams{
+                 0.33, 0.4, 0.6, 0.75, -1, 0, 0.4, 0.9, 0, 0.85, 0.25, 0.85,
+                 0.2});
+             texturer.addLayer(DistributionParams{
+                 0.65, 0.8, 1, 2, -1, 0, 0.5, 0.7, 0.0, 1.0, 0, 1., 0.2});
+
+             Terrain terrain = createPerlinTerrain(129);
+             terrain.setTexture(Image(256, 256, ImageType::RGB));
+             sw.start();
+             texturer.processTerrain(terrain);
+             sw.stop();
+             return 256 * 256 / 1e6;
+         }});
+
+    // Same heights computed by separate workers, then by a pipeline
+    benchmarks.push_back(
+        {"Perlin + relief workers", "Mpixels/s", 10, true, [](Stopwatch &sw) {
+             PerlinTerrainGenerator perlin(3, 4., 0.35);
+             CustomWorldRMModifier relief;
+             relief.obtainMap(0, 0);
+
+             Terrain terrain(257, TerrainStorage::FLOAT64, 1);
+             terrain.setBounds(0, 0, 0, 1000, 1000, 400);
+             sw.start();
+             perlin.processTerrain(terrain);
+             relief.processTerrain(terrain);
+             sw.stop();
+             return 259 * 259 / 1e6;
+         }});
+
+    benchmarks.push_back(
+        {"TerrainPipeline::processTerrain", "Mpixels/s", 10, true,
+         [](Stopwatch &sw) {
+             TerrainPipeline<PerlinStage, ReliefStage<>> pipeline;
+             pipeline.getStage<0>() = PerlinStage(3, 4., 0.35);
+             pipeline.getStage<1>().getModifier().obtainMap(0, 0);
+
+             Terrain terrain(257, TerrainStorage::FLOAT64, 1);
+             terrain.setBounds(0, 0, 0, 1000, 1000, 400);
+             sw.start();
+             pipeline.processTerrain(terrain);
+             sw.stop();
+             return 259 * 259 / 1e6;
+         }});
+
+    benchmarks.push_back({"VoxelGrid::fillMesh", "triangles/s", 10, true,
+                          [](Stopwatch &sw) {
+                              VoxelField voxels({64, 64, 64}, -1);
+                              VoxelOps::ball(voxels, {0.5, 0.5, 0.5}, 0.4, 1);
+                              Mesh mesh;
+                              sw.start();
+                              voxels.fillMesh(mesh);
+                              sw.stop();
+                              return double(mesh.getFaceCount());
+                          }});
+
+    benchmarks.push_back(
+        {"GridStorageReducer::reduceStorage", "tiles/s", 10, true,
+         [](Stopwatch &sw) {
+             TileSystem ts(8, {1}, {1});
+             GridStorageReducer reducer(ts, 1000);
+             GridStorage<BenchElement> storage;
+             storage.setReducer(&reducer);
+             int count = 0;
+
+             for (int lod = 0; lod <= 8; ++lod) {
+                 int side = std::min(1 << lod, 32);
+
+                 for (int x = 0; x < side; ++x) {
+                     for (int y = 0; y < side; ++y) {
+                         storage.getOrCreate({x, y, 0, lod});
+                         ++count;
+                     }
+                 }
+             }
+
+             sw.start();
+             reducer.reduceStorage();
+             sw.stop();
+             return double(count - storage.size());
+         }});
+
+    benchmarks.push_back(
+        {"SeedDistribution::getPositions", "positions/s", 10, true,
+         [](Stopwatch &sw) {
+             // The ground of the world is kept between iterations, so that
+             // only the first iteration generates the terrain
+             static std::unique_ptr<FlatWorld> world(
+                 FlatWorld::createDemoFlatWorld());
+
+             SeedDistribution distribution(world.get());
+             distribution.addGenerator(HabitatFeatures{});
+             Chunk chunk(vec3d{200, 200, 8000});
+             chunk.setPosition3D({0, 0, -4000});
+             sw.start();
+             auto positions = distribution.getPositions(chunk);
+             sw.stop();
+             return double(positions.size());
+         }});
+
+    benchmarks.push_back(
+        {"HeightmapGround::observeAltitudeAt", "points/s", 5, false,
+         [](Stopwatch &sw) {
+             // No tile is generated before the queries, like when objects
+             // are placed in a region that was never collected
+             HeightmapGround ground;
+             ground.setDefaultWorkerSet();
+             // The relief map is generated by the first query
+             ground.observeAltitudeAt(0, 0, 1.);
+             int count = 0;
+             sw.start();
+
+             for (int x = -10000; x < 10000; x += 200) {
+                 for (int y = -10000; y < 10000; y += 200) {
+                     ground.observeAltitudeAt(x, y, 1.);
+                     ++count;
+                 }
+             }
+             sw.stop();
+             return double(count);
+         }});
+
+    benchmarks.push_back({"FlatWorld::collect", "items/s", 3, false,
+                          [](Stopwatch &sw) {
+                              std::unique_ptr<FlatWorld> world(
+                                  FlatWorld::createDemoFlatWorld());
+                              FirstPersonView view = createView();
+                              Collector collector(CollectorPresets::SCENE);
+                              sw.start();
+                              world->collect(collector, view);
+                              sw.stop();
+                              return double(collector
+                                                .getStorageChannel<SceneNode>()
+                                                .size());
+                          }});
+
+    return benchmarks;
+}
+
+void printUsage() {
+    std::cout << "Usage: world_bench [--filter <name>] [--iterations <n>] "
+                 "[--json <file>]"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string filter, jsonPath;
+    int iterations = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+
+        if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+
+    for (const Benchmark &bench : createBenchmarks()) {
+        if (bench._name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        BenchResult r = runBenchmark(
+            bench, iterations == 0 ? bench._iterations : iterations);
+        results.push_back(r);
+
+        std::cout << std::left << std::setw(36) << r._name << std::right
+                  << std::setw(10) << std::fixed << std::setprecision(3)
+                  << r._medianSeconds * 1000 << " ms" << std::setw(14)
+                  << std::setprecision(2) << r._throughput << " "
+                  << std::left << std::setw(12) << r._unit << std::right
+                  << std::setw(10) << std::setprecision(0) << r._allocations
+                  << " allocs" << std::endl;
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        file << std::setprecision(6);
+        writeJson(file, results);
+    }
+    return 0;
+}
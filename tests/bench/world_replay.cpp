@@ -0,0 +1,298 @@
+/** Replays a recorded camera path on the demo world, and reports how long
+ * each collect took and how much was generated along the way.
+ *
+ * Camera paths are text files, with one keyframe per line:
+ *
+ *     # comment
+ *     <time (s)> <x> <y> <z> <fov (degrees)>
+ *
+ * Keyframes must be sorted by time. Each keyframe is replayed as one step:
+ * the view is moved to the keyframe and the world is collected in a delta
+ * collector, as a viewer would do. The replay does not wait between the
+ * steps, but a step is counted as late if it took longer than the time
+ * until the next keyframe. */
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <world/core.h>
+#include <world/flat.h>
+#include <world/terrain.h>
+
+using namespace world;
+
+struct CameraKeyframe {
+    double _time;
+    vec3d _position;
+    double _fov;
+};
+
+typedef std::vector<CameraKeyframe> CameraPath;
+
+CameraPath readCameraPath(const std::string &filename) {
+    std::ifstream file(filename);
+
+    if (!file) {
+        throw std::runtime_error("Could not open camera path " + filename);
+    }
+
+    CameraPath path;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        size_t start = line.find_first_not_of(" \t\r");
+
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+
+        std::istringstream stream(line);
+        CameraKeyframe frame;
+
+        if (!(stream >> frame._time >> frame._position.x >>
+              frame._position.y >> frame._position.z >> frame._fov)) {
+            throw std::runtime_error(filename + ":" +
+                                     std::to_string(lineNumber) +
+                                     ": expected <time> <x> <y> <z> <fov>");
+        }
+
+        if (!path.empty() && frame._time < path.back()._time) {
+            throw std::runtime_error(filename + ":" +
+                                     std::to_string(lineNumber) +
+                                     ": keyframes are not sorted by time");
+        }
+        path.push_back(frame);
+    }
+    return path;
+}
+
+void writeCameraPath(const std::string &filename, const CameraPath &path) {
+    std::ofstream file(filename);
+
+    if (!file) {
+        throw std::runtime_error("Could not write camera path " + filename);
+    }
+
+    file << "# time(s) x y z fov(degrees)\n" << std::fixed;
+
+    for (const CameraKeyframe &frame : path) {
+        file << std::setprecision(3) << frame._time << " "
+             << std::setprecision(2) << frame._position.x << " "
+             << frame._position.y << " " << frame._position.z << " "
+             << frame._fov << "\n";
+    }
+}
+
+/** Creates a flight 150 m above the ground of the demo world: a straight
+ * line, a turn, then a zoom at the end. */
+CameraPath generateCameraPath(FlatWorld &world, int steps) {
+    CameraPath path;
+    const double dt = 0.1, speed = 200;
+    vec3d position{0, 0, 0};
+    double heading = 0;
+
+    for (int i = 0; i < steps; ++i) {
+        double t = double(i) / steps;
+
+        if (t > 0.4 && t < 0.6) {
+            heading += M_PI / 2 / (0.2 * steps);
+        }
+
+        position.x += std::cos(heading) * speed * dt;
+        position.y += std::sin(heading) * speed * dt;
+        position.z =
+            world.ground().observeAltitudeAt(position.x, position.y, 1) + 150;
+        double fov = t > 0.8 ? 90 - (t - 0.8) * 200 : 90;
+        path.push_back({i * dt, position, fov});
+    }
+    return path;
+}
+
+struct StepResult {
+    double _latency;
+    size_t _generatedTiles;
+    size_t _evictedTiles;
+    size_t _items;
+    size_t _addedItems;
+    size_t _removedItems;
+    bool _late;
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+    return values[std::max<size_t>(rank, 1) - 1];
+}
+
+void printUsage() {
+    std::cout << "Usage: world_replay <path file> [--json <file>] [--csv "
+                 "<file>] [--max-p99 <ms>]\n"
+                 "       world_replay --generate <path file> [--steps <n>]"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::string pathFile, generateFile, jsonFile, csvFile;
+    double maxP99 = 0;
+    int steps = 100;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--generate" && hasValue) {
+            generateFile = argv[++i];
+        } else if (arg == "--steps" && hasValue) {
+            steps = std::max(std::stoi(argv[++i]), 1);
+        } else if (arg == "--json" && hasValue) {
+            jsonFile = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvFile = argv[++i];
+        } else if (arg == "--max-p99" && hasValue) {
+            maxP99 = std::stod(argv[++i]);
+        } else if (arg[0] != '-' && pathFile.empty()) {
+            pathFile = arg;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::unique_ptr<FlatWorld> world(FlatWorld::createDemoFlatWorld());
+
+    if (!generateFile.empty()) {
+        writeCameraPath(generateFile, generateCameraPath(*world, steps));
+        return 0;
+    }
+
+    if (pathFile.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    CameraPath path = readCameraPath(pathFile);
+    auto *ground = dynamic_cast<HeightmapGround *>(&world->ground());
+
+    FirstPersonView view(700);
+    view.setFarDistance(10000);
+    Collector collector(CollectorPresets::SCENE);
+    collector.setDeltaMode(true);
+    auto &nodes = collector.getStorageChannel<SceneNode>();
+
+    std::vector<StepResult> results;
+    size_t generated = 0, evicted = 0;
+
+    for (size_t i = 0; i < path.size(); ++i) {
+        const CameraKeyframe &frame = path[i];
+        view.setPosition(frame._position);
+        view.setFOV(frame._fov);
+
+        auto start = std::chrono::steady_clock::now();
+        collector.reset();
+        world->collect(collector, view);
+        collector.endCollect();
+        std::chrono::duration<double> latency =
+            std::chrono::steady_clock::now() - start;
+
+        StepResult step;
+        step._latency = latency.count();
+        step._generatedTiles = 0;
+        step._evictedTiles = 0;
+
+        if (ground != nullptr) {
+            step._generatedTiles = ground->getGeneratedTileCount() - generated;
+            step._evictedTiles = ground->getEvictedTileCount() - evicted;
+            generated = ground->getGeneratedTileCount();
+            evicted = ground->getEvictedTileCount();
+        }
+
+        step._items = nodes.size();
+        step._addedItems = nodes.getAddedKeys().size();
+        step._removedItems = nodes.getRemovedKeys().size();
+        step._late = i + 1 < path.size() &&
+                     step._latency > path[i + 1]._time - frame._time;
+        results.push_back(step);
+
+        std::cout << "step " << i << ": " << std::fixed
+                  << std::setprecision(1) << step._latency * 1000 << " ms, "
+                  << step._generatedTiles << " tiles generated, "
+                  << step._evictedTiles << " evicted, " << step._items
+                  << " items (+" << step._addedItems << " -"
+                  << step._removedItems << ")" << std::endl;
+    }
+
+    std::vector<double> latencies;
+    size_t lateSteps = 0, maxItems = 0;
+
+    for (const StepResult &step : results) {
+        latencies.push_back(step._latency * 1000);
+        lateSteps += step._late ? 1 : 0;
+        maxItems = std::max(maxItems, step._items);
+    }
+
+    double p50 = percentile(latencies, 0.5), p90 = percentile(latencies, 0.9),
+           p99 = percentile(latencies, 0.99),
+           maxLatency = percentile(latencies, 1);
+    long peakRss = getMemoryUsage();
+
+    std::cout << "\nsteps: " << results.size() << ", late steps: " << lateSteps
+              << "\nlatency (ms): p50 " << p50 << ", p90 " << p90 << ", p99 "
+              << p99 << ", max " << maxLatency
+              << "\ntiles generated: " << generated
+              << ", tiles evicted: " << evicted << ", max items: " << maxItems
+              << "\npeak RSS: " << getReadableMemoryUsage(4) << std::endl;
+
+    for (auto &entry : MemoryRegistry::getDefault().getUsages()) {
+        std::cout << entry.first << ": " << entry.second / 1e6 << " MB"
+                  << std::endl;
+    }
+
+    if (!jsonFile.empty()) {
+        std::ofstream file(jsonFile);
+        file << "{\n  \"path\": \"" << pathFile
+             << "\",\n  \"steps\": " << results.size()
+             << ",\n  \"late_steps\": " << lateSteps
+             << ",\n  \"latency_ms\": {\"p50\": " << p50 << ", \"p90\": " << p90
+             << ", \"p99\": " << p99 << ", \"max\": " << maxLatency
+             << "},\n  \"tiles_generated\": " << generated
+             << ",\n  \"tiles_evicted\": " << evicted
+             << ",\n  \"max_items\": " << maxItems
+             << ",\n  \"peak_rss_kb\": " << peakRss << "\n}\n";
+    }
+
+    if (!csvFile.empty()) {
+        std::ofstream file(csvFile);
+        file << "step,time,latency_ms,tiles_generated,tiles_evicted,items,"
+                "added_items,removed_items,late\n";
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const StepResult &step = results[i];
+            file << i << "," << path[i]._time << ","
+                 << step._latency * 1000 << "," << step._generatedTiles << ","
+                 << step._evictedTiles << "," << step._items << ","
+                 << step._addedItems << "," << step._removedItems << ","
+                 << (step._late ? 1 : 0) << "\n";
+        }
+    }
+
+    if (maxP99 > 0 && p99 > maxP99) {
+        std::cout << "p99 latency " << p99 << " ms exceeds " << maxP99 << " ms"
+                  << std::endl;
+        return 2;
+    }
+    return 0;
+}
@@ -60,4 +60,75 @@ TEST_CASE("get mesh vertices", "[peace]") {
         INFO(std::to_string(i) + " is " + std::to_string(vertex));
         CHECK((abs(vertex - 1) < 0.000001 || abs(vertex - 0) < 0.000001));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("get mesh buffers", "[peace]") {
+    Mesh meshes[2];
+
+    for (int m = 0; m < 2; ++m) {
+        for (int i = 0; i < 3 + m; ++i) {
+            meshes[m].newVertex({double(i), double(m), 0.5}, {0, 0, 1},
+                                {0.25, 0.75});
+        }
+        meshes[m].newFace(0, 1, 2);
+    }
+    meshes[1].newFace(0, 2, 3);
+
+    SECTION("zero copy") {
+        MeshData data = readMeshData(&meshes[1]);
+        REQUIRE(data.vertCount == 4);
+        REQUIRE(data.indicesCount == 6);
+        CHECK(data.vertices[3 * 8] == 3);
+        CHECK(data.vertices[3 * 8 + 1] == 1);
+        CHECK(data.indices[5] == 3);
+    }
+
+    SECTION("batch float") {
+        MeshPtr ptrs[] = {&meshes[0], &meshes[1]};
+        int vertCounts[2], indicesCounts[2];
+        readMeshesSizes(ptrs, 2, vertCounts, indicesCounts);
+        REQUIRE(vertCounts[0] == 3);
+        REQUIRE(vertCounts[1] == 4);
+        REQUIRE(indicesCounts[0] == 3);
+        REQUIRE(indicesCounts[1] == 6);
+
+        float positions[7 * 3], normals[7 * 3], uvs[7 * 2];
+        int indices[9];
+        readMeshesFloat(ptrs, 2, positions, normals, uvs, indices);
+
+        // first vertex of the second mesh
+        CHECK(positions[3 * 3] == 0);
+        CHECK(positions[3 * 3 + 1] == 1);
+        CHECK(positions[3 * 3 + 2] == 0.5f);
+        CHECK(normals[6 * 3 + 2] == 1);
+        CHECK(uvs[6 * 2 + 1] == 0.75f);
+        CHECK(indices[3] == 0);
+        CHECK(indices[8] == 3);
+    }
+
+    SECTION("compact meshes") {
+        CompactMesh floatMesh(meshes[0]);
+        CompactMesh quantizedMesh(meshes[1],
+                                  CompactMesh::NormalFormat::SNORM16);
+        CompactMeshPtr ptrs[] = {&floatMesh, &quantizedMesh};
+        int vertCounts[2], indicesCounts[2];
+        readCompactMeshesSizes(ptrs, 2, vertCounts, indicesCounts);
+        REQUIRE(vertCounts[0] == 3);
+        REQUIRE(vertCounts[1] == 4);
+        REQUIRE(indicesCounts[0] == 3);
+        REQUIRE(indicesCounts[1] == 6);
+
+        float positions[7 * 3], normals[7 * 3], uvs[7 * 2];
+        int indices[9];
+        readCompactMeshesFloat(ptrs, 2, positions, normals, uvs, indices);
+
+        CHECK(positions[3 * 3] == 0);
+        CHECK(positions[3 * 3 + 1] == 1);
+        CHECK(positions[3 * 3 + 2] == 0.5f);
+        CHECK(normals[2] == 1);
+        CHECK(normals[6 * 3 + 2] == 1);
+        CHECK(uvs[6 * 2 + 1] == 0.75f);
+        CHECK(indices[3] == 0);
+        CHECK(indices[8] == 3);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef WORLD_TEMPDIRECTORY_H
+#define WORLD_TEMPDIRECTORY_H
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <world/core/IOUtil.h>
+
+/** Directory with a unique name in the temporary directory of the system,
+ * removed with all its content when this object is destroyed. */
+class TempDirectory {
+public:
+    explicit TempDirectory(const std::string &prefix) {
+        std::random_device device;
+        std::mt19937_64 rng(
+            device() ^
+            std::chrono::steady_clock::now().time_since_epoch().count());
+
+        std::stringstream path;
+        path << getSystemTempPath() << "/" << prefix << "_" << std::hex
+             << rng();
+        _path = path.str();
+        world::createDirectories(_path);
+    }
+
+    TempDirectory(const TempDirectory &other) = delete;
+
+    TempDirectory &operator=(const TempDirectory &other) = delete;
+
+    ~TempDirectory() { world::removeDirectories(_path); }
+
+    const std::string &path() const { return _path; }
+
+private:
+    std::string _path;
+
+
+    static std::string getSystemTempPath() {
+        for (const char *var : {"TMPDIR", "TMP", "TEMP"}) {
+            const char *value = std::getenv(var);
+
+            if (value != nullptr && *value != '\0') {
+                return value;
+            }
+        }
+#ifdef _WIN32
+        return ".";
+#else
+        return "/tmp";
+#endif
+    }
+};
+
+#endif // WORLD_TEMPDIRECTORY_H
@@ -35,6 +35,23 @@ TEST_CASE("ItemKeys", "[collector]") {
     SECTION("Concat") {
         ItemKey test = ItemKeys::child(ItemKeys::child(keyc1, "1"), "51");
         CHECK(test == ItemKeys::concat(keyc1, keyc3));
+        CHECK(test.length() == 4);
+        CHECK(ItemKeys::concat(keyc1, keyc3).str() == test.str());
+    }
+
+    SECTION("Parent and last node") {
+        ItemKey concat = ItemKeys::concat(keyc1, keyc3);
+        CHECK(concat.last() == NodeKey("51"));
+        CHECK(concat.parent() == ItemKeys::child(keyc1, "1"));
+        CHECK(concat.parent().parent() == keyc1);
+        CHECK(keyc4.last() == NodeKey("52"));
+        CHECK(key1.parent() == ItemKeys::defaultKey());
+
+        std::vector<NodeKey> components = concat.components();
+        REQUIRE(components.size() == 4);
+        CHECK(components[0] == NodeKey("0"));
+        CHECK(components[2] == NodeKey("1"));
+        CHECK(ItemKey(components) == concat);
     }
 
     SECTION("toString / fromString") {
@@ -49,6 +66,59 @@ TEST_CASE("ItemKeys", "[collector]") {
     }
 }
 
+class KeyNode : public WorldNode {
+public:
+    void collect(ICollector &collector, const IResolutionModel &,
+                 const ExplorationContext &ctx) override {
+        if (collector.hasChannel<SceneNode>()) {
+            ItemKey key{"object"};
+            collector.getChannel<SceneNode>().put(
+                key, SceneNode(ctx(key).str()), ctx);
+        }
+    }
+};
+
+class KeyDecorator : public IChunkDecorator {
+public:
+    void decorate(Chunk &chunk) override { chunk.addChild<KeyNode>(); }
+};
+
+TEST_CASE("KeyRegistry", "[collector]") {
+    const size_t defaultCapacity = KeyRegistry::getCapacity();
+    const size_t capacity = 40000;
+    KeyRegistry::setCapacity(capacity);
+
+    GridChunkSystem chunkSystem(1000, 2, 0.5);
+    chunkSystem.addDecorator<KeyDecorator>();
+    Collector collector(CollectorPresets::SCENE);
+    FirstPersonView view;
+    size_t maxSize = 0;
+
+    // Each collect over a new area creates about 15000 new keys
+    for (int i = 0; i < 40; ++i) {
+        view.setPosition({i * 1e6, 0, 0});
+        collector.reset();
+        chunkSystem.collect(collector, view);
+        maxSize = std::max(maxSize, KeyRegistry::size());
+    }
+    CHECK(maxSize <= capacity + capacity / 10);
+    CHECK(MemoryRegistry::getDefault().getUsage("KeyRegistry") > 0);
+
+    // The keys of the last collect can still be exported
+    auto &objects = collector.getStorageChannel<SceneNode>();
+    REQUIRE(objects.size() > 0);
+    size_t exported = 0;
+
+    for (auto entry : objects) {
+        if (entry._key.str() == entry._value.getMeshID()) {
+            ++exported;
+        }
+    }
+    CHECK(exported == objects.size());
+
+    KeyRegistry::setCapacity(defaultCapacity);
+}
+
 TEST_CASE("ExplorationContext", "[collector]") {
     ExplorationContext ctx = ExplorationContext::getDefault();
 
@@ -178,3 +248,125 @@ TEST_CASE("Collector", "[collector]") {
         REQUIRE(scene.hasTexture(sceneMat.getMapKd()));
     }
 }
+
+TEST_CASE("Collector - shared items", "[collector]") {
+    Collector collector1(CollectorPresets::SCENE);
+    Collector collector2(CollectorPresets::SCENE);
+    auto &meshChan1 = collector1.getStorageChannel<Mesh>();
+    auto &meshChan2 = collector2.getStorageChannel<Mesh>();
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->newVertex({1, 2, 3});
+    ItemKey key = ItemKeys::root("a");
+
+    meshChan1.putShared(key, mesh);
+    meshChan2.putShared(key, mesh);
+    CHECK(&meshChan1.get(key) == mesh.get());
+    CHECK(&meshChan2.get(key) == mesh.get());
+    CHECK(mesh.use_count() == 3);
+
+    // The item survives the reset of the channel
+    auto shared = meshChan1.getShared(key);
+    collector1.reset();
+    collector2.reset();
+    mesh.reset();
+    CHECK(shared->getVerticesCount() == 1);
+
+    SECTION("Context-dependent items are copied") {
+        ExplorationContext ctx;
+        ctx.addOffset({1, 0, 0});
+        auto &nodeChan = collector1.getStorageChannel<SceneNode>();
+        auto node = std::make_shared<const SceneNode>("mesh");
+        nodeChan.putShared(key, node, ctx);
+        CHECK(&nodeChan.get(key) != node.get());
+        CHECK(nodeChan.get(key).getPosition().x == Approx(1));
+    }
+}
+
+TEST_CASE("Collector - memory usage", "[collector]") {
+    Collector collector(CollectorPresets::SCENE);
+    CHECK(collector.getMemoryUsage() == 0);
+
+    Mesh mesh;
+    for (int i = 0; i < 100; ++i) {
+        mesh.newVertex({double(i), 0, 0});
+    }
+    collector.getStorageChannel<Mesh>().put(ItemKeys::root("a"), mesh);
+    collector.getStorageChannel<SceneNode>().put(ItemKeys::root("a"),
+                                                 SceneNode("a"));
+    CHECK(collector.getMemoryUsage() >=
+          100 * sizeof(Vertex) + sizeof(SceneNode));
+
+    collector.reset();
+    CHECK(collector.getMemoryUsage() == 0);
+}
+
+TEST_CASE("Collector - delta mode", "[collector]") {
+    Collector collector(CollectorPresets::SCENE);
+    collector.setDeltaMode(true);
+    auto &objChan = collector.getStorageChannel<SceneNode>();
+    auto &meshChan = collector.getStorageChannel<Mesh>();
+
+    collector.reset();
+    objChan.put(ItemKeys::root("a"), SceneNode("a"));
+    objChan.put(ItemKeys::root("b"), SceneNode("b"));
+    meshChan.put(ItemKeys::root("a"), Mesh());
+    collector.endCollect();
+
+    CHECK(objChan.getAddedKeys().size() == 2);
+    CHECK(objChan.getRemovedKeys().empty());
+    CHECK(meshChan.getAddedKeys().size() == 1);
+
+    SECTION("Only changes are reported") {
+        collector.reset();
+        // "a" is put again, "b" is kept with keep, "c" is new
+        objChan.put(ItemKeys::root("a"), SceneNode("other"));
+        CHECK(objChan.keep(ItemKeys::root("b")));
+        CHECK_FALSE(objChan.keep(ItemKeys::root("d")));
+        objChan.put(ItemKeys::root("c"), SceneNode("c"));
+        collector.endCollect();
+
+        REQUIRE(objChan.getAddedKeys().size() == 1);
+        CHECK(objChan.getAddedKeys()[0] == ItemKeys::root("c"));
+        CHECK(objChan.getRemovedKeys().empty());
+        CHECK(objChan.size() == 3);
+        // Items are not replaced
+        CHECK(objChan.get(ItemKeys::root("a")).getMeshID() == "a");
+
+        // The mesh was not collected again
+        REQUIRE(meshChan.getRemovedKeys().size() == 1);
+        CHECK(meshChan.getRemovedKeys()[0] == ItemKeys::root("a"));
+        CHECK(meshChan.size() == 0);
+    }
+
+    SECTION("Items not collected are removed") {
+        collector.reset();
+        objChan.put(ItemKeys::root("b"), SceneNode("b"));
+        collector.endCollect();
+
+        CHECK(objChan.getAddedKeys().empty());
+        REQUIRE(objChan.getRemovedKeys().size() == 1);
+        CHECK(objChan.getRemovedKeys()[0] == ItemKeys::root("a"));
+        CHECK_FALSE(objChan.has(ItemKeys::root("a")));
+        CHECK(objChan.has(ItemKeys::root("b")));
+    }
+
+    SECTION("has does not keep the items") {
+        collector.reset();
+        CHECK(objChan.has(ItemKeys::root("a")));
+        collector.endCollect();
+
+        CHECK(objChan.getRemovedKeys().size() == 2);
+        CHECK(objChan.size() == 0);
+    }
+
+    SECTION("Disabled delta mode") {
+        collector.setDeltaMode(false);
+        collector.reset();
+        CHECK(objChan.size() == 0);
+        objChan.put(ItemKeys::root("a"), SceneNode("a"));
+        collector.endCollect();
+        CHECK(objChan.getAddedKeys().empty());
+        CHECK(objChan.size() == 1);
+    }
+}
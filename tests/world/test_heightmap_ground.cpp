@@ -1,12 +1,593 @@
 #include <catch/catch.hpp>
 
 #include <random>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
 
 #include <world/core.h>
 #include <world/terrain.h>
 
+#include "TempDirectory.h"
+
 using namespace world;
 
+/** Worker that fills each tile with a value depending only on its
+ * coordinates, so that results can be compared between runs. */
+class CoordsTerrainWorker : public ITerrainWorker {
+public:
+    std::atomic<int> _processed{0};
+    bool _reentrant;
+
+    CoordsTerrainWorker(bool reentrant) : _reentrant(reentrant) {}
+
+    void processTerrain(Terrain &terrain) override {}
+
+    void processTile(ITileContext &context) override {
+        Terrain &terrain = context.getTile().terrain();
+        TileCoordinates tc = context.getCoords();
+        int res = terrain.getResolution();
+
+        for (int y = 0; y < res; ++y) {
+            for (int x = 0; x < res; ++x) {
+                terrain(x, y) = mod(tc._pos.x * 31 + tc._pos.y * 17 + x + y,
+                                    97) /
+                                    97. +
+                                tc._lod;
+            }
+        }
+        ++_processed;
+    }
+
+    bool isReentrant() const override { return _reentrant; }
+};
+
+/** Texturer that only counts the tiles it processes. */
+class CountingTexturer : public ITerrainWorker {
+public:
+    int _processed = 0;
+
+    void processTerrain(Terrain &terrain) override {}
+
+    void processTile(ITileContext &context) override { ++_processed; }
+
+    bool isTexturer() const override { return true; }
+};
+
+TEST_CASE("HeightmapGround - parallel generation", "[terrain]") {
+    HeightmapGround serial(6000);
+    HeightmapGround parallel(6000);
+    auto &serialWorker = serial.addWorker<CoordsTerrainWorker>(true);
+    auto &parallelWorker = parallel.addWorker<CoordsTerrainWorker>(true);
+    parallel.setThreadCount(4);
+
+    Collector collector;
+    FirstPersonView view;
+    serial.collect(collector, view);
+    parallel.collect(collector, view);
+
+    CHECK(parallelWorker._processed == serialWorker._processed);
+
+    bool success = true;
+    for (int x = -5000; x < 5000; x += 250) {
+        for (int y = -5000; y < 5000; y += 250) {
+            success = success && serial.observeAltitudeAt(x, y, 0.01) ==
+                                     parallel.observeAltitudeAt(x, y, 0.01);
+        }
+    }
+    CHECK(success);
+}
+
+TEST_CASE("HeightmapGround - asynchronous collect", "[terrain]") {
+    HeightmapGround syncGround(6000);
+    HeightmapGround asyncGround(6000);
+    syncGround.addWorker<CoordsTerrainWorker>(true);
+    asyncGround.addWorker<CoordsTerrainWorker>(true);
+
+    FirstPersonView view;
+    ExplorationContext asyncCtx;
+    asyncCtx.setAsync(true);
+
+    Collector syncCollector(CollectorPresets::SCENE);
+    syncGround.collect(syncCollector, view);
+    auto &syncNodes = syncCollector.getStorageChannel<SceneNode>();
+
+    Collector asyncCollector(CollectorPresets::SCENE);
+    auto &asyncNodes = asyncCollector.getStorageChannel<SceneNode>();
+    asyncGround.collect(asyncCollector, view, asyncCtx);
+    CHECK(asyncNodes.size() < syncNodes.size());
+
+    asyncGround.waitForGeneration();
+    asyncCollector.reset();
+    asyncGround.collect(asyncCollector, view, asyncCtx);
+    CHECK(asyncNodes.size() == syncNodes.size());
+
+    bool success = true;
+    for (int x = -5000; x < 5000; x += 250) {
+        for (int y = -5000; y < 5000; y += 250) {
+            success = success && syncGround.observeAltitudeAt(x, y, 0.01) ==
+                                     asyncGround.observeAltitudeAt(x, y, 0.01);
+        }
+    }
+    CHECK(success);
+}
+
+/** Worker that blocks the generation until it is released. */
+class BlockingWorker : public ITerrainWorker {
+public:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    bool _entered = false;
+    bool _released = false;
+
+    void processTerrain(Terrain &terrain) override {}
+
+    void processTile(ITileContext &context) override {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _entered = true;
+        _changed.notify_all();
+        _changed.wait(lock, [this] { return _released; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _released = true;
+        _changed.notify_all();
+    }
+};
+
+TEST_CASE("HeightmapGround - asynchronous collect does not wait for the "
+          "generation",
+          "[terrain]") {
+    HeightmapGround ground(6000);
+    auto &worker = ground.addWorker<BlockingWorker>();
+
+    FirstPersonView view;
+    ExplorationContext ctx;
+    ctx.setAsync(true);
+    Collector collector(CollectorPresets::SCENE);
+    ground.collect(collector, view, ctx);
+
+    {
+        std::unique_lock<std::mutex> lock(worker._mutex);
+        worker._changed.wait(lock, [&] { return worker._entered; });
+    }
+
+    // The generation thread is stuck in the worker
+    auto collect = std::async(std::launch::async, [&] {
+        collector.reset();
+        ground.collect(collector, view, ctx);
+    });
+    CHECK(collect.wait_for(std::chrono::seconds(5)) ==
+          std::future_status::ready);
+    CHECK(ground.getAsyncGenerationCount() == 0);
+
+    worker.release();
+    collect.get();
+    ground.waitForGeneration();
+    CHECK(ground.getAsyncGenerationCount() > 0);
+}
+
+TEST_CASE("HeightmapGround - delta collect", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.addWorker<CoordsTerrainWorker>(true);
+
+    Collector collector(CollectorPresets::SCENE);
+    collector.setDeltaMode(true);
+    auto &nodes = collector.getStorageChannel<SceneNode>();
+    auto &meshes = collector.getStorageChannel<Mesh>();
+    FirstPersonView view;
+
+    collector.reset();
+    ground.collect(collector, view);
+    collector.endCollect();
+    const size_t count = nodes.size();
+    CHECK(nodes.getAddedKeys().size() == count);
+    CHECK(meshes.size() == count);
+
+    // Same point of view: nothing changes
+    collector.reset();
+    ground.collect(collector, view);
+    collector.endCollect();
+    CHECK(nodes.getAddedKeys().empty());
+    CHECK(nodes.getRemovedKeys().empty());
+    CHECK(meshes.getRemovedKeys().empty());
+    CHECK(nodes.size() == count);
+
+    // Moving the point of view only reports the differences
+    view.setPosition({3000, 0, 0});
+    collector.reset();
+    ground.collect(collector, view);
+    collector.endCollect();
+    CHECK_FALSE(nodes.getAddedKeys().empty());
+    CHECK(nodes.getAddedKeys().size() < nodes.size());
+    CHECK(nodes.getRemovedKeys().size() == meshes.getRemovedKeys().size());
+    CHECK(meshes.size() == nodes.size());
+
+    Collector fullCollector(CollectorPresets::SCENE);
+    ground.collect(fullCollector, view);
+    CHECK(fullCollector.getStorageChannel<SceneNode>().size() == nodes.size());
+
+    // Painted tiles are replaced
+    auto &images = collector.getStorageChannel<Image>();
+    ground.paintTexture({2500, -500}, {1000, 1000}, {0, 1000},
+                        Image(4, 4, ImageType::RGB));
+    collector.reset();
+    ground.collect(collector, view);
+    collector.endCollect();
+    CHECK_FALSE(images.getAddedKeys().empty());
+    CHECK(images.getAddedKeys().size() == images.getRemovedKeys().size());
+    CHECK(images.size() == nodes.size());
+
+    // Tiles generated with another seed are replaced
+    ground.setSeed(12);
+    collector.reset();
+    ground.collect(collector, view);
+    collector.endCollect();
+    CHECK(nodes.getAddedKeys().size() == nodes.size());
+    CHECK(meshes.getRemovedKeys().size() == meshes.size());
+}
+
+TEST_CASE("HeightmapGround - tile statistics", "[terrain]") {
+    HeightmapGround ground(6000);
+    auto &worker = ground.addWorker<CoordsTerrainWorker>(false);
+    FirstPersonView view;
+    Collector collector(CollectorPresets::SCENE);
+
+    ground.collect(collector, view);
+    CHECK(ground.getGeneratedTileCount() == size_t(worker._processed));
+    CHECK(ground.getEvictedTileCount() == 0);
+
+    // Every tile is evicted when the budget is too low
+    ground.setMemoryBudget(1);
+    collector.reset();
+    ground.collect(collector, view);
+    CHECK(ground.getEvictedTileCount() > 0);
+    CHECK(ground.getMemoryUsage() <= 1);
+}
+
+/** Texturer that fills the textures in black. */
+class BlackTexturer : public ITerrainWorker {
+public:
+    void processTerrain(Terrain &terrain) override {}
+
+    void processTile(ITileContext &context) override {
+        ImageUtils::fill(context.getTile().texture(), {0, 0, 0});
+    }
+
+    bool isTexturer() const override { return true; }
+};
+
+TEST_CASE("HeightmapGround - paint survives the eviction", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.addWorker<CoordsTerrainWorker>(true);
+    ground.addWorker<BlackTexturer>();
+
+    Image paint(4, 4, ImageType::RGB);
+    ImageUtils::fill(paint, {1, 0, 0});
+    ground.paintTexture({-500, -500}, {1000, 1000}, {0, 1000}, paint);
+
+    auto countPainted = [](Collector &collector) {
+        int count = 0;
+
+        for (auto entry : collector.getStorageChannel<Image>()) {
+            const Image &image = entry._value;
+
+            for (int y = 0; y < image.height(); ++y) {
+                for (int x = 0; x < image.width(); ++x) {
+                    count += image.rgb(x, y).getRed() > 128 ? 1 : 0;
+                }
+            }
+        }
+        return count;
+    };
+
+    FirstPersonView view;
+    Collector collector(CollectorPresets::SCENE);
+    ground.collect(collector, view);
+    const int painted = countPainted(collector);
+    CHECK(painted > 0);
+
+    // Every tile is evicted, then generated again
+    ground.setMemoryBudget(1);
+    collector.reset();
+    ground.collect(collector, view);
+    collector.reset();
+    ground.collect(collector, view);
+    CHECK(ground.getEvictedTileCount() > 0);
+    CHECK(countPainted(collector) == painted);
+}
+
+TEST_CASE("HeightmapGround - shared assets", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.addWorker<CoordsTerrainWorker>(true);
+
+    FirstPersonView view;
+    Collector collector1(CollectorPresets::SCENE);
+    Collector collector2(CollectorPresets::SCENE);
+    ground.collect(collector1, view);
+    ground.collect(collector2, view);
+
+    auto &meshes1 = collector1.getStorageChannel<Mesh>();
+    auto &meshes2 = collector2.getStorageChannel<Mesh>();
+    auto &images1 = collector1.getStorageChannel<Image>();
+    auto &images2 = collector2.getStorageChannel<Image>();
+    REQUIRE(meshes1.size() == meshes2.size());
+
+    bool shared = true;
+    for (auto entry : meshes1) {
+        shared = shared && &entry._value == &meshes2.get(entry._key) &&
+                 &images1.get(entry._key) == &images2.get(entry._key);
+    }
+    CHECK(shared);
+}
+
+TEST_CASE("HeightmapGround - compact meshes", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.addWorker<CoordsTerrainWorker>(true);
+
+    FirstPersonView view;
+    Collector meshCollector(CollectorPresets::SCENE);
+    ground.collect(meshCollector, view);
+    auto &meshes = meshCollector.getStorageChannel<Mesh>();
+
+    // The meshes are not converted when the collector takes compact meshes
+    Collector collector1(CollectorPresets::SCENE);
+    Collector collector2(CollectorPresets::SCENE);
+    collector1.addStorageChannel<CompactMesh>();
+    collector2.addStorageChannel<CompactMesh>();
+    ground.collect(collector1, view);
+    ground.collect(collector2, view);
+
+    auto &compact1 = collector1.getStorageChannel<CompactMesh>();
+    auto &compact2 = collector2.getStorageChannel<CompactMesh>();
+    CHECK(collector1.getStorageChannel<Mesh>().size() == 0);
+    REQUIRE(compact1.size() == meshes.size());
+
+    bool same = true;
+    for (auto entry : compact1) {
+        const Mesh &mesh = meshes.get(entry._key);
+        same = same && &entry._value == &compact2.get(entry._key) &&
+               entry._value.getVerticesCount() == mesh.getVerticesCount() &&
+               entry._value.getPosition(7) == mesh.getVertex(7).getPosition();
+    }
+    CHECK(same);
+}
+
+/** Worker that does not modify the tiles and does not support points */
+class NoopWorker : public ITerrainWorker {
+public:
+    void processTerrain(Terrain &terrain) override {}
+
+    void processTile(ITileContext &context) override {}
+
+    bool fillsBorder() const override { return true; }
+};
+
+TEST_CASE("HeightmapGround - point altitudes", "[terrain]") {
+    HeightmapGround points(6000);
+    HeightmapGround tiles(6000);
+    points.setDefaultWorkerSet();
+    tiles.setDefaultWorkerSet();
+    tiles.addWorker<NoopWorker>();
+
+    // Centers and corners of the tiles are samples at every level of detail
+    for (int i = -4; i < 4; ++i) {
+        for (double resolution : {0.01, 1., 100.}) {
+            const double x = i * 3000, y = 1500 - i * 3000;
+            INFO("x = " << x << ", y = " << y << ", res = " << resolution);
+            CHECK(points.observeAltitudeAt(x, y, resolution) ==
+                  Approx(tiles.observeAltitudeAt(x, y, resolution)));
+        }
+    }
+    CHECK(points.getGeneratedTileCount() == 0);
+    CHECK(tiles.getGeneratedTileCount() > 0);
+}
+
+TEST_CASE("HeightmapGround - point altitudes between the samples",
+          "[terrain]") {
+    for (TerrainStorage storage :
+         {TerrainStorage::FLOAT64, TerrainStorage::UINT16}) {
+        HeightmapGround points(6000);
+        HeightmapGround tiles(6000);
+        points.setDefaultWorkerSet();
+        tiles.setDefaultWorkerSet();
+        tiles.addWorker<NoopWorker>();
+        points.setTerrainStorage(storage);
+        tiles.setTerrainStorage(storage);
+
+        for (int i = -4; i < 4; ++i) {
+            for (double resolution : {0.01, 1., 100.}) {
+                const double x = i * 1237.3 + 17.9, y = 911.1 - i * 2113.7;
+                INFO("x = " << x << ", y = " << y << ", res = " << resolution);
+                CHECK(points.observeAltitudeAt(x, y, resolution) ==
+                      Approx(tiles.observeAltitudeAt(x, y, resolution))
+                          .epsilon(1e-9));
+            }
+        }
+        CHECK(points.getGeneratedTileCount() == 0);
+    }
+}
+
+TEST_CASE("HeightmapGround - tile borders", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.setDefaultWorkerSet();
+    FirstPersonView view;
+    Collector collector(CollectorPresets::SCENE);
+    ground.collect(collector, view);
+
+    // The neighbours of the collected tiles are not needed to build their
+    // meshes: only the collected tiles and their parents are generated
+    const size_t collected = collector.getStorageChannel<SceneNode>().size();
+    CHECK(ground.getGeneratedTileCount() < 2 * collected);
+}
+
+TEST_CASE("HeightmapGround - lazy textures", "[terrain]") {
+    HeightmapGround ground(6000);
+    ground.addWorker<PerlinTerrainGenerator>();
+    auto &texturer = ground.addWorker<CountingTexturer>();
+    FirstPersonView view;
+
+    SECTION("no texture channel") {
+        Collector collector(CollectorPresets::NONE);
+        collector.addStorageChannel<SceneNode>();
+        collector.addStorageChannel<Mesh>();
+        ground.collect(collector, view);
+
+        CHECK(collector.getStorageChannel<SceneNode>().size() != 0);
+        CHECK(texturer._processed == 0);
+    }
+
+    SECTION("collected tiles only") {
+        Collector collector(CollectorPresets::SCENE);
+        ground.collect(collector, view);
+
+        // Parents of the collected tiles are generated but not textured
+        const int collected =
+            int(collector.getStorageChannel<SceneNode>().size());
+        CHECK(texturer._processed == collected);
+        CHECK(ground.getGeneratedTileCount() > size_t(collected));
+
+        // Textures are not generated again
+        collector.reset();
+        ground.collect(collector, view);
+        CHECK(texturer._processed == collected);
+    }
+
+    SECTION("released under memory pressure") {
+        Collector collector(CollectorPresets::SCENE);
+        ground.collect(collector, view);
+        const int collected = texturer._processed;
+
+        // Only the textures of the tiles collected last are kept
+        ground.setMemoryBudget(1);
+        view.setPosition({5000, 0, 0});
+        collector.reset();
+        ground.collect(collector, view);
+        collector.reset();
+        view.setPosition({0, 0, 0});
+        ground.collect(collector, view);
+        CHECK(texturer._processed > collected);
+    }
+}
+
+TEST_CASE("HeightmapGround - deterministic seeds", "[terrain]") {
+    HeightmapGround serial(6000);
+    HeightmapGround parallel(6000);
+    HeightmapGround otherSeed(6000);
+
+    serial.setSeed(12);
+    parallel.setSeed(12);
+    otherSeed.setSeed(13);
+    serial.setDefaultWorkerSet();
+    parallel.setDefaultWorkerSet();
+    otherSeed.setDefaultWorkerSet();
+    parallel.setThreadCount(4);
+
+    std::vector<vec2d> points;
+    for (int i = 0; i < 16; ++i) {
+        points.emplace_back(i * 1500 - 12000, 7000 - i * 900);
+    }
+
+    // The tiles are generated in a different order
+    std::vector<double> serialAlts, parallelAlts;
+    for (auto it = points.begin(); it != points.end(); ++it) {
+        serialAlts.push_back(serial.observeAltitudeAt(it->x, it->y, 1.0));
+    }
+    for (auto it = points.rbegin(); it != points.rend(); ++it) {
+        parallelAlts.insert(parallelAlts.begin(),
+                            parallel.observeAltitudeAt(it->x, it->y, 1.0));
+    }
+    CHECK(serialAlts == parallelAlts);
+
+    bool different = false;
+    for (size_t i = 0; i < points.size(); ++i) {
+        different = different || serialAlts[i] != otherSeed.observeAltitudeAt(
+                                                      points[i].x,
+                                                      points[i].y, 1.0);
+    }
+    CHECK(different);
+}
+
+TEST_CASE("HeightmapGround - cache warm start", "[terrain]") {
+    TempDirectory directory("test_heightmap_cache");
+    auto cache = std::make_shared<DirectoryCache>(directory.path());
+
+    HeightmapGround coldGround(6000);
+    HeightmapGround warmGround(6000);
+    auto &coldWorker = coldGround.addWorker<CoordsTerrainWorker>(true);
+    auto &warmWorker = warmGround.addWorker<CoordsTerrainWorker>(true);
+    coldGround.setCache(cache);
+    warmGround.setCache(cache);
+
+    FirstPersonView view;
+    Collector coldCollector(CollectorPresets::SCENE);
+    coldGround.collect(coldCollector, view);
+    CHECK(coldWorker._processed > 0);
+
+    Collector warmCollector(CollectorPresets::SCENE);
+    warmGround.collect(warmCollector, view);
+    CHECK(warmWorker._processed == 0);
+    CHECK(warmCollector.getStorageChannel<SceneNode>().size() ==
+          coldCollector.getStorageChannel<SceneNode>().size());
+
+    bool success = true;
+    for (int x = -5000; x < 5000; x += 250) {
+        for (int y = -5000; y < 5000; y += 250) {
+            success = success && coldGround.observeAltitudeAt(x, y, 0.01) ==
+                                     warmGround.observeAltitudeAt(x, y, 0.01);
+        }
+    }
+    CHECK(success);
+}
+
+TEST_CASE("HeightmapGround - cache key follows the workers", "[terrain]") {
+    TempDirectory directory("test_config_cache");
+    auto cache = std::make_shared<DirectoryCache>(directory.path());
+
+    HeightmapGround first(6000);
+    HeightmapGround second(6000);
+    first.addWorker<DiamondSquareTerrain>();
+    auto &worker = second.addWorker<DiamondSquareTerrain>();
+    first.setCache(cache);
+    second.setCache(cache);
+
+    const double x = 1000, y = 2000;
+    const double firstAltitude = first.observeAltitudeAt(x, y, 1.0);
+
+    // The worker is configured after the first generation, without going
+    // through the ground
+    second.observeAltitudeAt(-20000, -20000, 1.0);
+    worker.setSeed(7);
+    CHECK(second.observeAltitudeAt(x, y, 1.0) != firstAltitude);
+
+    MultilayerGroundTexture texturer;
+    std::stringstream before, after;
+    texturer.writeConfig(before);
+    texturer.addDefaultLayers();
+    texturer.writeConfig(after);
+    CHECK(before.str() != after.str());
+}
+
+TEST_CASE("HeightmapGround - setSeed drops the generated tiles",
+          "[terrain]") {
+    HeightmapGround ground(6000);
+    HeightmapGround reference(6000);
+    ground.addWorker<DiamondSquareTerrain>();
+    reference.addWorker<DiamondSquareTerrain>();
+    reference.setSeed(42);
+
+    const double x = 1000, y = 2000;
+    const double before = ground.observeAltitudeAt(x, y, 1.0);
+    ground.setSeed(42);
+    const double after = ground.observeAltitudeAt(x, y, 1.0);
+
+    CHECK(after != before);
+    CHECK(after == reference.observeAltitudeAt(x, y, 1.0));
+}
+
 TEST_CASE("HeightmapGround - observeAltitudeAt benchmark",
           "[terrain][!benchmark]") {
     HeightmapGround ground(6000);
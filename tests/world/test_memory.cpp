@@ -1,6 +1,7 @@
 #include <catch/catch.hpp>
 
 #include <world/core.h>
+#include <world/terrain.h>
 
 using namespace world;
 
@@ -57,4 +58,36 @@ TEST_CASE("const ref or value", "[memory]") {
         v = value;
         REQUIRE(v->_copy == 2);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("MemoryRegistry", "[memory]") {
+    SECTION("counters are summed by subsystem") {
+        MemoryRegistry registry;
+        u64 id = registry.add("a", []() { return size_t(10); });
+        registry.add("a", []() { return size_t(5); });
+        registry.add("b", []() { return size_t(2); });
+
+        CHECK(registry.getUsage("a") == 15);
+        CHECK(registry.getUsage("c") == 0);
+        CHECK(registry.getUsages().size() == 2);
+        CHECK(registry.getTotalUsage() == 17);
+
+        registry.remove(id);
+        CHECK(registry.getUsage("a") == 5);
+    }
+
+    SECTION("grounds report their tiles") {
+        MemoryRegistry &registry = MemoryRegistry::getDefault();
+        const size_t before = registry.getUsage("HeightmapGround");
+        {
+            HeightmapGround ground;
+            ground.addWorker<PerlinTerrainGenerator>();
+            Collector collector;
+            ground.collect(collector, FirstPersonView());
+
+            CHECK(ground.getMemoryUsage() > 0);
+            CHECK(registry.getUsage("HeightmapGround") ==
+                  before + ground.getMemoryUsage());
+        }
+        CHECK(registry.getUsage("HeightmapGround") == before);
+    }
+}
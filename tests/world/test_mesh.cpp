@@ -27,6 +27,97 @@ TEST_CASE("MeshOps", "[mesh]") {
     }
 }
 
+TEST_CASE("CompactMesh", "[mesh]") {
+    Mesh mesh;
+
+    for (int i = 0; i < 4; ++i) {
+        double x = i % 2, y = i / 2;
+        mesh.newVertex({x, y, 0.5}, vec3d{x, y, 1}.normalize(), {x, y});
+    }
+    mesh.newFace(0, 1, 2);
+    mesh.newFace(3, 2, 1);
+
+    SECTION("Conversion from and to Mesh") {
+        CompactMesh compact(mesh, CompactMesh::NormalFormat::SNORM16);
+        REQUIRE(compact.getVerticesCount() == 4);
+        REQUIRE(compact.getFaceCount() == 2);
+        CHECK(compact.hasShortIndices());
+        CHECK(compact.normals() == nullptr);
+
+        Mesh result = compact.toMesh();
+        REQUIRE(result.getVerticesCount() == 4);
+        REQUIRE(result.getFaceCount() == 2);
+
+        for (u32 i = 0; i < 4; ++i) {
+            const Vertex &expected = mesh.getVertex(i);
+            const Vertex &actual = result.getVertex(i);
+            CHECK((actual.getPosition() - expected.getPosition()).norm() ==
+                  Approx(0));
+            CHECK((actual.getNormal() - expected.getNormal()).norm() <
+                  1e-4);
+            CHECK((actual.getTexture() - expected.getTexture()).norm() ==
+                  Approx(0));
+        }
+        CHECK(result.getFace(1).getID(0) == 3);
+        CHECK(result.getFace(1).getID(2) == 1);
+    }
+
+    SECTION("Switch to 32 bits indices") {
+        CompactMesh compact;
+
+        for (u32 i = 0; i < 70000; ++i) {
+            compact.addVertex({double(i), 0, 0});
+        }
+        compact.addFace(0, 1, 2);
+        CHECK(compact.hasShortIndices());
+
+        compact.addFace(65535, 65536, 69999);
+        CHECK_FALSE(compact.hasShortIndices());
+        REQUIRE(compact.getFaceCount() == 2);
+        CHECK(compact.getIndex(2) == 2);
+        CHECK(compact.getIndex(4) == 65536);
+        CHECK(compact.indices()[5] == 69999);
+    }
+
+    SECTION("Memory usage") {
+        const int size = 100;
+        Mesh big;
+        big.reserveVertices(size * size);
+
+        for (int i = 0; i < size * size; ++i) {
+            big.newVertex({double(i % size), double(i / size), 0});
+        }
+        CompactMesh compact(big, CompactMesh::NormalFormat::SNORM16);
+        CHECK(compact.getMemoryUsage() * 2 <
+              big.getMemoryUsage());
+    }
+
+    SECTION("Shared indices") {
+        auto shared = std::make_shared<CompactMesh>(mesh);
+        CompactMesh other;
+
+        for (int i = 0; i < 4; ++i) {
+            other.addVertex({double(i), 0, 0});
+        }
+        const size_t vertexBytes = other.getMemoryUsage();
+        other.setSharedIndices(shared);
+
+        CHECK(other.hasSharedIndices());
+        REQUIRE(other.getFaceCount() == 2);
+        CHECK(other.getIndex(3) == 3);
+        const CompactMesh &constOther = other;
+        CHECK(constOther.shortIndices() == shared->shortIndices());
+        CHECK(other.getMemoryUsage() == vertexBytes);
+
+        // Modifying the indices does not modify the shared ones
+        other.addFace(0, 1, 3);
+        CHECK_FALSE(other.hasSharedIndices());
+        CHECK(other.getFaceCount() == 3);
+        CHECK(shared->getFaceCount() == 2);
+        CHECK(other.getIndex(8) == 3);
+    }
+}
+
 TEST_CASE("Mesh benchmarks", "[mesh][!benchmark]") {
     Mesh mesh1;
     Mesh mesh2;
@@ -5,8 +5,11 @@
 using namespace world;
 
 TEST_CASE("NodeKeys", "[nodes]") {
-    NodeKey key{0, 0, 0, 0};
+    NodeKey key(std::string(4, '\0'));
     REQUIRE(NodeKeys::toString(key) == "00000000");
+    CHECK(NodeKeys::fromString("00000000") == key);
+    CHECK(NodeKey("abc").str() == "abc");
+    CHECK(NodeKey("") == NodeKeys::none());
 }
 
 
@@ -23,6 +23,40 @@ TEST_CASE("Perlin - General test case", "[perlin]") {
     }
 }
 
+TEST_CASE("Perlin - Border", "[perlin]") {
+    Perlin perlin;
+    PerlinInfo info{3, 0.5, false, 0, 4., 0, 0};
+    arma::mat center(33, 33), right(33, 33), bordered(35, 35);
+    perlin.generatePerlinNoise2D(center, info);
+    info.offsetX = 4;
+    perlin.generatePerlinNoise2D(right, info);
+    info.offsetX = 0;
+    info.border = 1;
+    perlin.generatePerlinNoise2D(bordered, info);
+
+    for (int i = 0; i < 33; ++i) {
+        CHECK(bordered(i + 1, 5) == Approx(center(i, 4)));
+        CHECK(bordered(34, i + 1) == Approx(right(1, i)));
+    }
+}
+
+TEST_CASE("Perlin - getValue", "[perlin]") {
+    Perlin perlin(7);
+    perlin.setNormalize(false);
+    PerlinInfo info{5, 0.4, false, 2, 4., 12, -20};
+    info.border = 1;
+    arma::mat noise(35, 35);
+    perlin.generatePerlinNoise2D(noise, info);
+
+    for (int y = 0; y < 35; ++y) {
+        for (int x = 0; x < 35; ++x) {
+            INFO("x = " << x << ", y = " << y);
+            CHECK(perlin.getValue((x - 1) / 32., (y - 1) / 32., info) ==
+                  Approx(noise(x, y)));
+        }
+    }
+}
+
 TEST_CASE("Perlin - Random values modifier") {
     Perlin perlin;
     arma::mat noise(100, 100);
@@ -61,6 +95,90 @@ TEST_CASE("Perlin - Random values modifier") {
     }
 }
 
+/** Straightforward implementation of the perlin noise, used as a reference
+ * for the optimized one. */
+arma::mat referencePerlin(const Perlin &perlin, int size,
+                          const PerlinInfo &info,
+                          const Perlin::modifier &modifier) {
+    std::vector<u8> hash = perlin.getHash();
+    arma::mat result(size, size, arma::fill::zeros);
+    double coefSum = 0;
+
+    for (int o = 0; o < info.octaves; ++o) {
+        double scale = std::pow(2., o - info.reference);
+        double localFreq = info.frequency * std::pow(2., o);
+        int fi = static_cast<int>(std::ceil(localFreq));
+        int offX = static_cast<int>(std::floor(info.offsetX * scale));
+        int offY = static_cast<int>(std::floor(info.offsetY * scale));
+        double offXf = info.offsetX * scale - offX;
+        double offYf = info.offsetY * scale - offY;
+
+        arma::mat buffer(fi + 1, fi + 1);
+
+        for (int x = 0; x <= fi; x++) {
+            for (int y = 0; y <= fi; y++) {
+                u32 px = static_cast<u32>(x + offX) & 0xFFu;
+                u32 py = static_cast<u32>(y + offY) & 0xFFu;
+                double val = hash[px + hash[py + hash[o]]] / 255.;
+
+                if (info.repeatable) {
+                    if (x == fi) {
+                        val = buffer(0, y);
+                    } else if (y == fi) {
+                        val = buffer(x, 0);
+                    }
+                }
+                buffer(x, y) = modifier((double)x / fi, (double)y / fi, val);
+            }
+        }
+
+        double coef = std::pow(info.persistence, o);
+        coefSum += coef;
+        double f = info.frequency * scale;
+
+        for (int x = 0; x < size; x++) {
+            for (int y = 0; y < size; y++) {
+                double xd = f * x / (size - 1) + offXf;
+                double yd = f * y / (size - 1) + offYf;
+                int x1 = static_cast<int>(std::floor(xd));
+                int y1 = static_cast<int>(std::floor(yd));
+                int x2 = static_cast<int>(std::ceil(xd));
+                int y2 = static_cast<int>(std::ceil(yd));
+
+                double v1 = Interpolation::interpolateCosine(
+                    x1, buffer(x1, y1), x2, buffer(x2, y1), xd);
+                double v2 = Interpolation::interpolateCosine(
+                    x1, buffer(x1, y2), x2, buffer(x2, y2), xd);
+                result(x, y) += coef * Interpolation::interpolateCosine(
+                                           y1, v1, y2, v2, yd);
+            }
+        }
+    }
+
+    return result / coefSum;
+}
+
+TEST_CASE("Perlin - Matches reference implementation", "[perlin]") {
+    Perlin perlin(12);
+    auto modifier = [](double x, double y, double val) {
+        return val * (1 + x - y);
+    };
+
+    std::vector<PerlinInfo> infos{{1, 0.5, false, 0, 4., 0, 0},
+                                  {5, 0.4, false, 0, 3., 0, 0},
+                                  {4, 0.5, true, 0, 4., 0, 0},
+                                  {3, 0.6, false, 2, 4., 5, 3},
+                                  {6, 0.5, false, 1, 1., 13, 6}};
+
+    for (auto &info : infos) {
+        arma::mat noise(65, 65);
+        perlin.generatePerlinNoise2D(noise, info, modifier);
+        arma::mat reference = referencePerlin(perlin, 65, info, modifier);
+
+        CHECK(arma::abs(noise - reference).max() < 1e-12);
+    }
+}
+
 TEST_CASE("Perlin - Benchmarks", "[!benchmark]") {
     arma::mat noise(1024, 1024);
 
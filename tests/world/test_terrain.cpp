@@ -56,6 +56,225 @@ TEST_CASE("Terrain - getExactHeightAt", "[terrain]") {
     }
 }
 
+TEST_CASE("Terrain - storage modes", "[terrain]") {
+    Terrain terrain(17);
+
+    for (int y = 0; y < 17; ++y) {
+        for (int x = 0; x < 17; ++x) {
+            terrain(x, y) = (x + 2 * y) / 48.0;
+        }
+    }
+    const size_t textureBytes = terrain.getTexture().getMemoryUsage();
+    const Terrain reference = terrain;
+
+    SECTION("float32 storage") {
+        terrain.setStorage(TerrainStorage::FLOAT32);
+        REQUIRE(terrain.getStorage() == TerrainStorage::FLOAT32);
+        REQUIRE(terrain.getMemoryUsage() ==
+                17 * 17 * sizeof(float) + textureBytes);
+        REQUIRE(terrain.floatAt(5, 7) == Approx(reference(5, 7)));
+        REQUIRE(terrain.getHeight(5, 7) == Approx(reference(5, 7)));
+
+        terrain.floatAt(5, 7) = 0.25f;
+        REQUIRE(terrain.getHeight(5, 7) == 0.25);
+        terrain.setHeight(5, 7, reference(5, 7));
+        REQUIRE(terrain.getExactHeightAt(0.3, 0.6) ==
+                Approx(reference.getExactHeightAt(0.3, 0.6)));
+    }
+
+    SECTION("uint16 storage") {
+        terrain.setStorage(TerrainStorage::UINT16, 0, 1);
+        REQUIRE(terrain.getMemoryUsage() == 17 * 17 * 2 + textureBytes);
+
+        for (int y = 0; y < 17; ++y) {
+            for (int x = 0; x < 17; ++x) {
+                REQUIRE(std::abs(terrain.getHeight(x, y) - reference(x, y)) <
+                        1e-5);
+            }
+        }
+
+        // Heights out of range are clamped
+        terrain.setHeight(0, 0, 2);
+        terrain.setHeight(1, 0, -1);
+        REQUIRE(terrain.getHeight(0, 0) == Approx(1));
+        REQUIRE(terrain.getHeight(1, 0) == Approx(0));
+    }
+
+    SECTION("TerrainOps on compact storage") {
+        terrain.setStorage(TerrainStorage::UINT16, -1, 1);
+        TerrainOps::multiply(terrain, 0.5);
+        TerrainOps::applyOffset(terrain, -0.25);
+        REQUIRE(terrain.getHeight(16, 16) ==
+                Approx(reference(16, 16) * 0.5 - 0.25).margin(1e-4));
+
+        terrain.setStorage(TerrainStorage::FLOAT64);
+        REQUIRE(terrain.getStorage() == TerrainStorage::FLOAT64);
+        REQUIRE(terrain(3, 4) == Approx(reference(3, 4) * 0.5 - 0.25)
+                                     .margin(1e-4));
+    }
+}
+
+TEST_CASE("Terrain - border", "[terrain]") {
+    Terrain terrain(5, TerrainStorage::FLOAT64, 1);
+    REQUIRE(terrain.getBufferResolution() == 7);
+
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 5; ++x) {
+            terrain(x, y) = x * 0.1 + y * 0.01;
+        }
+    }
+    TerrainOps::extrapolateBorder(terrain);
+    CHECK(terrain(-1, 2) == Approx(-0.1 + 0.02));
+    CHECK(terrain(5, -1) == Approx(0.5 - 0.01));
+    CHECK(terrain.toMatrix().n_rows == 5);
+
+    // Interpolation uses the border outside of [0, 1]
+    CHECK(terrain.getInterpolatedHeight(-0.125, 0, Interpolation::LINEAR) ==
+          Approx(-0.05));
+}
+
+TEST_CASE("Terrain - getSlopes", "[terrain]") {
+    Terrain terrain(9);
+
+    for (int y = 0; y < 9; ++y) {
+        for (int x = 0; x < 9; ++x) {
+            terrain(x, y) = sin(x * 0.7) * cos(y * 0.3) + x * y * 0.01;
+        }
+    }
+
+    arma::mat slopes = terrain.getSlopes();
+
+    for (int y = 0; y < 9; ++y) {
+        for (int x = 0; x < 9; ++x) {
+            INFO("x = " << x << ", y = " << y);
+            CHECK(slopes(x, y) == Approx(terrain.getSlope(x, y)));
+        }
+    }
+}
+
+TEST_CASE("TerrainResampler - same values as the terrain", "[terrain]") {
+    Terrain terrain(9, TerrainStorage::FLOAT64, 1);
+
+    for (int y = -1; y < 10; ++y) {
+        for (int x = -1; x < 10; ++x) {
+            terrain(x, y) = sin(x * 0.7) * cos(y * 0.3) + x * y * 0.01;
+        }
+    }
+
+    // Starts outside of the terrain, to test the clamping and the borders
+    const vec2d origin{-0.1, 0.05};
+    const double step = 0.09;
+    const int count = 15;
+    std::vector<double> row(count);
+
+    SECTION("cubic") {
+        TerrainResampler resampler(terrain, TerrainResampler::Mode::CUBIC,
+                                   origin, step, count);
+
+        for (int y = 0; y < count; ++y) {
+            resampler.getRow(y, row.data());
+
+            for (int x = 0; x < count; ++x) {
+                INFO("x = " << x << ", y = " << y);
+                CHECK(row[x] == Approx(terrain.getCubicHeight(
+                                    origin.x + x * step, origin.y + y * step)));
+            }
+        }
+    }
+
+    SECTION("linear") {
+        TerrainResampler resampler(terrain, TerrainResampler::Mode::LINEAR,
+                                   origin, step, count);
+
+        for (int y = 0; y < count; ++y) {
+            resampler.getRow(y, row.data());
+
+            for (int x = 0; x < count; ++x) {
+                INFO("x = " << x << ", y = " << y);
+                CHECK(row[x] == Approx(terrain.getInterpolatedHeight(
+                                    origin.x + x * step, origin.y + y * step,
+                                    Interpolation::LINEAR)));
+            }
+        }
+    }
+}
+
+TEST_CASE("TerrainPipeline - same result as the workers", "[terrain]") {
+    Terrain expected(33, TerrainStorage::FLOAT64, 1);
+    expected.setBounds(-2000, 3000, 0, 0, 5000, 1000);
+    Terrain actual(expected);
+
+    PerlinTerrainGenerator perlin(4, 4., 0.4);
+    CustomWorldRMModifier relief;
+    perlin.setSeed(5);
+    relief.setSeed(7);
+    perlin.processTerrain(expected);
+    relief.processTerrain(expected);
+
+    TerrainPipeline<PerlinStage, ReliefStage<>, RemapStage, ClampStage>
+        pipeline;
+    pipeline.getStage<0>() = PerlinStage(4, 4., 0.4);
+    pipeline.getStage<0>().setSeed(5);
+    pipeline.getStage<1>().getModifier().setSeed(7);
+    pipeline.getStage<2>() = RemapStage(0, 1, 0, 2);
+    pipeline.getStage<3>() = ClampStage(0, 1.5);
+    pipeline.processTerrain(actual);
+
+    for (int y = -1; y < 34; ++y) {
+        for (int x = -1; x < 34; ++x) {
+            INFO("x = " << x << ", y = " << y);
+            CHECK(actual(x, y) ==
+                  Approx(std::min(expected(x, y) * 2, 1.5)).epsilon(1e-12));
+        }
+    }
+
+    SECTION("other storages") {
+        Terrain quantized(33, TerrainStorage::FLOAT32, 1);
+        quantized.setBounds(-2000, 3000, 0, 0, 5000, 1000);
+        pipeline.processTerrain(quantized);
+        CHECK(quantized.getHeight(7, 12) ==
+              Approx(actual(7, 12)).epsilon(1e-6));
+    }
+}
+
+class ColorTextureProvider : public ITextureProvider {
+public:
+    ColorTextureProvider() : _texture(4, 4, ImageType::RGBA) {
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 4; ++x) {
+                _texture.rgba(x, y).set(200, 100, 50);
+            }
+        }
+    }
+
+    Image &getTexture(int layer, int lod) override { return _texture; }
+
+private:
+    Image _texture;
+};
+
+TEST_CASE("MultilayerGroundTexture - process", "[terrain]") {
+    MultilayerGroundTexture texturer;
+    texturer.setTextureProvider<ColorTextureProvider>();
+    texturer.addDefaultLayers();
+
+    Terrain terrain(17);
+    TerrainOps::fill(terrain, 0.5);
+    terrain.setTexture(Image(32, 32, ImageType::RGB));
+    texturer.processTerrain(terrain);
+
+    // The rock layer covers all the terrain
+    const Image &texture = terrain.getTexture();
+    CHECK(texture.rgb(5, 20).getRed() == Approx(200).margin(1));
+    CHECK(texture.rgb(31, 0).getGreen() == Approx(100).margin(1));
+    CHECK(texture.rgb(0, 31).getBlue() == Approx(50).margin(1));
+
+    // Distributions do not pile up when the texture is generated again
+    size_t memory = texturer.getStorage()->getMemoryUsage();
+    texturer.processTerrain(terrain);
+    CHECK(texturer.getStorage()->getMemoryUsage() == memory);
+}
+
 TEST_CASE("Terrain - Mesh generation benchmark", "[terrain][!benchmark]") {
     Terrain terrain(129);
 
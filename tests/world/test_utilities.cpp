@@ -1,7 +1,14 @@
 #include <catch/catch.hpp>
 
+#include <atomic>
+#include <future>
+#include <random>
+#include <sstream>
+
 #include <world/core.h>
 
+#include "TempDirectory.h"
+
 using namespace world;
 
 TEST_CASE("TileSystem", "[utilities]") {
@@ -29,8 +36,9 @@ TEST_CASE("TileSystem", "[utilities]") {
         }
 
         SECTION("test toKey features") {
-            REQUIRE(c1a.toKey().length() == sizeof(int) * 4);
-            REQUIRE((c1a.toKey() + c2.toKey()).length() == sizeof(int) * 8);
+            REQUIRE(c1a.toKey().str().length() == sizeof(int) * 4);
+            REQUIRE(TileCoordinates(c1a.toKey()) == c1a);
+            REQUIRE(TileCoordinates(c3.toKey()) == c3);
         }
     }
 
@@ -199,6 +207,51 @@ TEST_CASE("GridStorage", "[utilities]") {
         CHECK(storage._tcs.find(p1c2) != storage._tcs.end());
     }
 
+    SECTION("GridStorageReducer memory budget") {
+        TerrainGrid terrains;
+        // Each terrain is 10 * 10 doubles: 800 bytes, plus a tiny texture
+        GridStorageReducer reducer(ts, 1000, 2000);
+        terrains.setReducer(&reducer);
+
+        TileCoordinates parent = {{0}, 0}, child1 = {{0}, 1},
+                        child2 = {{1}, 1}, other = {{1}, 0};
+        REQUIRE(ts.getParentTileCoordinates(child1) == parent);
+
+        terrains.set(parent, 10);
+        terrains.set(child1, 10);
+        terrains.set(other, 10);
+        terrains.set(child2, 10);
+
+        reducer.reduceStorage();
+        CHECK(reducer.getMemoryUsage() <= 2000);
+        CHECK(reducer.getInstanceCount() == 2);
+
+        // Parent was accessed first, but it is kept with its last child
+        CHECK(terrains.has(parent));
+        CHECK(terrains.has(child2));
+        CHECK_FALSE(terrains.has(child1));
+        CHECK_FALSE(terrains.has(other));
+    }
+
+    SECTION("GridStorageReducer after a move") {
+        GridStorageReducer reducer(ts, 1);
+        TerrainGrid moved;
+        moved.setReducer(&reducer);
+
+        TerrainGrid terrains(std::move(moved));
+        terrains.set({{0}, 0}, 2);
+        terrains.set({{1}, 0}, 2);
+        reducer.reduceStorage();
+        CHECK(terrains.size() == 1);
+
+        TerrainGrid assigned;
+        assigned = std::move(terrains);
+        assigned.set({{2}, 0}, 2);
+        reducer.reduceStorage();
+        CHECK(assigned.size() == 1);
+        CHECK(assigned.has({{2}, 0}));
+    }
+
     SECTION("GridStorage && Reducer interaction") {
         GridStorageReducer reducer(ts);
 
@@ -206,6 +259,280 @@ TEST_CASE("GridStorage", "[utilities]") {
     }
 }
 
+class CountedElement : public IGridElement {
+public:
+    static int _alive;
+    int _value;
+
+    CountedElement(int value) : _value(value) { ++_alive; }
+
+    ~CountedElement() override { --_alive; }
+};
+
+int CountedElement::_alive = 0;
+
+template <typename TPolicy> void checkStoragePolicy() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(-50, 50), lod(0, 4);
+    std::map<TileCoordinates, int> expected;
+
+    {
+        GridStorage<CountedElement, TPolicy> storage;
+
+        for (int i = 0; i < 5000; ++i) {
+            TileCoordinates tc{coord(rng), coord(rng), 0, lod(rng)};
+
+            if (i % 3 == 2 && !expected.empty()) {
+                // Remove an element inserted previously
+                auto it = expected.lower_bound(tc);
+                if (it == expected.end())
+                    it = expected.begin();
+                storage.remove(it->first);
+                expected.erase(it);
+            } else {
+                storage.set(tc, i);
+                expected[tc] = i;
+            }
+        }
+
+        CHECK(storage.size() == expected.size());
+        CHECK(CountedElement::_alive == static_cast<int>(expected.size()));
+
+        bool success = true;
+        for (auto &entry : expected) {
+            CountedElement *elem;
+            success = success && storage.tryGet(entry.first, &elem) &&
+                      elem->_value == entry.second;
+        }
+        CHECK(success);
+
+        int found = 0;
+        for (int x = -50; x <= 50; ++x) {
+            for (int y = -50; y <= 50; ++y) {
+                for (int l = 0; l <= 4; ++l) {
+                    found += storage.has({x, y, 0, l}) ? 1 : 0;
+                }
+            }
+        }
+        CHECK(found == static_cast<int>(expected.size()));
+    }
+    CHECK(CountedElement::_alive == 0);
+}
+
+TEST_CASE("GridStorage policies", "[utilities]") {
+    SECTION("map") { checkStoragePolicy<MapStoragePolicy>(); }
+    SECTION("hash") { checkStoragePolicy<HashStoragePolicy>(); }
+}
+
+TEST_CASE("ThreadPool", "[utilities]") {
+    ThreadPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+
+    SECTION("parallelFor calls every job once") {
+        std::vector<std::atomic<int>> calls(1000);
+
+        for (auto &c : calls) {
+            c = 0;
+        }
+
+        pool.parallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+
+        bool success = true;
+        for (auto &c : calls) {
+            success = success && c == 1;
+        }
+        CHECK(success);
+    }
+
+    SECTION("parallelFor rethrows exceptions") {
+        std::atomic<int> count{0};
+
+        CHECK_THROWS_AS(pool.parallelFor(100,
+                                         [&](size_t i) {
+                                             ++count;
+                                             if (i == 50)
+                                                 throw std::runtime_error("");
+                                         }),
+                        std::runtime_error);
+        CHECK(count == 100);
+    }
+}
+
+TEST_CASE("Tracer", "[utilities]") {
+    Tracer &tracer = Tracer::getDefault();
+    tracer.clear();
+    tracer.setEnabled(true);
+
+    SECTION("nested zones") {
+        {
+            TraceZone zone1("parent");
+            { TraceZone zone2("child", "detail"); }
+        }
+        auto events = tracer.getEvents();
+        REQUIRE(events.size() == 2);
+        CHECK(std::string(events[0]._name) == "parent");
+        CHECK(events[0]._depth == 0);
+        CHECK(std::string(events[1]._name) == "child");
+        CHECK(events[1]._depth == 1);
+        CHECK(events[0]._start <= events[1]._start);
+        CHECK(events[0]._end >= events[1]._end);
+    }
+
+    SECTION("disabled tracer records nothing") {
+        tracer.setEnabled(false);
+        { TraceZone zone("zone"); }
+        CHECK(tracer.getEvents().empty());
+    }
+
+    SECTION("each thread has its own buffer") {
+        ThreadPool pool(4);
+        pool.parallelFor(100, [](size_t) { TraceZone zone("job"); });
+
+        auto events = tracer.getEvents();
+        REQUIRE(events.size() == 100);
+
+        bool depthOk = true;
+        for (auto &event : events) {
+            depthOk = depthOk && event._depth == 0;
+        }
+        CHECK(depthOk);
+    }
+
+    SECTION("full buffers overwrite the oldest zones") {
+        tracer.setBufferSize(4);
+        tracer.clear();
+
+        const char *names[] = {"0", "1", "2", "3", "4", "5"};
+        for (const char *name : names) {
+            TraceZone zone(name);
+        }
+        auto events = tracer.getEvents();
+        REQUIRE(events.size() == 4);
+        CHECK(std::string(events[0]._name) == "2");
+        CHECK(std::string(events[3]._name) == "5");
+
+        tracer.setBufferSize(1 << 16);
+    }
+
+    SECTION("chrome trace export") {
+        { TraceZone zone("exported", typeid(Tracer).name()); }
+
+        std::stringstream stream;
+        tracer.exportChromeTrace(stream);
+        std::string json = stream.str();
+        CHECK(json.find("\"traceEvents\"") != std::string::npos);
+        CHECK(json.find("\"name\":\"exported\"") != std::string::npos);
+        CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+    }
+
+    tracer.setEnabled(false);
+    tracer.clear();
+}
+
+TEST_CASE("TileGenerationQueue", "[utilities]") {
+    std::promise<void> unblock;
+    std::shared_future<void> blocker = unblock.get_future().share();
+    std::vector<TileCoordinates> generated;
+
+    TileGenerationQueue queue([&](const TileCoordinates &tc) {
+        blocker.wait();
+        generated.push_back(tc);
+    });
+
+    // The first tile blocks the thread while the others are requested
+    queue.request({0, 0, 0, 0}, 10);
+    queue.request({1, 0, 0, 1}, 1);
+    queue.request({2, 0, 0, 1}, 3);
+    queue.request({3, 0, 0, 0}, 0);
+    queue.request({4, 0, 0, 1}, 2);
+    queue.request({1, 0, 0, 1}, 4);
+    CHECK(queue.pendingCount() >= 5);
+
+    unblock.set_value();
+    queue.waitIdle();
+    CHECK(queue.pendingCount() == 0);
+
+    std::vector<TileCoordinates> expected{
+        {0, 0, 0, 0}, {3, 0, 0, 0}, {1, 0, 0, 1}, {2, 0, 0, 1}, {4, 0, 0, 1}};
+    CHECK(generated == expected);
+}
+
+TEST_CASE("RandomStream", "[utilities]") {
+    RandomStream a(42);
+    RandomStream b(42);
+    RandomStream other(43);
+
+    std::vector<u64> values;
+    bool different = false;
+
+    for (u64 i = 0; i < 100; ++i) {
+        u64 value = a();
+        values.push_back(value);
+        different = different || value != other();
+    }
+    CHECK(different);
+
+    SECTION("same seed gives same stream") {
+        bool success = true;
+
+        for (u64 i = 0; i < 100; ++i) {
+            success = success && b() == values[i] && a.at(i) == values[i];
+        }
+        CHECK(success);
+    }
+
+    SECTION("derived streams only depend on their identifiers") {
+        TileCoordinates tc({1, -2, 0}, 3);
+        RandomStream tile1(42, tc, "tile");
+        RandomStream tile2(42, tc, "tile");
+        RandomStream tile3(42, tc, "other");
+        RandomStream tile4(42, TileCoordinates({1, -2, 0}, 2), "tile");
+
+        CHECK(tile1() == tile2());
+        CHECK(tile1.getKey() != tile3.getKey());
+        CHECK(tile1.getKey() != tile4.getKey());
+        CHECK(deriveSeed(42, vec3d{0.5, 1, 2}) ==
+              deriveSeed(42, vec3d{0.5, 1, 2}));
+    }
+
+    SECTION("works with standard distributions") {
+        std::uniform_real_distribution<double> distrib(2, 3);
+        double value = distrib(a);
+        CHECK(value >= 2);
+        CHECK(value < 3);
+    }
+}
+
+TEST_CASE("DirectoryCache", "[utilities]") {
+    TempDirectory directory("test_directory_cache");
+    DirectoryCache cache(directory.path());
+    std::string key = "entry_0-1";
+    std::string data = "some cached data";
+
+    cache.remove(key);
+    CHECK_FALSE(cache.has(key));
+    CHECK(cache.load(key) == nullptr);
+
+    cache.save(key, data.c_str(), data.size());
+    REQUIRE(cache.has(key));
+
+    auto view = cache.load(key);
+    REQUIRE(view != nullptr);
+    CHECK(std::string(view->data(), view->size()) == data);
+
+    SECTION("save replaces the previous data") {
+        std::string other = "other";
+        cache.save(key, other.c_str(), other.size());
+        CHECK(std::string(view->data(), view->size()) == data);
+
+        auto otherView = cache.load(key);
+        CHECK(std::string(otherView->data(), otherView->size()) == other);
+    }
+
+    cache.remove(key);
+    CHECK_FALSE(cache.has(key));
+}
+
 TEST_CASE("Test StringOps.h", "[utilities]") {
 
     SECTION("split") {